@@ -13,6 +13,226 @@ namespace nanostl {
 int siphash(const uint8_t *in, const size_t inlen, const uint8_t *k,
             uint8_t *out, const size_t outlen);
 
+//
+// constexpr hash helpers. Usable for compile-time tables(e.g. frozen_map).
+//
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+constexpr uint64_t __hash_xorshift(uint64_t x, int shift) {
+  return x ^ (x >> shift);
+}
+
+// splitmix64 finalizer.
+NANOSTL_HOST_AND_DEVICE_QUAL
+constexpr uint64_t __hash_mix64(uint64_t x) {
+  return __hash_xorshift(
+      __hash_xorshift(__hash_xorshift(x, 30) * 0xbf58476d1ce4e5b9ull, 27) *
+          0x94d049bb133111ebull,
+      31);
+}
+
+// NOTE: FNV-1a helpers are written as C++11 constexpr(recursive), so they are
+// intended for short keys.
+
+// 64bit FNV-1a over a NUL terminated string.
+NANOSTL_HOST_AND_DEVICE_QUAL
+constexpr uint64_t __hash_fnv1a(const char *s,
+                                uint64_t h = 0xcbf29ce484222325ull) {
+  return (*s == '\0')
+             ? h
+             : __hash_fnv1a(s + 1, (h ^ static_cast<unsigned char>(*s)) *
+                                       0x100000001b3ull);
+}
+
+// Code unit as an unsigned value(zero extended, like `unsigned char` for
+// char).
+template <class charT>
+NANOSTL_HOST_AND_DEVICE_QUAL constexpr uint64_t __hash_fnv1a_unit(charT c) {
+  return (sizeof(charT) >= 8)
+             ? static_cast<uint64_t>(c)
+             : (static_cast<uint64_t>(c) &
+                ((1ull << ((sizeof(charT) * 8) % 64)) - 1));
+}
+
+// 64bit FNV-1a over `n` code units(one unit per step, so wide strings hash
+// their code unit values, not their bytes).
+template <class charT>
+NANOSTL_HOST_AND_DEVICE_QUAL constexpr uint64_t __hash_fnv1a_n(
+    const charT *s, size_t n, uint64_t h = 0xcbf29ce484222325ull) {
+  return (n == 0) ? h
+                  : __hash_fnv1a_n(s + 1, n - 1,
+                                   (h ^ __hash_fnv1a_unit(*s)) *
+                                       0x100000001b3ull);
+}
+
+//
+// Streaming hashers for `hash_append`(see nanohash_append.h).
+//
+// Hasher concept:
+//   void operator()(const void *key, size_t len); // feed bytes
+//   explicit operator result_type();              // finalize
+//
+// Feeding the same byte sequence with different chunking gives the same
+// result.
+//
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline uint64_t __hash_read64_le(const uint8_t *p) {
+  return uint64_t(p[0]) | (uint64_t(p[1]) << 8) | (uint64_t(p[2]) << 16) |
+         (uint64_t(p[3]) << 24) | (uint64_t(p[4]) << 32) |
+         (uint64_t(p[5]) << 40) | (uint64_t(p[6]) << 48) |
+         (uint64_t(p[7]) << 56);
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline uint32_t __hash_read32_le(const uint8_t *p) {
+  return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) |
+         (uint32_t(p[3]) << 24);
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline uint64_t __hash_rotl64(uint64_t x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+///
+/// Fast non-cryptographic hasher(xxHash64 algorithm).
+/// Not resistant to hash flooding. Use `siphash_hasher` for untrusted input.
+///
+class fast_hasher {
+ public:
+  typedef uint64_t result_type;
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  explicit fast_hasher(uint64_t seed = 0) : total_len_(0), buf_len_(0) {
+    v_[0] = seed + kPrime1 + kPrime2;
+    v_[1] = seed + kPrime2;
+    v_[2] = seed;
+    v_[3] = seed - kPrime1;
+    seed_ = seed;
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  void operator()(const void *key, size_t len) {
+    const uint8_t *p = static_cast<const uint8_t *>(key);
+    const uint8_t *end = p + len;
+    total_len_ += len;
+
+    if (buf_len_ + len < 32) {
+      for (; p != end; p++) {
+        buf_[buf_len_++] = *p;
+      }
+      return;
+    }
+
+    if (buf_len_) {
+      while (buf_len_ < 32) {
+        buf_[buf_len_++] = *p++;
+      }
+      stripe(buf_);
+      buf_len_ = 0;
+    }
+
+    for (; p + 32 <= end; p += 32) {
+      stripe(p);
+    }
+
+    for (; p != end; p++) {
+      buf_[buf_len_++] = *p;
+    }
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  explicit operator result_type() const {
+    uint64_t h;
+    if (total_len_ >= 32) {
+      h = __hash_rotl64(v_[0], 1) + __hash_rotl64(v_[1], 7) +
+          __hash_rotl64(v_[2], 12) + __hash_rotl64(v_[3], 18);
+      for (int i = 0; i < 4; i++) {
+        h = (h ^ round(0, v_[i])) * kPrime1 + kPrime4;
+      }
+    } else {
+      h = seed_ + kPrime5;
+    }
+
+    h += total_len_;
+
+    const uint8_t *p = buf_;
+    const uint8_t *end = buf_ + buf_len_;
+    for (; p + 8 <= end; p += 8) {
+      h ^= round(0, __hash_read64_le(p));
+      h = __hash_rotl64(h, 27) * kPrime1 + kPrime4;
+    }
+    if (p + 4 <= end) {
+      h ^= uint64_t(__hash_read32_le(p)) * kPrime1;
+      h = __hash_rotl64(h, 23) * kPrime2 + kPrime3;
+      p += 4;
+    }
+    for (; p != end; p++) {
+      h ^= uint64_t(*p) * kPrime5;
+      h = __hash_rotl64(h, 11) * kPrime1;
+    }
+
+    h ^= h >> 33;
+    h *= kPrime2;
+    h ^= h >> 29;
+    h *= kPrime3;
+    h ^= h >> 32;
+    return h;
+  }
+
+ private:
+  static const uint64_t kPrime1 = 0x9e3779b185ebca87ull;
+  static const uint64_t kPrime2 = 0xc2b2ae3d27d4eb4full;
+  static const uint64_t kPrime3 = 0x165667b19e3779f9ull;
+  static const uint64_t kPrime4 = 0x85ebca77c2b2ae63ull;
+  static const uint64_t kPrime5 = 0x27d4eb2f165667c5ull;
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  static uint64_t round(uint64_t acc, uint64_t input) {
+    acc += input * kPrime2;
+    acc = __hash_rotl64(acc, 31);
+    return acc * kPrime1;
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  void stripe(const uint8_t *p) {
+    v_[0] = round(v_[0], __hash_read64_le(p));
+    v_[1] = round(v_[1], __hash_read64_le(p + 8));
+    v_[2] = round(v_[2], __hash_read64_le(p + 16));
+    v_[3] = round(v_[3], __hash_read64_le(p + 24));
+  }
+
+  uint64_t v_[4];
+  uint64_t seed_;
+  uint64_t total_len_;
+  uint8_t buf_[32];
+  uint32_t buf_len_;
+};
+
+///
+/// Streaming SipHash-2-4(64bit output). Implementation is in src/hash.cc.
+/// Default constructed hasher uses all-zero key.
+///
+class siphash_hasher {
+ public:
+  typedef uint64_t result_type;
+
+  siphash_hasher();
+  explicit siphash_hasher(const uint8_t key[16]);
+
+  void operator()(const void *key, size_t len);
+
+  explicit operator result_type() const;
+
+ private:
+  void init(const uint8_t key[16]);
+
+  uint64_t v_[4];
+  uint64_t total_len_;
+  uint8_t buf_[8];
+  uint32_t buf_len_;
+};
 
 } // namespace nanostl
 
@@ -0,0 +1,81 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 Light Transport Entertainment, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef NANOSTL___PARALLEL_H_
+#define NANOSTL___PARALLEL_H_
+
+//
+// Minimal fork-join helper for internal bulk routines.
+//
+// `__parallel_run(n, fn, ctx)` calls `fn(ctx, i)` for i in [0, n) on `n`
+// threads(the calling thread runs i == 0) and returns when all calls have
+// finished. Calls run sequentially when NANOSTL_NO_THREAD is defined or a
+// thread could not be created.
+//
+// Implementation is in src/nanothread.cc
+//
+
+namespace nanostl {
+
+typedef void (*__parallel_func)(void *ctx, unsigned index);
+
+#if defined(NANOSTL_NO_THREAD)
+
+inline unsigned __hardware_concurrency() { return 1; }
+
+inline void __parallel_run(unsigned n, __parallel_func fn, void *ctx) {
+  for (unsigned i = 0; i < n; i++) {
+    fn(ctx, i);
+  }
+}
+
+#else
+
+// Number of hardware threads(>= 1).
+unsigned __hardware_concurrency();
+
+void __parallel_run(unsigned n, __parallel_func fn, void *ctx);
+
+#endif
+
+// Resolves a user supplied thread count(0 = hardware concurrency) and clamps
+// it so that each thread gets at least `min_work` of `work`.
+inline unsigned __parallel_num_threads(unsigned requested,
+                                       unsigned long long work,
+                                       unsigned long long min_work) {
+  unsigned n = requested ? requested : __hardware_concurrency();
+  if (min_work == 0) {
+    min_work = 1;
+  }
+  const unsigned long long max_n = work / min_work;
+  if (max_n < n) {
+    n = unsigned(max_n);
+  }
+  return n ? n : 1;
+}
+
+}  // namespace nanostl
+
+#endif  // NANOSTL___PARALLEL_H_
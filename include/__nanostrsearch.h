@@ -0,0 +1,717 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 Light Transport Entertainment, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef NANOSTL___STRSEARCH_H_
+#define NANOSTL___STRSEARCH_H_
+
+#include "nanocommon.h"
+#include "nanocstdint.h"
+
+//
+// Search kernels used by `basic_string::find*`.
+//
+// - Single char : compare 16/32 bytes at once.
+// - Substring   : "first/last byte" filter. Blocks at `i` and `i + m - 1`
+//                 are compared with the first and last char of the needle;
+//                 only positions where both match are verified.
+// - Char class  : nibble table lookup(pshufb/tbl). A byte `x` is in the set
+//                 when lo_table[x & 15] & hi_table[x >> 4] != 0. Each distinct
+//                 high nibble of the set gets one bit, so this is exact for
+//                 sets with at most 8 distinct high nibbles(e.g. any set of
+//                 ASCII punctuation/whitespace/digits). Other sets use a 256bit
+//                 bitmap.
+//
+// The ISA is selected at compile time(-msse2, -mssse3, -mavx2, aarch64).
+// Define NANOSTL_NO_SIMD to force the scalar path. Only `char` strings use
+// the SIMD path.
+//
+
+#if !defined(NANOSTL_NO_SIMD) && !defined(__CUDACC__)
+
+// __nullptr defines `nullptr` as a macro, which breaks system headers.
+#pragma push_macro("nullptr")
+#undef nullptr
+
+#if defined(__AVX2__)
+#define NANOSTL_STRSEARCH_AVX2
+#define NANOSTL_STRSEARCH_SIMD
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define NANOSTL_STRSEARCH_SSE2
+#define NANOSTL_STRSEARCH_SIMD
+#include <emmintrin.h>
+#if defined(__SSSE3__)
+#define NANOSTL_STRSEARCH_SSSE3
+#include <tmmintrin.h>
+#endif
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define NANOSTL_STRSEARCH_NEON
+#define NANOSTL_STRSEARCH_SIMD
+#include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER) && defined(NANOSTL_STRSEARCH_SIMD)
+#include <intrin.h>
+#endif
+
+#pragma pop_macro("nullptr")
+
+#endif
+
+namespace nanostl {
+
+namespace __strsearch {
+
+static const unsigned long long npos = ~0ull;
+
+// Index of the lowest/highest set bit. `x` must not be 0.
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline unsigned __ctz64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+  return unsigned(__builtin_ctzll(x));
+#elif defined(_MSC_VER) && defined(_M_X64)
+  unsigned long idx;
+  _BitScanForward64(&idx, x);
+  return unsigned(idx);
+#else
+  unsigned n = 0;
+  while ((x & 1) == 0) {
+    x >>= 1;
+    n++;
+  }
+  return n;
+#endif
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline unsigned __bsr64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+  return 63u - unsigned(__builtin_clzll(x));
+#elif defined(_MSC_VER) && defined(_M_X64)
+  unsigned long idx;
+  _BitScanReverse64(&idx, x);
+  return unsigned(idx);
+#else
+  unsigned n = 0;
+  while (x >>= 1) {
+    n++;
+  }
+  return n;
+#endif
+}
+
+template <class charT>
+NANOSTL_HOST_AND_DEVICE_QUAL inline bool __equal(const charT *p,
+                                                 const charT *q,
+                                                 unsigned long long n) {
+  for (unsigned long long i = 0; i < n; i++) {
+    if (p[i] != q[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+//
+// Scalar implementations(any char type).
+//
+
+template <class charT>
+NANOSTL_HOST_AND_DEVICE_QUAL inline unsigned long long find_char(
+    const charT *s, unsigned long long n, charT c) {
+  for (unsigned long long i = 0; i < n; i++) {
+    if (s[i] == c) {
+      return i;
+    }
+  }
+  return npos;
+}
+
+template <class charT>
+NANOSTL_HOST_AND_DEVICE_QUAL inline unsigned long long rfind_char(
+    const charT *s, unsigned long long n, charT c) {
+  while (n > 0) {
+    n--;
+    if (s[n] == c) {
+      return n;
+    }
+  }
+  return npos;
+}
+
+template <class charT>
+NANOSTL_HOST_AND_DEVICE_QUAL inline unsigned long long find(
+    const charT *s, unsigned long long n, const charT *needle,
+    unsigned long long m) {
+  if (m == 0) {
+    return 0;
+  }
+  if (m > n) {
+    return npos;
+  }
+  const charT first = needle[0];
+  for (unsigned long long i = 0; i <= n - m; i++) {
+    if ((s[i] == first) && __equal(s + i + 1, needle + 1, m - 1)) {
+      return i;
+    }
+  }
+  return npos;
+}
+
+template <class charT>
+NANOSTL_HOST_AND_DEVICE_QUAL inline unsigned long long rfind(
+    const charT *s, unsigned long long n, const charT *needle,
+    unsigned long long m) {
+  if (m > n) {
+    return npos;
+  }
+  unsigned long long i = n - m + 1;
+  while (i > 0) {
+    i--;
+    if (__equal(s + i, needle, m)) {
+      return i;
+    }
+  }
+  return npos;
+}
+
+// Linear scan of the set. Fine for the short sets used with wide chars.
+template <class charT>
+NANOSTL_HOST_AND_DEVICE_QUAL inline bool __in_set(charT c, const charT *set,
+                                                  unsigned long long k) {
+  for (unsigned long long j = 0; j < k; j++) {
+    if (set[j] == c) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// `in` == true : find_first_of, `in` == false : find_first_not_of
+template <class charT>
+NANOSTL_HOST_AND_DEVICE_QUAL inline unsigned long long find_first_of(
+    const charT *s, unsigned long long n, const charT *set,
+    unsigned long long k, bool in) {
+  for (unsigned long long i = 0; i < n; i++) {
+    if (__in_set(s[i], set, k) == in) {
+      return i;
+    }
+  }
+  return npos;
+}
+
+template <class charT>
+NANOSTL_HOST_AND_DEVICE_QUAL inline unsigned long long find_last_of(
+    const charT *s, unsigned long long n, const charT *set,
+    unsigned long long k, bool in) {
+  while (n > 0) {
+    n--;
+    if (__in_set(s[n], set, k) == in) {
+      return n;
+    }
+  }
+  return npos;
+}
+
+//
+// `char` implementations.
+//
+
+// Character set for byte strings. The nibble tables are only used by the
+// SIMD paths and are built on demand by `build_nibble()`.
+struct __charset {
+  uint64_t bitmap[4];
+  uint8_t lo[16];  // nibble tables
+  uint8_t hi[16];
+  bool use_nibble;  // true when the nibble tables are built and exact
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  __charset(const char *set, unsigned long long k) {
+    for (int i = 0; i < 4; i++) {
+      bitmap[i] = 0;
+    }
+    for (unsigned long long j = 0; j < k; j++) {
+      uint8_t c = uint8_t(set[j]);
+      bitmap[c >> 6] |= 1ull << (c & 63);
+    }
+    use_nibble = false;
+  }
+
+  // Builds `lo`/`hi`. Returns false when the set has chars with more than 8
+  // distinct high nibbles(the tables can't be exact).
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  bool build_nibble() {
+    for (int i = 0; i < 16; i++) {
+      lo[i] = 0;
+      hi[i] = 0;
+    }
+    int num_hi = 0;
+    for (int h = 0; h < 16; h++) {
+      int l;
+      for (l = 0; l < 16; l++) {
+        if (contains(uint8_t((h << 4) | l))) {
+          break;
+        }
+      }
+      if (l == 16) {
+        continue;  // no char with this high nibble
+      }
+      if (num_hi == 8) {
+        use_nibble = false;
+        return false;
+      }
+      const uint8_t bit = uint8_t(1u << num_hi);
+      hi[h] = bit;
+      for (l = 0; l < 16; l++) {
+        if (contains(uint8_t((h << 4) | l))) {
+          lo[l] |= bit;
+        }
+      }
+      num_hi++;
+    }
+    use_nibble = true;
+    return true;
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  bool contains(uint8_t c) const {
+    return (bitmap[c >> 6] >> (c & 63)) & 1;
+  }
+};
+
+#if defined(NANOSTL_STRSEARCH_SIMD)
+
+// Block primitives. Masks have `kBitsPerByte` bits per byte(1 on x86, 4 on
+// NEON).
+#if defined(NANOSTL_STRSEARCH_AVX2)
+
+struct __simd {
+  typedef __m256i vec;
+  static const unsigned long long kWidth = 32;
+  static const unsigned kBitsPerByte = 1;
+
+  static inline vec splat(char c) { return _mm256_set1_epi8(c); }
+  static inline vec load(const char *p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+  }
+  static inline uint64_t eq(vec a, vec b) {
+    return uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)));
+  }
+  static inline uint64_t full() { return 0xffffffffull; }
+
+  static const bool kHasNibble = true;
+  struct table {
+    vec lo, hi;
+    explicit table(const __charset &cs) {
+      __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i *>(cs.lo));
+      __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i *>(cs.hi));
+      lo = _mm256_broadcastsi128_si256(l);
+      hi = _mm256_broadcastsi128_si256(h);
+    }
+  };
+  static inline uint64_t in_set(vec x, const table &t) {
+    const vec mask = _mm256_set1_epi8(0x0f);
+    vec l = _mm256_and_si256(x, mask);
+    vec h = _mm256_and_si256(_mm256_srli_epi16(x, 4), mask);
+    vec m = _mm256_and_si256(_mm256_shuffle_epi8(t.lo, l),
+                             _mm256_shuffle_epi8(t.hi, h));
+    return eq(m, _mm256_setzero_si256()) ^ full();
+  }
+};
+
+#elif defined(NANOSTL_STRSEARCH_SSE2)
+
+struct __simd {
+  typedef __m128i vec;
+  static const unsigned long long kWidth = 16;
+  static const unsigned kBitsPerByte = 1;
+
+  static inline vec splat(char c) { return _mm_set1_epi8(c); }
+  static inline vec load(const char *p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+  }
+  static inline uint64_t eq(vec a, vec b) {
+    return uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)));
+  }
+  static inline uint64_t full() { return 0xffffull; }
+
+#if defined(NANOSTL_STRSEARCH_SSSE3)
+  static const bool kHasNibble = true;
+  struct table {
+    vec lo, hi;
+    explicit table(const __charset &cs) {
+      lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(cs.lo));
+      hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(cs.hi));
+    }
+  };
+  static inline uint64_t in_set(vec x, const table &t) {
+    const vec mask = _mm_set1_epi8(0x0f);
+    vec l = _mm_and_si128(x, mask);
+    vec h = _mm_and_si128(_mm_srli_epi16(x, 4), mask);
+    vec m = _mm_and_si128(_mm_shuffle_epi8(t.lo, l), _mm_shuffle_epi8(t.hi, h));
+    return eq(m, _mm_setzero_si128()) ^ full();
+  }
+#else
+  // pshufb requires SSSE3.
+  static const bool kHasNibble = false;
+  struct table {
+    explicit table(const __charset &) {}
+  };
+  static inline uint64_t in_set(vec, const table &) { return 0; }
+#endif
+};
+
+#elif defined(NANOSTL_STRSEARCH_NEON)
+
+struct __simd {
+  typedef uint8x16_t vec;
+  static const unsigned long long kWidth = 16;
+  static const unsigned kBitsPerByte = 4;
+
+  static inline vec splat(char c) { return vdupq_n_u8(uint8_t(c)); }
+  static inline vec load(const char *p) {
+    return vld1q_u8(reinterpret_cast<const uint8_t *>(p));
+  }
+  // 0xff/0x00 per byte -> 4 bits per byte.
+  static inline uint64_t movemask(vec m) {
+    return vget_lane_u64(
+        vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(m), 4)), 0);
+  }
+  static inline uint64_t eq(vec a, vec b) { return movemask(vceqq_u8(a, b)); }
+  static inline uint64_t full() { return ~0ull; }
+
+  static const bool kHasNibble = true;
+  struct table {
+    vec lo, hi;
+    explicit table(const __charset &cs) {
+      lo = vld1q_u8(cs.lo);
+      hi = vld1q_u8(cs.hi);
+    }
+  };
+  static inline uint64_t in_set(vec x, const table &t) {
+    vec l = vandq_u8(x, vdupq_n_u8(0x0f));
+    vec h = vshrq_n_u8(x, 4);
+    vec m = vandq_u8(vqtbl1q_u8(t.lo, l), vqtbl1q_u8(t.hi, h));
+    return movemask(vtstq_u8(m, m));
+  }
+};
+
+#endif
+
+inline unsigned long long __first_index(uint64_t mask) {
+  return __ctz64(mask) / __simd::kBitsPerByte;
+}
+
+inline unsigned long long __last_index(uint64_t mask) {
+  return __bsr64(mask) / __simd::kBitsPerByte;
+}
+
+// Clears the lowest matching byte in `mask`.
+inline uint64_t __clear_first(uint64_t mask) {
+  const uint64_t byte_bits = (1ull << __simd::kBitsPerByte) - 1;
+  return mask & ~(byte_bits << (__ctz64(mask) & ~(__simd::kBitsPerByte - 1)));
+}
+
+#endif  // NANOSTL_STRSEARCH_SIMD
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline unsigned long long find_char(const char *s, unsigned long long n,
+                                    char c) {
+  unsigned long long i = 0;
+#if defined(NANOSTL_STRSEARCH_SIMD)
+  const __simd::vec vc = __simd::splat(c);
+  for (; i + __simd::kWidth <= n; i += __simd::kWidth) {
+    uint64_t mask = __simd::eq(__simd::load(s + i), vc);
+    if (mask) {
+      return i + __first_index(mask);
+    }
+  }
+#endif
+  for (; i < n; i++) {
+    if (s[i] == c) {
+      return i;
+    }
+  }
+  return npos;
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline unsigned long long rfind_char(const char *s, unsigned long long n,
+                                     char c) {
+#if defined(NANOSTL_STRSEARCH_SIMD)
+  const __simd::vec vc = __simd::splat(c);
+  while (n >= __simd::kWidth) {
+    n -= __simd::kWidth;
+    uint64_t mask = __simd::eq(__simd::load(s + n), vc);
+    if (mask) {
+      return n + __last_index(mask);
+    }
+  }
+#endif
+  while (n > 0) {
+    n--;
+    if (s[n] == c) {
+      return n;
+    }
+  }
+  return npos;
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline unsigned long long find(const char *s, unsigned long long n,
+                               const char *needle, unsigned long long m) {
+  if (m == 0) {
+    return 0;
+  }
+  if (m > n) {
+    return npos;
+  }
+  if (m == 1) {
+    return find_char(s, n, needle[0]);
+  }
+
+  unsigned long long i = 0;
+#if defined(NANOSTL_STRSEARCH_SIMD)
+  const __simd::vec first = __simd::splat(needle[0]);
+  const __simd::vec last = __simd::splat(needle[m - 1]);
+  // Both blocks must be inside `s`: i + (m - 1) + kWidth <= n
+  for (; i + m - 1 + __simd::kWidth <= n; i += __simd::kWidth) {
+    uint64_t mask = __simd::eq(__simd::load(s + i), first) &
+                    __simd::eq(__simd::load(s + i + m - 1), last);
+    while (mask) {
+      const unsigned long long k = i + __first_index(mask);
+      if (__equal(s + k + 1, needle + 1, m - 2)) {
+        return k;
+      }
+      mask = __clear_first(mask);
+    }
+  }
+#endif
+  for (; i + m <= n; i++) {
+    if ((s[i] == needle[0]) && (s[i + m - 1] == needle[m - 1]) &&
+        __equal(s + i + 1, needle + 1, m - 2)) {
+      return i;
+    }
+  }
+  return npos;
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline unsigned long long rfind(const char *s, unsigned long long n,
+                                const char *needle, unsigned long long m) {
+  if (m > n) {
+    return npos;
+  }
+  if (m == 0) {
+    return n;
+  }
+  if (m == 1) {
+    return rfind_char(s, n, needle[0]);
+  }
+
+  // Candidate start positions are [0, end).
+  unsigned long long end = n - m + 1;
+#if defined(NANOSTL_STRSEARCH_SIMD)
+  const __simd::vec first = __simd::splat(needle[0]);
+  const __simd::vec last = __simd::splat(needle[m - 1]);
+  while (end >= __simd::kWidth) {
+    const unsigned long long i = end - __simd::kWidth;
+    uint64_t mask = __simd::eq(__simd::load(s + i), first) &
+                    __simd::eq(__simd::load(s + i + m - 1), last);
+    while (mask) {
+      const unsigned long long b = __last_index(mask);
+      if (__equal(s + i + b + 1, needle + 1, m - 2)) {
+        return i + b;
+      }
+      mask &= (1ull << (b * __simd::kBitsPerByte)) - 1;
+    }
+    end = i;
+  }
+#endif
+  while (end > 0) {
+    end--;
+    if ((s[end] == needle[0]) && __equal(s + end + 1, needle + 1, m - 1)) {
+      return end;
+    }
+  }
+  return npos;
+}
+
+#if defined(NANOSTL_STRSEARCH_SIMD)
+// Builds the nibble tables of `cs` when the target has a nibble lookup.
+inline const __charset &__prepare_nibble(__charset &cs) {
+  if (__simd::kHasNibble) {
+    cs.build_nibble();
+  }
+  return cs;
+}
+#endif
+
+//
+// Prepared character set for repeated searches(e.g. tokenizing). Uses the
+// nibble table when exact, otherwise compares against each char of small
+// sets(up to kMaxSplat distinct chars, also available without SSSE3).
+//
+struct __charset_finder {
+  static const int kMaxSplat = 8;
+
+  __charset cs;
+#if defined(NANOSTL_STRSEARCH_SIMD)
+  __simd::table t;
+  __simd::vec splat[kMaxSplat];
+#endif
+  int num_splat;  // 0: use the nibble table(or scalar)
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  __charset_finder(const char *set, unsigned long long k)
+      : cs(set, k)
+#if defined(NANOSTL_STRSEARCH_SIMD)
+        ,
+        t(__prepare_nibble(cs))
+#endif
+  {
+    num_splat = 0;
+#if defined(NANOSTL_STRSEARCH_SIMD)
+    if (__simd::kHasNibble && cs.use_nibble) {
+      return;
+    }
+    int n = 0;
+    for (int c = 0; c < 256; c++) {
+      if (cs.contains(uint8_t(c))) {
+        if (n == kMaxSplat) {
+          return;
+        }
+        splat[n++] = __simd::splat(char(c));
+      }
+    }
+    num_splat = n;
+#endif
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  bool contains(char c) const { return cs.contains(uint8_t(c)); }
+
+  // `in` == true : first char in the set, false : first char not in the set.
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  unsigned long long find(const char *s, unsigned long long n, bool in) const {
+    unsigned long long i = 0;
+#if defined(NANOSTL_STRSEARCH_SIMD)
+    const uint64_t flip = in ? 0 : __simd::full();
+    if (num_splat > 0) {
+      for (; i + __simd::kWidth <= n; i += __simd::kWidth) {
+        const __simd::vec x = __simd::load(s + i);
+        uint64_t mask = 0;
+        for (int j = 0; j < num_splat; j++) {
+          mask |= __simd::eq(x, splat[j]);
+        }
+        mask ^= flip;
+        if (mask) {
+          return i + __first_index(mask);
+        }
+      }
+    } else if (__simd::kHasNibble && cs.use_nibble) {
+      for (; i + __simd::kWidth <= n; i += __simd::kWidth) {
+        uint64_t mask = __simd::in_set(__simd::load(s + i), t) ^ flip;
+        if (mask) {
+          return i + __first_index(mask);
+        }
+      }
+    }
+#endif
+    for (; i < n; i++) {
+      if (cs.contains(uint8_t(s[i])) == in) {
+        return i;
+      }
+    }
+    return npos;
+  }
+};
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline unsigned long long find_first_of(const char *s, unsigned long long n,
+                                        const char *set, unsigned long long k,
+                                        bool in) {
+  if (in && (k == 1)) {
+    return find_char(s, n, set[0]);
+  }
+
+  __charset cs(set, k);
+  unsigned long long i = 0;
+#if defined(NANOSTL_STRSEARCH_SIMD)
+  if (__simd::kHasNibble && (n >= __simd::kWidth) && cs.build_nibble()) {
+    const __simd::table t(cs);
+    const uint64_t flip = in ? 0 : __simd::full();
+    for (; i + __simd::kWidth <= n; i += __simd::kWidth) {
+      uint64_t mask = __simd::in_set(__simd::load(s + i), t) ^ flip;
+      if (mask) {
+        return i + __first_index(mask);
+      }
+    }
+  }
+#endif
+  for (; i < n; i++) {
+    if (cs.contains(uint8_t(s[i])) == in) {
+      return i;
+    }
+  }
+  return npos;
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline unsigned long long find_last_of(const char *s, unsigned long long n,
+                                       const char *set, unsigned long long k,
+                                       bool in) {
+  if (in && (k == 1)) {
+    return rfind_char(s, n, set[0]);
+  }
+
+  __charset cs(set, k);
+#if defined(NANOSTL_STRSEARCH_SIMD)
+  if (__simd::kHasNibble && (n >= __simd::kWidth) && cs.build_nibble()) {
+    const __simd::table t(cs);
+    const uint64_t flip = in ? 0 : __simd::full();
+    while (n >= __simd::kWidth) {
+      n -= __simd::kWidth;
+      uint64_t mask = __simd::in_set(__simd::load(s + n), t) ^ flip;
+      if (mask) {
+        return n + __last_index(mask);
+      }
+    }
+  }
+#endif
+  while (n > 0) {
+    n--;
+    if (cs.contains(uint8_t(s[n])) == in) {
+      return n;
+    }
+  }
+  return npos;
+}
+
+}  // namespace __strsearch
+
+}  // namespace nanostl
+
+#endif  // NANOSTL___STRSEARCH_H_
@@ -788,7 +788,7 @@ static inline int to_chars(const floating_decimal_32 v, const bool sign, char* c
 }
 
 NANOSTL_HOST_AND_DEVICE_QUAL
-static int f2s_buffered_n(float f, char* result) {
+static inline int f2s_buffered_n(float f, char* result) {
   // Step 1: Decode the floating-point number, and unify normalized and subnormal cases.
   const uint32_t bits = float_to_bits(f);
 
@@ -816,7 +816,7 @@ static int f2s_buffered_n(float f, char* result) {
 
 // result: 16bytes for float
 NANOSTL_HOST_AND_DEVICE_QUAL
-static void f2s_buffered(float f, char* result) {
+static inline void f2s_buffered(float f, char* result) {
   const int index = f2s_buffered_n(f, result);
 
   // Terminate the string.
@@ -1251,7 +1251,7 @@ static inline bool d2d_small_int(const uint64_t ieeeMantissa, const uint32_t iee
 
 
 NANOSTL_HOST_AND_DEVICE_QUAL
-static int d2s_buffered_n(double f, char* result) {
+static inline int d2s_buffered_n(double f, char* result) {
   // Step 1: Decode the floating-point number, and unify normalized and subnormal cases.
   const uint64_t bits = double_to_bits(f);
 
@@ -1297,7 +1297,7 @@ static int d2s_buffered_n(double f, char* result) {
 
 // bufsize max: 25
 NANOSTL_HOST_AND_DEVICE_QUAL
-static void d2s_buffered(double f, char* result) {
+static inline void d2s_buffered(double f, char* result) {
   const int index = d2s_buffered_n(f, result);
 
   // Terminate the string.
@@ -1357,7 +1357,7 @@ inline float int32Bits2Float(uint32_t bits) {
 }
 
 NANOSTL_HOST_AND_DEVICE_QUAL
-static enum RyuStatus s2f_n(const char * buffer, const int len, float * result) {
+static inline enum RyuStatus s2f_n(const char * buffer, const int len, float * result) {
   if (len == 0) {
     return RYU_INPUT_TOO_SHORT;
   }
@@ -1580,7 +1580,7 @@ inline double int64Bits2Double(uint64_t bits) {
 }
 
 NANOSTL_HOST_AND_DEVICE_QUAL
-static enum RyuStatus s2d_n(const char * buffer, const int len, double * result) {
+static inline enum RyuStatus s2d_n(const char * buffer, const int len, double * result) {
   if (len == 0) {
     return RYU_INPUT_TOO_SHORT;
   }
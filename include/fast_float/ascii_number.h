@@ -4,7 +4,6 @@
 //#include <cctype>
 #include "nanocstdint.h"
 #include "nanocstring.h"
-#include <iterator>
 
 #include "float_common.h"
 
@@ -106,7 +105,7 @@ parsed_number_string parse_number_string(const char *p, const char *pend, parse_
 
   uint64_t i = 0; // an unsigned int avoids signed overflows (which are bad)
 
-  while ((std::distance(p, pend) >= 8) && is_made_of_eight_digits_fast(p)) {
+  while (((pend - p) >= 8) && is_made_of_eight_digits_fast(p)) {
     i = i * 100000000 + parse_eight_digits_unrolled(p); // in rare cases, this will overflow, but that's ok
     p += 8;
   }
@@ -126,7 +125,7 @@ parsed_number_string parse_number_string(const char *p, const char *pend, parse_
     const char* before = p;
     // can occur at most twice without overflowing, but let it occur more, since
     // for integers with many digits, digit parsing is the primary bottleneck.
-    while ((std::distance(p, pend) >= 8) && is_made_of_eight_digits_fast(p)) {
+    while (((pend - p) >= 8) && is_made_of_eight_digits_fast(p)) {
       i = i * 100000000 + parse_eight_digits_unrolled(p); // in rare cases, this will overflow, but that's ok
       p += 8;
     }
@@ -1,10 +1,8 @@
 #ifndef FASTFLOAT_BIGINT_H
 #define FASTFLOAT_BIGINT_H
 
-#include <algorithm>
-#include <cstdint>
-#include <climits>
-#include <cstring>
+#include <stdint.h>
+#include <string.h>
 
 #include "float_common.h"
 
@@ -119,7 +117,9 @@ struct stackvec {
       size_t count = new_len - len();
       limb* first = data + len();
       limb* last = first + count;
-      ::std::fill(first, last, value);
+      for (limb* p = first; p != last; p++) {
+        *p = value;
+      }
       set_len(new_len);
     } else {
       set_len(new_len);
@@ -478,7 +478,9 @@ struct bigint {
       // fill in empty limbs
       limb* first = vec.data;
       limb* last = first + n;
-      ::std::fill(first, last, 0);
+      for (limb* p = first; p != last; p++) {
+        *p = 0;
+      }
       vec.set_len(n + vec.len());
       return true;
     } else {
@@ -2,6 +2,13 @@
 #define FASTFLOAT_FAST_FLOAT_H
 
 #include "nanosystem_error.h"
+#include "nanotype_traits.h"
+#include "nanolimits.h"
+
+// nanostl's `nullptr` macro(__nullptr) is not usable outside of namespace
+// nanostl.
+#pragma push_macro("nullptr")
+#undef nullptr
 
 namespace fast_float {
 enum chars_format {
@@ -60,4 +67,6 @@ from_chars_result from_chars_advanced(const char *first, const char *last,
 
 }
 #include "parse_number.h"
+
+#pragma pop_macro("nullptr")
 #endif // FASTFLOAT_FAST_FLOAT_H
@@ -1,11 +1,14 @@
 #ifndef FASTFLOAT_FLOAT_COMMON_H
 #define FASTFLOAT_FLOAT_COMMON_H
 
-#include <cfloat>
-#include <cstdint>
-#include <cassert>
-#include <cstring>
-#include <type_traits>
+#include <float.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+
+#include "nanotype_traits.h"
 
 #if (defined(__x86_64) || defined(__x86_64__) || defined(_M_X64)   \
        || defined(__amd64) || defined(__aarch64__) || defined(_M_ARM64) \
@@ -82,7 +85,6 @@
 #endif
 
 #ifndef FASTFLOAT_DEBUG_ASSERT
-#include <cassert>
 #define FASTFLOAT_DEBUG_ASSERT(x) assert(x)
 #endif
 
@@ -222,7 +224,7 @@ constexpr static float powers_of_ten_float[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5,
                                                 1e6, 1e7, 1e8, 1e9, 1e10};
 
 template <typename T> struct binary_format {
-  using equiv_uint = typename std::conditional<sizeof(T) == 4, uint32_t, uint64_t>::type;
+  using equiv_uint = typename nanostl::conditional<sizeof(T) == 4, uint32_t, uint64_t>::type;
 
   static inline constexpr int mantissa_explicit_bits();
   static inline constexpr int minimum_exponent();
@@ -381,7 +383,7 @@ fastfloat_really_inline void to_float(bool negative, adjusted_mantissa am, T &va
   word = negative
   ? word | (uint64_t(1) << binary_format<T>::sign_index()) : word;
 #if FASTFLOAT_IS_BIG_ENDIAN == 1
-   if (std::is_same<T, float>::value) {
+   if (nanostl::is_same<T, float>::value) {
      ::memcpy(&value, (char *)&word + 4, sizeof(T)); // extract value at offset 4-7 if float on big-endian
    } else {
      ::memcpy(&value, &word, sizeof(T));
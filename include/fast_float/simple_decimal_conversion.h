@@ -15,7 +15,7 @@
  **/
 #include "ascii_number.h"
 #include "decimal_to_binary.h"
-#include <cstdint>
+#include <stdint.h>
 
 namespace fast_float {
 
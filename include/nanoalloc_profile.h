@@ -0,0 +1,178 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 Light Transport Entertainment, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef NANOSTL_ALLOC_PROFILE_H_
+#define NANOSTL_ALLOC_PROFILE_H_
+
+#include "nanocommon.h"
+#include "nanoallocator.h"
+
+//
+// Allocation profiler(opt-in, define NANOSTL_ALLOC_PROFILE or use the CMake
+// option of the same name).
+//
+// Every allocation through `nanostl::allocator`(and so vector, string, map
+// nodes, ... with the default allocator) is accounted to a site: the element
+// type, plus the tag of the innermost `NANOSTL_ALLOC_PROFILE_SCOPE` of the
+// thread. Per site it records live/peak bytes, allocation counts and a
+// histogram of request sizes.
+//
+//   void load_scene() {
+//     NANOSTL_ALLOC_PROFILE_SCOPE("load_scene");
+//     nanostl::vector<float> vertices;  // site: float / "load_scene"
+//     ...
+//   }
+//
+//   nanostl::alloc_profile_site sites[64];
+//   size_type n = nanostl::alloc_profile_snapshot(sites, 64);
+//   nanostl::alloc_profile_report();  // table to stderr
+//
+// Counters are per thread(only the owning thread writes them, no lock and no
+// atomic read-modify-write). Live and peak bytes need a global view, they are
+// one relaxed atomic add per site. Registering a new site or thread takes a
+// lock once.
+//
+// A block is accounted to the site where it was allocated, even when it is
+// freed in another scope or thread. Sites with live allocations are reported
+// at exit(objects with static storage duration which are destroyed after
+// the report show up there as well).
+//
+// Without NANOSTL_ALLOC_PROFILE nothing is recorded, `allocator` is
+// unchanged, the scope macro expands to nothing and the functions below are
+// empty inline stubs.
+//
+// Implementation is in src/nanoalloc_profile.cc(also requires
+// src/nanothread.cc unless NANOSTL_NO_THREAD is defined).
+//
+
+namespace nanostl {
+
+// Histogram buckets: <= 16, <= 32, ..., <= 256K, > 256K bytes.
+static const unsigned kAllocProfileBuckets = 16;
+
+// Sites beyond this are accounted to site 0("(overflow)").
+static const unsigned kAllocProfileMaxSites = 256;
+
+struct alloc_profile_site {
+  const char *type_name;  // e.g. "int", "nanostl::basic_string<char>"
+  const char *tag;        // NANOSTL_ALLOC_PROFILE_SCOPE tag or null
+  size_type live_bytes;
+  size_type peak_bytes;
+  size_type live_count;   // allocations not yet freed
+  size_type alloc_count;  // total allocations
+  size_type alloc_bytes;  // total bytes allocated
+  size_type histogram[kAllocProfileBuckets];  // allocations per request size
+};
+
+///
+/// Request size histogram bucket of `bytes`.
+///
+inline unsigned alloc_profile_bucket(size_type bytes) {
+  unsigned b = 0;
+  while ((b + 1 < kAllocProfileBuckets) && (bytes > (size_type(16) << b))) {
+    b++;
+  }
+  return b;
+}
+
+#if defined(NANOSTL_ALLOC_PROFILE)
+
+///
+/// Copies up to `max_sites` sites(those with at least one allocation) into
+/// `sites` and returns the number of such sites(may be larger than
+/// `max_sites`).
+///
+size_type alloc_profile_snapshot(alloc_profile_site *sites,
+                                 size_type max_sites);
+
+///
+/// Writes a table of all sites(or only those with live allocations) line by
+/// line to `out`(stderr if null).
+///
+void alloc_profile_report(bool leaks_only = false,
+                          void (*out)(const char *line, void *arg) = 0,
+                          void *arg = 0);
+
+///
+/// Enables/disables the leak report at exit(enabled by default).
+///
+void alloc_profile_set_leak_report(bool enable);
+
+///
+/// Sets the tag of the calling thread and returns the previous one. `tag`
+/// must have static storage duration(tags are compared by pointer).
+///
+const char *alloc_profile_set_tag(const char *tag);
+
+class alloc_profile_scope {
+ public:
+  explicit alloc_profile_scope(const char *tag)
+      : prev_(alloc_profile_set_tag(tag)) {}
+  ~alloc_profile_scope() { alloc_profile_set_tag(prev_); }
+
+ private:
+  alloc_profile_scope(const alloc_profile_scope &);
+  alloc_profile_scope &operator=(const alloc_profile_scope &);
+
+  const char *prev_;
+};
+
+#define NANOSTL_ALLOC_PROFILE_CONCAT2(a, b) a##b
+#define NANOSTL_ALLOC_PROFILE_CONCAT(a, b) NANOSTL_ALLOC_PROFILE_CONCAT2(a, b)
+#define NANOSTL_ALLOC_PROFILE_SCOPE(tag)                     \
+  nanostl::alloc_profile_scope NANOSTL_ALLOC_PROFILE_CONCAT( \
+      __nanostl_alloc_profile_scope_, __LINE__)(tag)
+
+#else
+
+inline size_type alloc_profile_snapshot(alloc_profile_site *sites,
+                                        size_type max_sites) {
+  (void)sites;
+  (void)max_sites;
+  return 0;
+}
+
+inline void alloc_profile_report(bool leaks_only = false,
+                                 void (*out)(const char *line, void *arg) = 0,
+                                 void *arg = 0) {
+  (void)leaks_only;
+  (void)out;
+  (void)arg;
+}
+
+inline void alloc_profile_set_leak_report(bool enable) { (void)enable; }
+
+inline const char *alloc_profile_set_tag(const char *tag) {
+  (void)tag;
+  return 0;
+}
+
+#define NANOSTL_ALLOC_PROFILE_SCOPE(tag)
+
+#endif
+
+}  // namespace nanostl
+
+#endif  // NANOSTL_ALLOC_PROFILE_H_
@@ -27,6 +27,30 @@
 
 #include "nanocommon.h"
 
+// malloc/free. Only C headers: the library is built with -nostdinc++.
+// __nullptr defines `nullptr` as a macro, which breaks system headers.
+#pragma push_macro("nullptr")
+#undef nullptr
+#include <stddef.h>
+#include <stdlib.h>
+#pragma pop_macro("nullptr")
+
+#if defined(NANOSTL_USE_MIMALLOC)
+// Subset of mimalloc.h(third_party/mimalloc). mimalloc.h itself includes
+// C++ standard library headers in C++ mode, which conflict with nanostl.
+// Declarations match the ones in mimalloc.h, so including both is fine.
+extern "C" {
+void* mi_malloc_aligned(size_t size, size_t alignment) noexcept;
+void mi_free(void* p) noexcept;
+void mi_process_info(size_t* elapsed_msecs, size_t* user_msecs,
+                     size_t* system_msecs, size_t* current_rss,
+                     size_t* peak_rss, size_t* current_commit,
+                     size_t* peak_commit, size_t* page_faults) noexcept;
+void mi_stats_print_out(void (*out)(const char* msg, void* arg),
+                        void* arg) noexcept;
+}
+#endif
+
 #ifdef NANOSTL_DEBUG
 #if !defined(__CUDACC__)
 #include <iostream>
@@ -35,6 +59,26 @@
 
 namespace nanostl {
 
+// Tag of nanostl's placement new(below).
+struct __placement_tag {};
+
+}  // namespace nanostl
+
+// Placement new without <new>(a C++ standard library header). The tag keeps
+// it apart from the one in <new>, so both can be used in the same program:
+//
+//   new (p, nanostl::__placement_tag()) T(args...);
+//
+NANOSTL_HOST_AND_DEVICE_QUAL inline void* operator new(
+    decltype(sizeof(0)), void* p, nanostl::__placement_tag) noexcept {
+  return p;
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL inline void operator delete(
+    void*, void*, nanostl::__placement_tag) noexcept {}
+
+namespace nanostl {
+
 typedef unsigned long long size_type;
 
 #ifdef __clang__
@@ -44,9 +88,96 @@ typedef unsigned long long size_type;
 #endif
 #endif
 
+// Alignment of `malloc`.
+static const size_type __kMallocAlign = 2 * sizeof(void*);
+
+// Over-aligned block in `base`, which has `align` spare bytes and is aligned
+// to at least sizeof(void*). The block starts at the next multiple of
+// `align` after `base`, and `base` is stored just before it.
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline void* __align_block(void* base, size_type align) {
+  char* p = static_cast<char*>(base) + align -
+            (reinterpret_cast<size_type>(base) & (align - 1));
+  reinterpret_cast<void**>(p)[-1] = base;
+  return p;
+}
+
+// `base` of a block from `__align_block`.
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline void* __aligned_block_base(void* p) {
+  return static_cast<void**>(p)[-1];
+}
+
+///
+/// Raw storage of `bytes` aligned to `align`(power of two). Returns NULL on
+/// failure. Over-aligned blocks store the pointer from `malloc` just before
+/// the block(`__align_block`).
+///
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline void* __raw_allocate(size_type bytes, size_type align) {
+  typedef decltype(sizeof(0)) malloc_size_t;
+  if (align <= __kMallocAlign) {
+    return ::malloc(malloc_size_t(bytes));
+  }
+  if (bytes > ~size_type(0) - align) {
+    return 0;
+  }
+  void* base = ::malloc(malloc_size_t(bytes + align));
+  if (!base) {
+    return 0;
+  }
+  return __align_block(base, align);
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline void __raw_deallocate(void* p, size_type align) {
+  if (align <= __kMallocAlign) {
+    ::free(p);
+  } else {
+    ::free(__aligned_block_base(p));
+  }
+}
+
+#if defined(NANOSTL_ALLOC_PROFILE)
+// Hooks of the allocation profiler(nanoalloc_profile.h,
+// src/nanoalloc_profile.cc).
+
+// Registers a type by the signature of `__alloc_profile_type<T>::id()`.
+unsigned __alloc_profile_type_id(const char* signature);
+
+// Records an allocation of `bytes` for the type and the current tag of the
+// thread. Returns the site to pass to `__alloc_profile_deallocate`.
+unsigned __alloc_profile_allocate(unsigned type_id, size_type bytes);
+
+void __alloc_profile_deallocate(unsigned site, size_type bytes);
+
+template <typename T>
+struct __alloc_profile_type {
+  static unsigned id() {
+#if defined(_MSC_VER)
+    static const unsigned i = __alloc_profile_type_id(__FUNCSIG__);
+#else
+    static const unsigned i = __alloc_profile_type_id(__PRETTY_FUNCTION__);
+#endif
+    return i;
+  }
+};
+#endif
+
 ///
 /// allocator class implementaion without libc function
 ///
+/// `allocate` returns uninitialized storage and `deallocate` frees it without
+/// running destructors. Construct and destroy elements with
+/// `allocator_traits<Alloc>::construct`/`destroy`(or the `uninitialized_*`
+/// algorithms below).
+///
+/// With NANOSTL_USE_MIMALLOC, memory comes from mi_malloc_aligned/mi_free
+/// instead of `malloc`/`free`.
+///
+/// With NANOSTL_ALLOC_PROFILE, each block has a small header which records its
+/// profiler site(see nanoalloc_profile.h).
+///
 template <typename T>
 class allocator {
  public:
@@ -56,11 +187,19 @@ class allocator {
   typedef T& reference;
   typedef const T& const_reference;
 
+  template <class U>
+  struct rebind {
+    typedef allocator<U> other;
+  };
+
   NANOSTL_HOST_AND_DEVICE_QUAL allocator() {}
 
+  template <class U>
+  NANOSTL_HOST_AND_DEVICE_QUAL allocator(const allocator<U>&) {}
+
   NANOSTL_HOST_AND_DEVICE_QUAL T* allocate(size_type n, const void* hint = 0) {
     (void)hint;  // Ignore `hint' for a while.
-    if (n < 1) {
+    if ((n < 1) || (n > max_size())) {
       return 0;
     }
 
@@ -72,15 +211,298 @@ class allocator {
 #endif
 #endif
 
-    return new T[n];
+#if defined(NANOSTL_ALLOC_PROFILE)
+    char* raw = static_cast<char*>(
+        __backend_allocate(n * sizeof(T) + __profile_header(), alignof(T)));
+    if (!raw) {
+      return 0;
+    }
+    *reinterpret_cast<unsigned*>(raw) =
+        __alloc_profile_allocate(__alloc_profile_type<T>::id(), n * sizeof(T));
+    return reinterpret_cast<T*>(raw + __profile_header());
+#else
+    return static_cast<T*>(__backend_allocate(n * sizeof(T), alignof(T)));
+#endif
   }
 
   NANOSTL_HOST_AND_DEVICE_QUAL void deallocate(T* p, size_type n) {
+    if (!p) {
+      return;
+    }
+#if defined(NANOSTL_ALLOC_PROFILE)
+    char* raw = reinterpret_cast<char*>(p) - __profile_header();
+    __alloc_profile_deallocate(*reinterpret_cast<unsigned*>(raw),
+                               n * sizeof(T));
+    __backend_deallocate(raw, alignof(T));
+#else
     (void)n;
-    delete[] p;
+    __backend_deallocate(p, alignof(T));
+#endif
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL size_type max_size() const {
+    return (~size_type(0) / 2) / sizeof(T);
+  }
+
+ private:
+  NANOSTL_HOST_AND_DEVICE_QUAL static void* __backend_allocate(size_type bytes,
+                                                               size_type align) {
+#if defined(NANOSTL_USE_MIMALLOC)
+    return mi_malloc_aligned(bytes, align);
+#else
+    return __raw_allocate(bytes, align);
+#endif
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL static void __backend_deallocate(
+      void* p, size_type align) {
+#if defined(NANOSTL_USE_MIMALLOC)
+    (void)align;
+    mi_free(p);
+#else
+    __raw_deallocate(p, align);
+#endif
+  }
+
+#if defined(NANOSTL_ALLOC_PROFILE)
+  // Size of the site header. Keeps the elements aligned.
+  NANOSTL_HOST_AND_DEVICE_QUAL static size_type __profile_header() {
+    return (alignof(T) > __kMallocAlign) ? alignof(T) : __kMallocAlign;
+  }
+#endif
+};
+
+// Stateless: any instance can free memory from any other.
+template <typename T, typename U>
+NANOSTL_HOST_AND_DEVICE_QUAL inline bool operator==(const allocator<T>&,
+                                                    const allocator<U>&) {
+  return true;
+}
+
+template <typename T, typename U>
+NANOSTL_HOST_AND_DEVICE_QUAL inline bool operator!=(const allocator<T>&,
+                                                    const allocator<U>&) {
+  return false;
+}
+
+// remove_reference/move/forward without nanotype_traits.h(which brings the
+// `nullptr` macro into every container header).
+template <class T>
+struct __alloc_remove_ref {
+  typedef T type;
+};
+template <class T>
+struct __alloc_remove_ref<T&> {
+  typedef T type;
+};
+template <class T>
+struct __alloc_remove_ref<T&&> {
+  typedef T type;
+};
+
+template <class T>
+NANOSTL_HOST_AND_DEVICE_QUAL inline typename __alloc_remove_ref<T>::type&&
+__alloc_move(T&& t) {
+  return static_cast<typename __alloc_remove_ref<T>::type&&>(t);
+}
+
+template <class T>
+NANOSTL_HOST_AND_DEVICE_QUAL inline T&& __alloc_forward(
+    typename __alloc_remove_ref<T>::type& t) {
+  return static_cast<T&&>(t);
+}
+
+///
+/// Uniform interface to allocators. `construct`/`destroy` call the member
+/// functions of the allocator when it has them, otherwise placement new and
+/// the destructor.
+///
+template <class Alloc>
+struct allocator_traits {
+  typedef Alloc allocator_type;
+  typedef typename Alloc::value_type value_type;
+  typedef value_type* pointer;
+  typedef const value_type* const_pointer;
+  typedef nanostl::size_type size_type;
+
+  template <class U>
+  using rebind_alloc = typename Alloc::template rebind<U>::other;
+
+  NANOSTL_HOST_AND_DEVICE_QUAL static pointer allocate(Alloc& a, size_type n) {
+    return a.allocate(n);
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL static void deallocate(Alloc& a, pointer p,
+                                                      size_type n) {
+    a.deallocate(p, n);
+  }
+
+  template <class T, class... Args>
+  NANOSTL_HOST_AND_DEVICE_QUAL static void construct(Alloc& a, T* p,
+                                                     Args&&... args) {
+    __construct(0, a, p, __alloc_forward<Args>(args)...);
+  }
+
+  template <class T>
+  NANOSTL_HOST_AND_DEVICE_QUAL static void destroy(Alloc& a, T* p) {
+    __destroy(0, a, p);
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL static size_type max_size(const Alloc& a) {
+    return __max_size(0, a);
   }
 
  private:
+  // `A`(== Alloc) is a template parameter so that a missing member is a
+  // substitution failure.
+  template <class A, class T, class... Args>
+  NANOSTL_HOST_AND_DEVICE_QUAL static auto __construct(int, A& a, T* p,
+                                                       Args&&... args)
+      -> decltype(a.construct(p, __alloc_forward<Args>(args)...), void()) {
+    a.construct(p, __alloc_forward<Args>(args)...);
+  }
+
+  template <class A, class T, class... Args>
+  NANOSTL_HOST_AND_DEVICE_QUAL static void __construct(long, A&, T* p,
+                                                       Args&&... args) {
+    new (static_cast<void*>(p), __placement_tag())
+        T(__alloc_forward<Args>(args)...);
+  }
+
+  template <class A, class T>
+  NANOSTL_HOST_AND_DEVICE_QUAL static auto __destroy(int, A& a, T* p)
+      -> decltype(a.destroy(p), void()) {
+    a.destroy(p);
+  }
+
+  template <class A, class T>
+  NANOSTL_HOST_AND_DEVICE_QUAL static void __destroy(long, A&, T* p) {
+    p->~T();
+  }
+
+  template <class A>
+  NANOSTL_HOST_AND_DEVICE_QUAL static auto __max_size(int, const A& a)
+      -> decltype(a.max_size()) {
+    return a.max_size();
+  }
+
+  template <class A>
+  NANOSTL_HOST_AND_DEVICE_QUAL static size_type __max_size(long, const A&) {
+    return (~size_type(0) / 2) / sizeof(value_type);
+  }
+};
+
+// Element type of an output iterator(or pointer).
+template <class ForwardIt>
+struct __uninit_value {
+  typedef typename __alloc_remove_ref<decltype(
+      **static_cast<ForwardIt*>(0))>::type type;
+};
+
+///
+/// Uninitialized memory algorithms. Elements are constructed in place in
+/// [d_first, ...). Exceptions thrown by constructors are not handled(already
+/// constructed elements are not destroyed).
+///
+template <class InputIt, class ForwardIt>
+NANOSTL_HOST_AND_DEVICE_QUAL inline ForwardIt uninitialized_copy(
+    InputIt first, InputIt last, ForwardIt d_first) {
+  typedef typename __uninit_value<ForwardIt>::type T;
+  for (; first != last; ++first, ++d_first) {
+    new (static_cast<void*>(&*d_first), __placement_tag()) T(*first);
+  }
+  return d_first;
+}
+
+template <class InputIt, class ForwardIt>
+NANOSTL_HOST_AND_DEVICE_QUAL inline ForwardIt uninitialized_move(
+    InputIt first, InputIt last, ForwardIt d_first) {
+  typedef typename __uninit_value<ForwardIt>::type T;
+  for (; first != last; ++first, ++d_first) {
+    new (static_cast<void*>(&*d_first), __placement_tag())
+        T(__alloc_move(*first));
+  }
+  return d_first;
+}
+
+template <class ForwardIt, class T>
+NANOSTL_HOST_AND_DEVICE_QUAL inline void uninitialized_fill(ForwardIt first,
+                                                            ForwardIt last,
+                                                            const T& value) {
+  typedef typename __uninit_value<ForwardIt>::type V;
+  for (; first != last; ++first) {
+    new (static_cast<void*>(&*first), __placement_tag()) V(value);
+  }
+}
+
+template <class T>
+NANOSTL_HOST_AND_DEVICE_QUAL inline void destroy_at(T* p) {
+  p->~T();
+}
+
+template <class ForwardIt>
+NANOSTL_HOST_AND_DEVICE_QUAL inline void destroy(ForwardIt first,
+                                                 ForwardIt last) {
+  for (; first != last; ++first) {
+    destroy_at(&*first);
+  }
+}
+
+///
+/// Heap statistics of the allocator backend. Only available with
+/// NANOSTL_USE_MIMALLOC(`available` is false otherwise).
+///
+struct allocator_stats {
+  bool available;
+  size_type current_rss;     // bytes
+  size_type peak_rss;        // bytes
+  size_type current_commit;  // bytes
+  size_type peak_commit;     // bytes
+  size_type page_faults;
+};
+
+inline allocator_stats get_allocator_stats() {
+  allocator_stats st;
+  st.available = false;
+  st.current_rss = st.peak_rss = 0;
+  st.current_commit = st.peak_commit = 0;
+  st.page_faults = 0;
+#if defined(NANOSTL_USE_MIMALLOC)
+  ::size_t elapsed, user, system, rss, peak_rss, commit, peak_commit, faults;
+  mi_process_info(&elapsed, &user, &system, &rss, &peak_rss, &commit,
+                  &peak_commit, &faults);
+  st.available = true;
+  st.current_rss = rss;
+  st.peak_rss = peak_rss;
+  st.current_commit = commit;
+  st.peak_commit = peak_commit;
+  st.page_faults = faults;
+#endif
+  return st;
+}
+
+///
+/// Prints the detailed heap statistics of mimalloc to its output(stderr by
+/// default). No-op without NANOSTL_USE_MIMALLOC.
+///
+inline void print_allocator_stats() {
+#if defined(NANOSTL_USE_MIMALLOC)
+  mi_stats_print_out(0, 0);
+#endif
+}
+
+///
+/// Base class of containers which holds their allocator. Stateless
+/// allocators(e.g. `allocator`) take no space(empty base).
+///
+template <typename Alloc>
+struct __allocator_holder : Alloc {
+  NANOSTL_HOST_AND_DEVICE_QUAL __allocator_holder() {}
+  NANOSTL_HOST_AND_DEVICE_QUAL explicit __allocator_holder(const Alloc& a)
+      : Alloc(a) {}
+
+  NANOSTL_HOST_AND_DEVICE_QUAL Alloc& __alloc() { return *this; }
+  NANOSTL_HOST_AND_DEVICE_QUAL const Alloc& __alloc() const { return *this; }
 };
 
 #ifdef __clang__
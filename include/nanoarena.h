@@ -0,0 +1,376 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 Light Transport Entertainment, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef NANOSTL_ARENA_H_
+#define NANOSTL_ARENA_H_
+
+#include "nanocommon.h"
+#include "nanoallocator.h"
+
+//
+// Monotonic(bump pointer) arena.
+//
+// `allocate()` hands out memory from the current block by bumping a pointer.
+// When the block is full a new one(2x larger, up to kMaxBlockSize) is
+// chained. `deallocate()` does nothing; memory is given back all at once by
+// `reset()` or `release()`, or when the arena is destroyed.
+//
+//   nanostl::monotonic_arena arena;
+//   {
+//     nanostl::vector<int, nanostl::arena_allocator<int> > v(arena);
+//     nanostl::basic_string<char, nanostl::arena_allocator<char> > s(
+//         "request scoped string which is longer than the SSO buffer", arena);
+//     ...
+//   }
+//   arena.reset();  // everything above is freed at once
+//
+// `arena_allocator<T>` is a stateful allocator(pointer to the arena) for
+// vector, basic_string and map. Like `allocator` it returns raw storage;
+// `deallocate` does not free it.
+//
+// Not thread-safe. Use one arena per thread(or per request).
+//
+
+namespace nanostl {
+
+class monotonic_arena {
+ public:
+  static const size_type kDefaultBlockSize = 4096;
+  static const size_type kMaxBlockSize = 64ull * 1024ull * 1024ull;
+
+  // Default alignment of `allocate()`.
+  static const size_type kAlign = 16;
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  explicit monotonic_arena(size_type initial_block_size = kDefaultBlockSize) {
+    __init(0, 0, initial_block_size);
+  }
+
+  ///
+  /// Allocates from `buffer` first. `buffer` is not owned by the arena and
+  /// must outlive it.
+  ///
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  monotonic_arena(void *buffer, size_type size) {
+    __init(static_cast<char *>(buffer), size, kDefaultBlockSize);
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  ~monotonic_arena() { __free_blocks(0); }
+
+  ///
+  /// Returns `bytes` of memory aligned to `align`(power of two), or NULL when
+  /// a new block can't be allocated.
+  ///
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  void *allocate(size_type bytes, size_type align = kAlign) {
+    const size_type pad = (0 - __addr(cur_)) & (align - 1);
+    const size_type left = size_type(end_ - cur_);
+    if ((cur_ == 0) || (bytes > left) || (pad + bytes > left)) {
+      return __allocate_slow(bytes, align);
+    }
+    char *p = cur_ + pad;
+    cur_ = p + bytes;
+    bytes_allocated_ += bytes;
+    allocation_count_++;
+    return p;
+  }
+
+  // No-op. Memory is freed by reset()/release().
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  void deallocate(void *p, size_type bytes) {
+    (void)p;
+    (void)bytes;
+  }
+
+  ///
+  /// Makes all memory available again. The largest block is kept(so a
+  /// repeated workload stops allocating blocks), the others are freed.
+  /// Everything allocated before is invalidated.
+  ///
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  void reset() {
+    __block *keep = 0;
+    for (__block *b = blocks_; b; b = b->next) {
+      if (!keep || (b->size > keep->size)) {
+        keep = b;
+      }
+    }
+    __free_blocks(keep);
+    if (keep) {
+      keep->next = 0;
+      blocks_ = keep;
+      block_count_ = 1;
+      bytes_reserved_ = keep->size;
+      cur_ = __data(keep);
+      end_ = reinterpret_cast<char *>(keep) + keep->size;
+    } else {
+      __rewind();
+    }
+    bytes_allocated_ = 0;
+    allocation_count_ = 0;
+  }
+
+  ///
+  /// Frees all blocks.
+  ///
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  void release() {
+    __free_blocks(0);
+    __rewind();
+    next_block_size_ = initial_block_size_;
+    bytes_allocated_ = 0;
+    allocation_count_ = 0;
+  }
+
+  // Bytes requested by allocate() since the last reset()/release().
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  size_type bytes_allocated() const { return bytes_allocated_; }
+
+  // Largest bytes_allocated() seen.
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  size_type peak_bytes_allocated() const {
+    return (bytes_allocated_ > peak_bytes_) ? bytes_allocated_ : peak_bytes_;
+  }
+
+  // Bytes of blocks owned by the arena(not counting the initial buffer).
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  size_type bytes_reserved() const { return bytes_reserved_; }
+
+  // Number of blocks owned by the arena.
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  size_type block_count() const { return block_count_; }
+
+  // Number of allocate() calls since the last reset()/release().
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  size_type allocation_count() const { return allocation_count_; }
+
+ private:
+  monotonic_arena(const monotonic_arena &);
+  monotonic_arena &operator=(const monotonic_arena &);
+
+  // Block header. Data follows(kAlign aligned).
+  struct __block {
+    __block *next;
+    size_type size;  // including the header
+  };
+
+  // Blocks are allocated in units of kAlign bytes.
+  struct __unit {
+    unsigned long long w[2];
+  };
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  static size_type __addr(const void *p) {
+    return reinterpret_cast<size_type>(p);
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  static char *__data(__block *b) {
+    return reinterpret_cast<char *>(b) + sizeof(__unit);
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  void __init(char *buffer, size_type size, size_type initial_block_size) {
+    buffer_ = buffer;
+    buffer_size_ = size;
+    blocks_ = 0;
+    initial_block_size_ = next_block_size_ =
+        (initial_block_size < 2 * sizeof(__unit)) ? 2 * sizeof(__unit)
+                                                  : initial_block_size;
+    bytes_allocated_ = 0;
+    peak_bytes_ = 0;
+    bytes_reserved_ = 0;
+    block_count_ = 0;
+    allocation_count_ = 0;
+    __rewind();
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  void __rewind() {
+    if (bytes_allocated_ > peak_bytes_) {
+      peak_bytes_ = bytes_allocated_;
+    }
+    cur_ = buffer_;
+    end_ = buffer_ ? buffer_ + buffer_size_ : 0;
+  }
+
+  // Frees every block except `keep`.
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  void __free_blocks(__block *keep) {
+    if (bytes_allocated_ > peak_bytes_) {
+      peak_bytes_ = bytes_allocated_;
+    }
+    allocator<__unit> alloc;
+    __block *b = blocks_;
+    while (b) {
+      __block *next = b->next;
+      if (b != keep) {
+        alloc.deallocate(reinterpret_cast<__unit *>(b),
+                         b->size / sizeof(__unit));
+      }
+      b = next;
+    }
+    blocks_ = 0;
+    block_count_ = 0;
+    bytes_reserved_ = 0;
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  __block *__new_block(size_type size) {
+    allocator<__unit> alloc;
+    const size_type units = (size + sizeof(__unit) - 1) / sizeof(__unit);
+    __block *b = reinterpret_cast<__block *>(alloc.allocate(units));
+    if (!b) {
+      return 0;
+    }
+    b->size = units * sizeof(__unit);
+    block_count_++;
+    bytes_reserved_ += b->size;
+    return b;
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  void *__allocate_slow(size_type bytes, size_type align) {
+    if (bytes > ~size_type(0) / 2) {
+      return 0;  // `need` would overflow
+    }
+    const size_type need = sizeof(__unit) + bytes + (align - 1);
+
+    __block *b;
+    const bool oversized = need > next_block_size_;
+    if (oversized) {
+      // A block of its own, linked behind the head so that the rest of the
+      // current block(or buffer) stays in use.
+      b = __new_block(need);
+      if (!b) {
+        return 0;
+      }
+      if (blocks_) {
+        b->next = blocks_->next;
+        blocks_->next = b;
+      } else {
+        b->next = 0;
+        blocks_ = b;
+      }
+    } else {
+      b = __new_block(next_block_size_);
+      if (!b) {
+        return 0;
+      }
+      b->next = blocks_;
+      blocks_ = b;
+      end_ = reinterpret_cast<char *>(b) + b->size;
+      if (next_block_size_ < kMaxBlockSize) {
+        next_block_size_ *= 2;
+      }
+    }
+
+    char *p = __data(b);
+    p += (0 - __addr(p)) & (align - 1);
+    if (!oversized) {
+      cur_ = p + bytes;
+    }
+    bytes_allocated_ += bytes;
+    allocation_count_++;
+    return p;
+  }
+
+  char *cur_;
+  char *end_;
+  __block *blocks_;  // most recent first
+  char *buffer_;     // optional initial buffer(not owned)
+  size_type buffer_size_;
+  size_type initial_block_size_;
+  size_type next_block_size_;
+
+  size_type bytes_allocated_;
+  size_type peak_bytes_;
+  size_type bytes_reserved_;
+  size_type block_count_;
+  size_type allocation_count_;
+};
+
+///
+/// Allocator which allocates from a `monotonic_arena`. `deallocate` is a
+/// no-op.
+///
+template <typename T>
+class arena_allocator {
+ public:
+  typedef T value_type;
+  typedef T *pointer;
+  typedef const T *const_pointer;
+  typedef T &reference;
+  typedef const T &const_reference;
+
+  template <class U>
+  struct rebind {
+    typedef arena_allocator<U> other;
+  };
+
+  // Implicit, so that `vector<int, arena_allocator<int> > v(arena)` works.
+  NANOSTL_HOST_AND_DEVICE_QUAL arena_allocator(monotonic_arena &arena)
+      : arena_(&arena) {}
+
+  template <class U>
+  NANOSTL_HOST_AND_DEVICE_QUAL arena_allocator(const arena_allocator<U> &rhs)
+      : arena_(rhs.arena()) {}
+
+  NANOSTL_HOST_AND_DEVICE_QUAL T *allocate(size_type n, const void *hint = 0) {
+    (void)hint;
+    if (n < 1) {
+      return 0;
+    }
+    return static_cast<T *>(arena_->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL void deallocate(T *p, size_type n) {
+    arena_->deallocate(p, n * sizeof(T));
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL monotonic_arena *arena() const {
+    return arena_;
+  }
+
+ private:
+  monotonic_arena *arena_;
+};
+
+template <typename T, typename U>
+NANOSTL_HOST_AND_DEVICE_QUAL inline bool operator==(
+    const arena_allocator<T> &a, const arena_allocator<U> &b) {
+  return a.arena() == b.arena();
+}
+
+template <typename T, typename U>
+NANOSTL_HOST_AND_DEVICE_QUAL inline bool operator!=(
+    const arena_allocator<T> &a, const arena_allocator<U> &b) {
+  return a.arena() != b.arena();
+}
+
+}  // namespace nanostl
+
+#endif  // NANOSTL_ARENA_H_
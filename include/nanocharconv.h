@@ -0,0 +1,519 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 Light Transport Entertainment, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef NANOSTL_CHARCONV_H_
+#define NANOSTL_CHARCONV_H_
+
+#include "nanocommon.h"
+#include "nanocstdint.h"
+#include "nanosystem_error.h"
+
+//
+// Subset of <charconv>.
+//
+// `to_chars` for integers: no allocation, no locale, output is not
+// '\0' terminated. Base 10 writes two digits per step from a 200 byte
+// table and sizes the output up front from the bit length, so digits are
+// written in place(no reverse pass). 64bit values are split into 8 digit
+// chunks so that most divisions are 32bit.
+//
+// On success `ptr` points one past the last written char and `ec` is
+// `errc()`. If the output does not fit, returns `{last, errc::value_too_large}`
+// and the contents of `[first, last)` are unspecified.
+//
+// `from_chars` follows std: no leading whitespace or '+', '-' only for signed
+// types, no base prefix. If no number is found, returns
+// `{first, errc::invalid_argument}`. If the number does not fit, `ptr` points
+// past it, `ec` is `errc::result_out_of_range` and `value` is not modified.
+// Base 10 integers take 8 digits per step(SWAR) while no overflow is
+// possible.
+//
+// `from_chars` for float/double uses the vendored fast_float(exact, round to
+// nearest even) and is implemented in src/nanocharconv.cc.
+// `chars_format::hex` is not supported(returns errc::invalid_argument).
+//
+// `to_chars` for float/double with `chars_format` and precision is the
+// equivalent of printf "%.*f"(fixed), "%.*e"(scientific) and "%.*g"(general):
+// exact(round half to even on the binary value), no allocation, no locale.
+// Digits are generated from a stack bignum instead of ryu's d2fixed tables.
+// A negative precision means 6 and inf/nan are written as "inf"/"nan". Also
+// implemented in src/nanocharconv.cc.
+//
+
+namespace nanostl {
+
+struct to_chars_result {
+  char *ptr;
+  errc ec;
+};
+
+struct from_chars_result {
+  const char *ptr;
+  errc ec;
+};
+
+enum class chars_format {
+  scientific = 1 << 0,
+  fixed = 1 << 2,
+  hex = 1 << 3,
+  general = fixed | scientific
+};
+
+namespace __charconv {
+
+static const char kDigits2[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static const char kDigitChars[37] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+static const uint64_t kPow10[20] = {1ull,
+                                    10ull,
+                                    100ull,
+                                    1000ull,
+                                    10000ull,
+                                    100000ull,
+                                    1000000ull,
+                                    10000000ull,
+                                    100000000ull,
+                                    1000000000ull,
+                                    10000000000ull,
+                                    100000000000ull,
+                                    1000000000000ull,
+                                    10000000000000ull,
+                                    100000000000000ull,
+                                    1000000000000000ull,
+                                    10000000000000000ull,
+                                    100000000000000000ull,
+                                    1000000000000000000ull,
+                                    10000000000000000000ull};
+
+// Number of significant bits(1 for 0).
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline unsigned bit_width(uint64_t v) {
+  v |= 1;
+#if defined(__CUDA_ARCH__)
+  return 64 - unsigned(__clzll((long long)v));
+#elif defined(__GNUC__) || defined(__clang__)
+  return 64 - unsigned(__builtin_clzll(v));
+#else
+  unsigned n = 0;
+  while (v) {
+    v >>= 1;
+    n++;
+  }
+  return n;
+#endif
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline unsigned count_digits10(uint64_t v) {
+  if (v < 10) {
+    return 1;
+  }
+  // floor(log10(2^bits)) ~= bits * 1233 / 4096. Off by at most one.
+  const unsigned t = (bit_width(v) * 1233) >> 12;
+  return t + 1 - ((v < kPow10[t]) ? 1 : 0);
+}
+
+// Writes `v` backwards ending at `end`.
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline void write10_u32(char *end, uint32_t v) {
+  while (v >= 10000) {
+    const uint32_t q = v / 10000;
+    const uint32_t r = v - q * 10000;
+    const uint32_t hi = (r / 100) * 2;
+    const uint32_t lo = (r % 100) * 2;
+    v = q;
+    end -= 4;
+    end[0] = kDigits2[hi];
+    end[1] = kDigits2[hi + 1];
+    end[2] = kDigits2[lo];
+    end[3] = kDigits2[lo + 1];
+  }
+  while (v >= 100) {
+    const uint32_t i = (v % 100) * 2;
+    v /= 100;
+    *--end = kDigits2[i + 1];
+    *--end = kDigits2[i];
+  }
+  if (v >= 10) {
+    *--end = kDigits2[v * 2 + 1];
+    *--end = kDigits2[v * 2];
+  } else {
+    *--end = char('0' + v);
+  }
+}
+
+// Exactly 8 digits(with leading zeros) ending at `end`.
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline void write10_8digits(char *end, uint32_t v) {
+  const uint32_t a = v / 10000;
+  const uint32_t b = v - a * 10000;
+  const uint32_t i0 = (a / 100) * 2;
+  const uint32_t i1 = (a % 100) * 2;
+  const uint32_t i2 = (b / 100) * 2;
+  const uint32_t i3 = (b % 100) * 2;
+  end -= 8;
+  end[0] = kDigits2[i0];
+  end[1] = kDigits2[i0 + 1];
+  end[2] = kDigits2[i1];
+  end[3] = kDigits2[i1 + 1];
+  end[4] = kDigits2[i2];
+  end[5] = kDigits2[i2 + 1];
+  end[6] = kDigits2[i3];
+  end[7] = kDigits2[i3 + 1];
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline void write10_u64(char *end, uint64_t v) {
+  while (v > 0xffffffffull) {
+    write10_8digits(end, uint32_t(v % 100000000ull));
+    v /= 100000000ull;
+    end -= 8;
+  }
+  write10_u32(end, uint32_t(v));
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline to_chars_result to_chars_u64(char *first, char *last, uint64_t v,
+                                    int base) {
+  if ((base < 2) || (base > 36)) {
+    to_chars_result r = {last, errc::invalid_argument};
+    return r;
+  }
+
+  const long long avail = last - first;
+
+  if (base == 10) {
+    const unsigned n = count_digits10(v);
+    if (avail < (long long)n) {
+      to_chars_result r = {last, errc::value_too_large};
+      return r;
+    }
+    if (v <= 0xffffffffull) {
+      write10_u32(first + n, uint32_t(v));
+    } else {
+      write10_u64(first + n, v);
+    }
+    to_chars_result r = {first + n, errc()};
+    return r;
+  }
+
+  unsigned n = 0;
+  if ((base & (base - 1)) == 0) {
+    // 2, 4, 8, 16, 32
+    const unsigned shift = bit_width(uint64_t(base)) - 1;
+    n = (bit_width(v) + shift - 1) / shift;
+    if (avail < (long long)n) {
+      to_chars_result r = {last, errc::value_too_large};
+      return r;
+    }
+    const uint64_t mask = uint64_t(base - 1);
+    char *p = first + n;
+    do {
+      *--p = kDigitChars[v & mask];
+      v >>= shift;
+    } while (v);
+  } else {
+    uint64_t t = v;
+    do {
+      t /= uint64_t(base);
+      n++;
+    } while (t);
+    if (avail < (long long)n) {
+      to_chars_result r = {last, errc::value_too_large};
+      return r;
+    }
+    char *p = first + n;
+    do {
+      *--p = kDigitChars[v % uint64_t(base)];
+      v /= uint64_t(base);
+    } while (v);
+  }
+
+  to_chars_result r = {first + n, errc()};
+  return r;
+}
+
+template <class T>
+NANOSTL_HOST_AND_DEVICE_QUAL inline to_chars_result to_chars_signed(
+    char *first, char *last, T value, int base) {
+  uint64_t u = uint64_t(value);
+  if (value < 0) {
+    if (first == last) {
+      to_chars_result r = {last, errc::value_too_large};
+      return r;
+    }
+    *first++ = '-';
+    // Well defined for the minimum value too.
+    u = 0 - u;
+  }
+  return to_chars_u64(first, last, u, base);
+}
+
+// 0-35 for [0-9a-zA-Z], larger otherwise.
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline unsigned digit_value(char c) {
+  const unsigned d = unsigned((unsigned char)c) - unsigned('0');
+  if (d < 10) {
+    return d;
+  }
+  const unsigned l = unsigned((unsigned char)c | 0x20) - unsigned('a');
+  return (l < 26) ? (l + 10) : 99;
+}
+
+#if !defined(NANOSTL_BIG_ENDIAN)
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline uint64_t load8(const char *p) {
+  uint64_t v = 0;
+  for (int i = 0; i < 8; i++) {
+    v |= uint64_t((unsigned char)p[i]) << (8 * i);
+  }
+  return v;
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline bool is_eight_digits(uint64_t v) {
+  return (((v & 0xF0F0F0F0F0F0F0F0ull) |
+           (((v + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4)) ==
+          0x3333333333333333ull);
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline uint32_t parse_eight_digits(uint64_t v) {
+  v = ((v & 0x0F0F0F0F0F0F0F0Full) * 2561) >> 8;
+  v = ((v & 0x00FF00FF00FF00FFull) * 6553601) >> 16;
+  return uint32_t(((v & 0x0000FFFF0000FFFFull) * 42949672960001ull) >> 32);
+}
+#endif
+
+// Parses digits in `[p, last)`. Returns the end of the digits(`p` if none).
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline const char *parse_u64(const char *p, const char *last, int base,
+                             uint64_t *out, bool *overflow) {
+  uint64_t v = 0;
+  (*overflow) = false;
+
+  if (base == 10) {
+#if !defined(NANOSTL_BIG_ENDIAN)
+    // 16 digits never overflow.
+    for (int k = 0; (k < 2) && (last - p >= 8); k++) {
+      const uint64_t w = load8(p);
+      if (!is_eight_digits(w)) {
+        break;
+      }
+      v = v * 100000000ull + parse_eight_digits(w);
+      p += 8;
+    }
+#endif
+  }
+
+  const uint64_t cutoff = ~uint64_t(0) / uint64_t(base);
+  const unsigned cutlim = unsigned(~uint64_t(0) % uint64_t(base));
+  for (; p != last; p++) {
+    const unsigned d = digit_value(*p);
+    if (d >= unsigned(base)) {
+      break;
+    }
+    if ((v > cutoff) || ((v == cutoff) && (d > cutlim))) {
+      (*overflow) = true;
+    } else {
+      v = v * uint64_t(base) + d;
+    }
+  }
+
+  (*out) = v;
+  return p;
+}
+
+template <class T>
+NANOSTL_HOST_AND_DEVICE_QUAL inline from_chars_result from_chars_unsigned(
+    const char *first, const char *last, T &value, int base) {
+  from_chars_result r = {first, errc::invalid_argument};
+  if ((base < 2) || (base > 36)) {
+    return r;
+  }
+  uint64_t v;
+  bool overflow;
+  const char *e = parse_u64(first, last, base, &v, &overflow);
+  if (e == first) {
+    return r;
+  }
+  r.ptr = e;
+  if (overflow || (v > uint64_t(T(~T(0))))) {
+    r.ec = errc::result_out_of_range;
+    return r;
+  }
+  value = T(v);
+  r.ec = errc();
+  return r;
+}
+
+template <class T>
+NANOSTL_HOST_AND_DEVICE_QUAL inline from_chars_result from_chars_signed(
+    const char *first, const char *last, T &value, int base) {
+  from_chars_result r = {first, errc::invalid_argument};
+  if ((base < 2) || (base > 36)) {
+    return r;
+  }
+  const char *p = first;
+  const bool neg = (p != last) && (*p == '-');
+  if (neg) {
+    p++;
+  }
+  uint64_t v;
+  bool overflow;
+  const char *e = parse_u64(p, last, base, &v, &overflow);
+  if (e == p) {
+    return r;
+  }
+  r.ptr = e;
+  const uint64_t max_value = (1ull << (sizeof(T) * 8 - 1)) - 1;
+  if (overflow || (v > max_value + (neg ? 1 : 0))) {
+    r.ec = errc::result_out_of_range;
+    return r;
+  }
+  if (neg) {
+    // Avoid overflow for the minimum value.
+    value = (v == 0) ? T(0) : T(-(long long)(v - 1) - 1);
+  } else {
+    value = T(v);
+  }
+  r.ec = errc();
+  return r;
+}
+
+}  // namespace __charconv
+
+#define NANOSTL_TO_CHARS_SIGNED(T)                                       \
+  NANOSTL_HOST_AND_DEVICE_QUAL                                           \
+  inline to_chars_result to_chars(char *first, char *last, T value,      \
+                                  int base = 10) {                       \
+    return __charconv::to_chars_signed(first, last, value, base);       \
+  }
+
+#define NANOSTL_TO_CHARS_UNSIGNED(T)                                      \
+  NANOSTL_HOST_AND_DEVICE_QUAL                                            \
+  inline to_chars_result to_chars(char *first, char *last, T value,       \
+                                  int base = 10) {                        \
+    return __charconv::to_chars_u64(first, last, uint64_t(value), base); \
+  }
+
+NANOSTL_TO_CHARS_SIGNED(signed char)
+NANOSTL_TO_CHARS_SIGNED(short)
+NANOSTL_TO_CHARS_SIGNED(int)
+NANOSTL_TO_CHARS_SIGNED(long)
+NANOSTL_TO_CHARS_SIGNED(long long)
+
+NANOSTL_TO_CHARS_UNSIGNED(unsigned char)
+NANOSTL_TO_CHARS_UNSIGNED(unsigned short)
+NANOSTL_TO_CHARS_UNSIGNED(unsigned int)
+NANOSTL_TO_CHARS_UNSIGNED(unsigned long)
+NANOSTL_TO_CHARS_UNSIGNED(unsigned long long)
+
+// `char` is distinct from `signed char` and `unsigned char`.
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline to_chars_result to_chars(char *first, char *last, char value,
+                                int base = 10) {
+  if (char(-1) < char(0)) {
+    return __charconv::to_chars_signed(first, last, (signed char)value, base);
+  }
+  return __charconv::to_chars_u64(first, last, uint64_t((unsigned char)value),
+                                  base);
+}
+
+// Not allowed, as in std.
+to_chars_result to_chars(char *first, char *last, bool value,
+                         int base = 10) = delete;
+
+#undef NANOSTL_TO_CHARS_SIGNED
+#undef NANOSTL_TO_CHARS_UNSIGNED
+
+#define NANOSTL_FROM_CHARS_INT(T, KIND)                                     \
+  NANOSTL_HOST_AND_DEVICE_QUAL                                              \
+  inline from_chars_result from_chars(const char *first, const char *last,  \
+                                      T &value, int base = 10) {            \
+    return __charconv::from_chars_##KIND(first, last, value, base);         \
+  }
+
+NANOSTL_FROM_CHARS_INT(signed char, signed)
+NANOSTL_FROM_CHARS_INT(short, signed)
+NANOSTL_FROM_CHARS_INT(int, signed)
+NANOSTL_FROM_CHARS_INT(long, signed)
+NANOSTL_FROM_CHARS_INT(long long, signed)
+
+NANOSTL_FROM_CHARS_INT(unsigned char, unsigned)
+NANOSTL_FROM_CHARS_INT(unsigned short, unsigned)
+NANOSTL_FROM_CHARS_INT(unsigned int, unsigned)
+NANOSTL_FROM_CHARS_INT(unsigned long, unsigned)
+NANOSTL_FROM_CHARS_INT(unsigned long long, unsigned)
+
+#undef NANOSTL_FROM_CHARS_INT
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline from_chars_result from_chars(const char *first, const char *last,
+                                    char &value, int base = 10) {
+  if (char(-1) < char(0)) {
+    signed char v;
+    from_chars_result r = __charconv::from_chars_signed(first, last, v, base);
+    if (r.ec == errc()) {
+      value = char(v);
+    }
+    return r;
+  }
+  unsigned char v;
+  from_chars_result r = __charconv::from_chars_unsigned(first, last, v, base);
+  if (r.ec == errc()) {
+    value = char(v);
+  }
+  return r;
+}
+
+// fixed/scientific/general with precision. See above.
+to_chars_result to_chars(char *first, char *last, float value,
+                         chars_format fmt, int precision);
+
+to_chars_result to_chars(char *first, char *last, double value,
+                         chars_format fmt, int precision);
+
+from_chars_result from_chars(const char *first, const char *last,
+                             float &value,
+                             chars_format fmt = chars_format::general);
+
+from_chars_result from_chars(const char *first, const char *last,
+                             double &value,
+                             chars_format fmt = chars_format::general);
+
+}  // namespace nanostl
+
+#endif  // NANOSTL_CHARCONV_H_
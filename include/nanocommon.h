@@ -48,6 +48,39 @@
 #endif
 
 
+// C++ language version. MSVC keeps `__cplusplus` at 199711L unless
+// `/Zc:__cplusplus` is given, so prefer `_MSVC_LANG` there.
+#if defined(_MSVC_LANG)
+#define NANOSTL_CPLUSPLUS _MSVC_LANG
+#else
+#define NANOSTL_CPLUSPLUS __cplusplus
+#endif
+
+// `constexpr` for functions which need C++14 relaxed constexpr(loops etc).
+#if NANOSTL_CPLUSPLUS >= 201402L
+#define NANOSTL_CONSTEXPR14 constexpr
+#else
+#define NANOSTL_CONSTEXPR14
+#endif
+
+// Cache prefetch hint(read).
+#if defined(__CUDACC__)
+#define NANOSTL_PREFETCH(addr) ((void)(addr))
+#elif defined(__GNUC__) || defined(__clang__)
+#define NANOSTL_PREFETCH(addr) __builtin_prefetch((addr), 0, 3)
+#else
+#define NANOSTL_PREFETCH(addr) ((void)(addr))
+#endif
+
+// For functions which read whole aligned blocks past the end of a string
+// (never crossing a page boundary). Those reads are fine for the hardware but
+// not for AddressSanitizer.
+#if defined(__clang__) || (defined(__GNUC__) && !defined(__CUDACC__))
+#define NANOSTL_NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#else
+#define NANOSTL_NO_SANITIZE_ADDRESS
+#endif
+
 // TODO(LTE): Implement
 #ifndef _NANOSTL_TEMPLATE_VIS
 #define _NANOSTL_TEMPLATE_VIS
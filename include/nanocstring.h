@@ -26,23 +26,1063 @@
 #define NANOSTL_CSTRING_H_
 
 #include "nanocommon.h"
+#include "nanocstdint.h"
+#include "__nanostrsearch.h"
+
+//
+// memcpy, memmove and memset dispatch on size:
+//
+//   n <= 16      : two overlapping 1/4/8 byte loads and stores
+//   n <= 128     : 2, 4 or 8 overlapping 16 byte chunks
+//   larger       : 64 bytes per iteration with aligned stores(32 byte AVX2
+//                  registers when available). The first and last 32 bytes
+//                  are loaded upfront and stored unaligned.
+//
+// Up to 128 bytes every load happens before the first store, so the small
+// paths are also correct for overlapping regions. Larger `memmove` copies
+// backward when `dest` is inside the source.
+//
+// Chunks are SSE2/NEON registers, or two 64bit words without SIMD(and in
+// CUDA device code).
+//
+// Copies and fills of at least NANOSTL_STREAM_THRESHOLD bytes(8 MB by
+// default, #define it before including to change) use non-temporal stores so
+// they don't flush the last level cache. `memcpy_stream` and `memset_stream`
+// always do(for buffers which won't be read again soon).
+//
+// strlen/strnlen, strchr, strrchr and strcmp/strncmp scan NUL terminated
+// strings in SIMD blocks(8 byte words without SIMD). Blocks are read from
+// aligned addresses, or checked not to cross a page end, so they never fault
+// past the terminator. memcmp, memchr, strstr and strspn/strcspn use the length
+// aware search routines in __nanostrsearch.h.
+//
+
+#if !defined(NANOSTL_STREAM_THRESHOLD)
+#define NANOSTL_STREAM_THRESHOLD (8ull * 1024ull * 1024ull)
+#endif
+
+#if defined(NANOSTL_STRSEARCH_AVX2) || defined(NANOSTL_STRSEARCH_SSE2)
+#define NANOSTL_CSTRING_SSE2
+#elif defined(NANOSTL_STRSEARCH_NEON)
+#define NANOSTL_CSTRING_NEON
+#endif
 
 namespace nanostl {
 
-// Naiive implementation of memcpy
+namespace __cstring {
+
+typedef unsigned char byte;
+
+//
+// Unaligned 4/8 byte loads and stores.
+//
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline uint32_t load32(const byte *p) {
+#if defined(__GNUC__) || defined(__clang__)
+  uint32_t v;
+  __builtin_memcpy(&v, p, 4);
+  return v;
+#else
+  uint32_t v = 0;
+  for (int i = 0; i < 4; i++) {
+    v |= uint32_t(p[i]) << (8 * i);
+  }
+  return v;
+#endif
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline void store32(byte *p, uint32_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_memcpy(p, &v, 4);
+#else
+  for (int i = 0; i < 4; i++) {
+    p[i] = byte(v >> (8 * i));
+  }
+#endif
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline uint64_t load64(const byte *p) {
+#if defined(__GNUC__) || defined(__clang__)
+  uint64_t v;
+  __builtin_memcpy(&v, p, 8);
+  return v;
+#else
+  uint64_t v = 0;
+  for (int i = 0; i < 8; i++) {
+    v |= uint64_t(p[i]) << (8 * i);
+  }
+  return v;
+#endif
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline void store64(byte *p, uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_memcpy(p, &v, 8);
+#else
+  for (int i = 0; i < 8; i++) {
+    p[i] = byte(v >> (8 * i));
+  }
+#endif
+}
+
+//
+// 16 byte chunk. `store16a` requires a 16 byte aligned address.
+//
+#if defined(NANOSTL_CSTRING_SSE2)
+
+typedef __m128i chunk;
+
+inline chunk load16(const byte *p) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+inline void store16(byte *p, chunk v) {
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v);
+}
+inline void store16a(byte *p, chunk v) {
+  _mm_store_si128(reinterpret_cast<__m128i *>(p), v);
+}
+inline chunk splat16(byte c) { return _mm_set1_epi8(char(c)); }
+
+#elif defined(NANOSTL_CSTRING_NEON)
+
+typedef uint8x16_t chunk;
+
+inline chunk load16(const byte *p) { return vld1q_u8(p); }
+inline void store16(byte *p, chunk v) { vst1q_u8(p, v); }
+inline void store16a(byte *p, chunk v) { vst1q_u8(p, v); }
+inline chunk splat16(byte c) { return vdupq_n_u8(c); }
+
+#else
+
+struct chunk {
+  uint64_t lo;
+  uint64_t hi;
+};
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline chunk load16(const byte *p) {
+  chunk v;
+  v.lo = load64(p);
+  v.hi = load64(p + 8);
+  return v;
+}
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline void store16(byte *p, chunk v) {
+  store64(p, v.lo);
+  store64(p + 8, v.hi);
+}
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline void store16a(byte *p, chunk v) { store16(p, v); }
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline chunk splat16(byte c) {
+  chunk v;
+  v.lo = v.hi = uint64_t(c) * 0x0101010101010101ull;
+  return v;
+}
+
+#endif
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline unsigned long long addr(const void *p) {
+  return reinterpret_cast<unsigned long long>(p);
+}
+
+//
+// Inlined into a caller with a small array and a length it can't bound, GCC
+// checks the loads and stores of size classes which are never reached for
+// that array and warns(-Warray-bounds, -Wstringop-overread/-overflow).
+// `opaque` hides the object behind an empty asm(no instruction). A constant
+// length compiles only its own size class and doesn't need it, so bit casts
+// through memcpy stay in registers.
+//
+template <class P>
+NANOSTL_HOST_AND_DEVICE_QUAL inline P *opaque(P *p) {
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(__CUDA_ARCH__)
+  __asm__("" : "+r"(p));
+#endif
+  return p;
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline bool is_constant(unsigned long long n) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_constant_p(n);
+#else
+  (void)n;
+  return false;
+#endif
+}
+
+// n <= 16. Overlap safe.
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline void copy_le16(byte *d, const byte *s, unsigned long long n) {
+  if (n >= 8) {
+    const uint64_t a = load64(s);
+    const uint64_t b = load64(s + n - 8);
+    store64(d, a);
+    store64(d + n - 8, b);
+  } else if (n >= 4) {
+    const uint32_t a = load32(s);
+    const uint32_t b = load32(s + n - 4);
+    store32(d, a);
+    store32(d + n - 4, b);
+  } else if (n) {
+    const byte a = s[0];
+    const byte b = s[n >> 1];
+    const byte c = s[n - 1];
+    d[0] = a;
+    d[n >> 1] = b;
+    d[n - 1] = c;
+  }
+}
+
+// 16 < n <= 128. Overlap safe.
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline void copy_le128(byte *d, const byte *s, unsigned long long n) {
+  if (n <= 32) {
+    const chunk a = load16(s);
+    const chunk b = load16(s + n - 16);
+    store16(d, a);
+    store16(d + n - 16, b);
+  } else if (n <= 64) {
+    const chunk a = load16(s);
+    const chunk b = load16(s + 16);
+    const chunk c = load16(s + n - 32);
+    const chunk e = load16(s + n - 16);
+    store16(d, a);
+    store16(d + 16, b);
+    store16(d + n - 32, c);
+    store16(d + n - 16, e);
+  } else {
+    const chunk a0 = load16(s);
+    const chunk a1 = load16(s + 16);
+    const chunk a2 = load16(s + 32);
+    const chunk a3 = load16(s + 48);
+    const chunk b0 = load16(s + n - 64);
+    const chunk b1 = load16(s + n - 48);
+    const chunk b2 = load16(s + n - 32);
+    const chunk b3 = load16(s + n - 16);
+    store16(d, a0);
+    store16(d + 16, a1);
+    store16(d + 32, a2);
+    store16(d + 48, a3);
+    store16(d + n - 64, b0);
+    store16(d + n - 48, b1);
+    store16(d + n - 32, b2);
+    store16(d + n - 16, b3);
+  }
+}
+
+// Main loops: 64 bytes per iteration with stores aligned to `kAlign`.
+#if defined(NANOSTL_STRSEARCH_AVX2)
+static const unsigned long long kAlign = 32;
+
+inline void copy64a(byte *d, const byte *s) {
+  const __m256i a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s));
+  const __m256i a1 =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + 32));
+  _mm256_store_si256(reinterpret_cast<__m256i *>(d), a0);
+  _mm256_store_si256(reinterpret_cast<__m256i *>(d + 32), a1);
+}
+
+inline void fill64a(byte *d, chunk v) {
+  const __m256i w = _mm256_broadcastsi128_si256(v);
+  _mm256_store_si256(reinterpret_cast<__m256i *>(d), w);
+  _mm256_store_si256(reinterpret_cast<__m256i *>(d + 32), w);
+}
+#else
+static const unsigned long long kAlign = 16;
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline void copy64a(byte *d, const byte *s) {
+  const chunk a0 = load16(s);
+  const chunk a1 = load16(s + 16);
+  const chunk a2 = load16(s + 32);
+  const chunk a3 = load16(s + 48);
+  store16a(d, a0);
+  store16a(d + 16, a1);
+  store16a(d + 32, a2);
+  store16a(d + 48, a3);
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline void fill64a(byte *d, chunk v) {
+  store16a(d, v);
+  store16a(d + 16, v);
+  store16a(d + 32, v);
+  store16a(d + 48, v);
+}
+#endif
+
+// n > 128. Correct for `d` < `s` overlap.
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline void copy_forward(byte *d, const byte *s, unsigned long long n) {
+  const chunk head0 = load16(s);
+  const chunk head1 = load16(s + 16);
+  const chunk tail0 = load16(s + n - 32);
+  const chunk tail1 = load16(s + n - 16);
+
+  // Align `d`. `head` covers the skipped bytes, `tail` the last 32.
+  const unsigned long long skip = kAlign - (addr(d) & (kAlign - 1));
+  byte *p = d + skip;
+  const byte *q = s + skip;
+  byte *const end = d + n - 32;
+  for (; p + 64 <= end; p += 64, q += 64) {
+    copy64a(p, q);
+  }
+  for (; p < end; p += 16, q += 16) {
+    store16a(p, load16(q));
+  }
+
+  store16(d, head0);
+  store16(d + 16, head1);
+  store16(end, tail0);
+  store16(end + 16, tail1);
+}
+
+// n > 128. Correct for `d` > `s` overlap.
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline void copy_backward(byte *d, const byte *s, unsigned long long n) {
+  const chunk head0 = load16(s);
+  const chunk head1 = load16(s + 16);
+  const chunk tail0 = load16(s + n - 32);
+  const chunk tail1 = load16(s + n - 16);
+
+  // Aligned end. `tail` covers the bytes after it, `head` the first 32.
+  byte *p = d + n - (addr(d + n) & (kAlign - 1));
+  const byte *q = s + (p - d);
+  byte *const begin = d + 32;
+  for (; p >= begin + 64; p -= 64, q -= 64) {
+    copy64a(p - 64, q - 64);
+  }
+  for (; p > begin; p -= 16, q -= 16) {
+    store16a(p - 16, load16(q - 16));
+  }
+
+  store16(d, head0);
+  store16(d + 16, head1);
+  store16(d + n - 32, tail0);
+  store16(d + n - 16, tail1);
+}
+
+//
+// Non-temporal(streaming) stores for copies and fills much larger than the
+// cache. They write whole cache lines to memory without reading them first
+// and without evicting the working set. The source is prefetched with a
+// non-temporal hint `kStreamPrefetch` bytes ahead.
+//
+// SSE2/AVX2: movntdq/vmovntdq + sfence. aarch64: stnp. Other targets use
+// normal stores.
+//
+#if defined(NANOSTL_CSTRING_SSE2) || \
+    (defined(NANOSTL_CSTRING_NEON) && (defined(__GNUC__) || defined(__clang__)))
+#define NANOSTL_CSTRING_STREAM
+#endif
+
+static const unsigned long long kCacheLine = 64;
+static const unsigned long long kStreamPrefetch = 1024;
+
+#if defined(NANOSTL_CSTRING_STREAM)
+
+inline void prefetch_nta(const byte *p) {
+#if defined(NANOSTL_CSTRING_SSE2)
+  _mm_prefetch(reinterpret_cast<const char *>(p), _MM_HINT_NTA);
+#else
+  __builtin_prefetch(p, 0, 0);
+#endif
+}
+
+// `d` must be 64 byte aligned.
+inline void stream64(byte *d, const byte *s) {
+#if defined(NANOSTL_STRSEARCH_AVX2)
+  const __m256i a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s));
+  const __m256i a1 =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + 32));
+  _mm256_stream_si256(reinterpret_cast<__m256i *>(d), a0);
+  _mm256_stream_si256(reinterpret_cast<__m256i *>(d + 32), a1);
+#elif defined(NANOSTL_CSTRING_SSE2)
+  const chunk a0 = load16(s);
+  const chunk a1 = load16(s + 16);
+  const chunk a2 = load16(s + 32);
+  const chunk a3 = load16(s + 48);
+  _mm_stream_si128(reinterpret_cast<__m128i *>(d), a0);
+  _mm_stream_si128(reinterpret_cast<__m128i *>(d + 16), a1);
+  _mm_stream_si128(reinterpret_cast<__m128i *>(d + 32), a2);
+  _mm_stream_si128(reinterpret_cast<__m128i *>(d + 48), a3);
+#else
+  const chunk a0 = load16(s);
+  const chunk a1 = load16(s + 16);
+  const chunk a2 = load16(s + 32);
+  const chunk a3 = load16(s + 48);
+  __asm__ __volatile__("stnp %q1, %q2, [%0]\n\t"
+                       "stnp %q3, %q4, [%0, #32]"
+                       :
+                       : "r"(d), "w"(a0), "w"(a1), "w"(a2), "w"(a3)
+                       : "memory");
+#endif
+}
+
+inline void stream_fill64(byte *d, chunk v) {
+#if defined(NANOSTL_STRSEARCH_AVX2)
+  const __m256i w = _mm256_broadcastsi128_si256(v);
+  _mm256_stream_si256(reinterpret_cast<__m256i *>(d), w);
+  _mm256_stream_si256(reinterpret_cast<__m256i *>(d + 32), w);
+#elif defined(NANOSTL_CSTRING_SSE2)
+  _mm_stream_si128(reinterpret_cast<__m128i *>(d), v);
+  _mm_stream_si128(reinterpret_cast<__m128i *>(d + 16), v);
+  _mm_stream_si128(reinterpret_cast<__m128i *>(d + 32), v);
+  _mm_stream_si128(reinterpret_cast<__m128i *>(d + 48), v);
+#else
+  __asm__ __volatile__("stnp %q1, %q1, [%0]\n\t"
+                       "stnp %q1, %q1, [%0, #32]"
+                       :
+                       : "r"(d), "w"(v)
+                       : "memory");
+#endif
+}
+
+// Orders the streaming stores before the following stores.
+inline void stream_fence() {
+#if defined(NANOSTL_CSTRING_SSE2)
+  _mm_sfence();
+#else
+  __asm__ __volatile__("dmb ishst" : : : "memory");
+#endif
+}
+
+// n >= 256, no overlap.
+inline void copy_stream(byte *d, const byte *s, unsigned long long n) {
+  // First and last 64 bytes use normal stores. In between, whole aligned
+  // cache lines.
+  copy_le128(d, s, 64);
+  const unsigned long long skip = kCacheLine - (addr(d) & (kCacheLine - 1));
+  byte *p = d + skip;
+  const byte *q = s + skip;
+  byte *const end = d + n;
+  for (; p + kCacheLine <= end; p += kCacheLine, q += kCacheLine) {
+    prefetch_nta(q + kStreamPrefetch);
+    stream64(p, q);
+  }
+  stream_fence();
+  copy_le128(end - 64, s + n - 64, 64);
+}
+
+// n >= 256.
+inline void fill_stream(byte *d, chunk v, unsigned long long n) {
+  for (int i = 0; i < 4; i++) {
+    store16(d + 16 * i, v);
+    store16(d + n - 16 * (i + 1), v);
+  }
+  byte *p = d + kCacheLine - (addr(d) & (kCacheLine - 1));
+  byte *const end = d + n;
+  for (; p + kCacheLine <= end; p += kCacheLine) {
+    stream_fill64(p, v);
+  }
+  stream_fence();
+}
+
+#endif
+
+// Index of the first byte which differs in `p` and `q`, or `n`.
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline unsigned long long mismatch(const byte *p, const byte *q,
+                                   unsigned long long n) {
+  if (!is_constant(n)) {
+    p = opaque(p);
+    q = opaque(q);
+  }
+  unsigned long long i = 0;
+#if defined(NANOSTL_STRSEARCH_SIMD)
+  typedef __strsearch::__simd simd;
+  const char *a = reinterpret_cast<const char *>(p);
+  const char *b = reinterpret_cast<const char *>(q);
+  for (; i + 2 * simd::kWidth <= n; i += 2 * simd::kWidth) {
+    const uint64_t ne0 = simd::eq(simd::load(a + i), simd::load(b + i)) ^
+                         simd::full();
+    const uint64_t ne1 =
+        simd::eq(simd::load(a + i + simd::kWidth),
+                 simd::load(b + i + simd::kWidth)) ^
+        simd::full();
+    if (ne0 | ne1) {
+      return ne0 ? (i + __strsearch::__first_index(ne0))
+                 : (i + simd::kWidth + __strsearch::__first_index(ne1));
+    }
+  }
+  for (; i + simd::kWidth <= n; i += simd::kWidth) {
+    const uint64_t ne = simd::eq(simd::load(a + i), simd::load(b + i)) ^
+                        simd::full();
+    if (ne) {
+      return i + __strsearch::__first_index(ne);
+    }
+  }
+#endif
+  for (; i + 8 <= n; i += 8) {
+    if (load64(p + i) != load64(q + i)) {
+      break;
+    }
+  }
+  for (; i < n; i++) {
+    if (p[i] != q[i]) {
+      return i;
+    }
+  }
+  return n;
+}
+
+//
+// NUL terminated scanning. The length is unknown, so blocks are read from
+// aligned addresses(or checked against the page end), which can't fault
+// even if they extend past the terminator.
+//
+static const unsigned long long kPageSize = 4096;
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline const char *align_down(const char *p, unsigned long long align) {
+  return reinterpret_cast<const char *>(addr(p) & ~(align - 1));
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline uint64_t has_zero(uint64_t v) {
+  return (v - 0x0101010101010101ull) & ~v & 0x8080808080808080ull;
+}
+
+// `p` must be 8 byte aligned. May read past the end of the object(`opaque`).
+NANOSTL_HOST_AND_DEVICE_QUAL NANOSTL_NO_SANITIZE_ADDRESS
+inline uint64_t scan_load64(const char *p) {
+#if defined(__GNUC__) || defined(__clang__)
+  uint64_t v;
+  __builtin_memcpy(&v, opaque(p), 8);
+  return v;
+#else
+  return *reinterpret_cast<const uint64_t *>(p);
+#endif
+}
+
+#if defined(NANOSTL_STRSEARCH_SIMD)
+
+typedef __strsearch::__simd simd;
+
+// May read past the end of the object(`opaque`).
+NANOSTL_NO_SANITIZE_ADDRESS
+inline simd::vec scan_load(const char *p) {
+  p = opaque(p);
+#if defined(NANOSTL_STRSEARCH_AVX2)
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+#elif defined(NANOSTL_STRSEARCH_SSE2)
+  return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+#else
+  return vld1q_u8(reinterpret_cast<const uint8_t *>(p));
+#endif
+}
+
+// Bytes from `p` to the end of its page.
+inline unsigned long long page_left(const char *p) {
+  return kPageSize - (addr(p) & (kPageSize - 1));
+}
+
+// Mask of the first `n` bytes(n < kWidth).
+inline uint64_t first_bytes(unsigned long long n) {
+  return (1ull << (n * simd::kBitsPerByte)) - 1;
+}
+
+#endif
+
+}  // namespace __cstring
+
 NANOSTL_HOST_AND_DEVICE_QUAL
-inline void *memcpy(void *dest, const void *src, unsigned long long num)
-{
-  unsigned char *d_ptr = reinterpret_cast<unsigned char *>(dest);
-  const unsigned char *s_ptr = reinterpret_cast<const unsigned char *>(src);
+inline void *memcpy(void *dest, const void *src, unsigned long long num) {
+  __cstring::byte *d = reinterpret_cast<__cstring::byte *>(dest);
+  const __cstring::byte *s = reinterpret_cast<const __cstring::byte *>(src);
+  if (!__cstring::is_constant(num)) {
+    d = __cstring::opaque(d);
+    s = __cstring::opaque(s);
+  }
+  if (num <= 16) {
+    __cstring::copy_le16(d, s, num);
+  } else if (num <= 128) {
+    __cstring::copy_le128(d, s, num);
+#if defined(NANOSTL_CSTRING_STREAM)
+  } else if (num >= NANOSTL_STREAM_THRESHOLD) {
+    __cstring::copy_stream(d, s, num);
+#endif
+  } else {
+    __cstring::copy_forward(d, s, num);
+  }
+  return dest;
+}
 
-  for (unsigned long long i = 0; i < num; i++) {
-    d_ptr[i] = s_ptr[i];
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline void *memmove(void *dest, const void *src, unsigned long long num) {
+  __cstring::byte *d = reinterpret_cast<__cstring::byte *>(dest);
+  const __cstring::byte *s = reinterpret_cast<const __cstring::byte *>(src);
+  if (!__cstring::is_constant(num)) {
+    d = __cstring::opaque(d);
+    s = __cstring::opaque(s);
   }
+  if (num <= 16) {
+    __cstring::copy_le16(d, s, num);
+  } else if (num <= 128) {
+    __cstring::copy_le128(d, s, num);
+  } else if (__cstring::addr(d) - __cstring::addr(s) >= num) {
+    // `d` before `s`(wraps around) or no overlap.
+#if defined(NANOSTL_CSTRING_STREAM)
+    if ((num >= NANOSTL_STREAM_THRESHOLD) &&
+        (__cstring::addr(s) - __cstring::addr(d) >= num)) {
+      __cstring::copy_stream(d, s, num);
+      return dest;
+    }
+#endif
+    __cstring::copy_forward(d, s, num);
+  } else {
+    __cstring::copy_backward(d, s, num);
+  }
+  return dest;
+}
 
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline void *memset(void *dest, int ch, unsigned long long num) {
+  __cstring::byte *d = reinterpret_cast<__cstring::byte *>(dest);
+  if (!__cstring::is_constant(num)) {
+    d = __cstring::opaque(d);
+  }
+  const __cstring::byte c = __cstring::byte(ch);
+  if (num <= 16) {
+    const uint64_t v = uint64_t(c) * 0x0101010101010101ull;
+    if (num >= 8) {
+      __cstring::store64(d, v);
+      __cstring::store64(d + num - 8, v);
+    } else if (num >= 4) {
+      __cstring::store32(d, uint32_t(v));
+      __cstring::store32(d + num - 4, uint32_t(v));
+    } else if (num) {
+      d[0] = c;
+      d[num >> 1] = c;
+      d[num - 1] = c;
+    }
+    return dest;
+  }
+
+  const __cstring::chunk v = __cstring::splat16(c);
+  __cstring::store16(d, v);
+  __cstring::store16(d + num - 16, v);
+  if (num <= 32) {
+    return dest;
+  }
+  __cstring::store16(d + 16, v);
+  __cstring::store16(d + num - 32, v);
+  if (num <= 64) {
+    return dest;
+  }
+#if defined(NANOSTL_CSTRING_STREAM)
+  if (num >= NANOSTL_STREAM_THRESHOLD) {
+    __cstring::fill_stream(d, v, num);
+    return dest;
+  }
+#endif
+  // First and last 32 bytes are set. Aligned stores in between.
+  const unsigned long long align = __cstring::kAlign;
+  __cstring::byte *p = d + align - (__cstring::addr(d) & (align - 1));
+  __cstring::byte *const end = d + num - 32;
+  for (; p + 64 <= end; p += 64) {
+    __cstring::fill64a(p, v);
+  }
+  for (; p < end; p += 16) {
+    __cstring::store16a(p, v);
+  }
   return dest;
 }
 
+///
+/// `memcpy` with non-temporal stores regardless of size. `dest` and `src`
+/// must not overlap.
+///
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline void *memcpy_stream(void *dest, const void *src,
+                           unsigned long long num) {
+#if defined(NANOSTL_CSTRING_STREAM)
+  if (num >= 256) {
+    __cstring::copy_stream(reinterpret_cast<__cstring::byte *>(dest),
+                           reinterpret_cast<const __cstring::byte *>(src), num);
+    return dest;
+  }
+#endif
+  return memcpy(dest, src, num);
+}
+
+///
+/// `memset` with non-temporal stores regardless of size.
+///
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline void *memset_stream(void *dest, int ch, unsigned long long num) {
+#if defined(NANOSTL_CSTRING_STREAM)
+  if (num >= 256) {
+    __cstring::fill_stream(reinterpret_cast<__cstring::byte *>(dest),
+                           __cstring::splat16(__cstring::byte(ch)), num);
+    return dest;
+  }
+#endif
+  return memset(dest, ch, num);
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline int memcmp(const void *lhs, const void *rhs, unsigned long long num) {
+  const __cstring::byte *p = reinterpret_cast<const __cstring::byte *>(lhs);
+  const __cstring::byte *q = reinterpret_cast<const __cstring::byte *>(rhs);
+  const unsigned long long k = __cstring::mismatch(p, q, num);
+  return (k == num) ? 0 : (int(p[k]) - int(q[k]));
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline const void *memchr(const void *ptr, int ch, unsigned long long num) {
+  const char *s = reinterpret_cast<const char *>(ptr);
+  const unsigned long long k = __strsearch::find_char(s, num, char(ch));
+  return (k == __strsearch::npos) ? 0 : s + k;
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline void *memchr(void *ptr, int ch, unsigned long long num) {
+  return const_cast<void *>(
+      memchr(const_cast<const void *>(ptr), ch, num));
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL NANOSTL_NO_SANITIZE_ADDRESS
+inline unsigned long long strlen(const char *str) {
+#if defined(NANOSTL_STRSEARCH_SIMD)
+  typedef __cstring::simd simd;
+  const unsigned long long skip = __cstring::addr(str) & (simd::kWidth - 1);
+  const char *p = __cstring::align_down(str, simd::kWidth);
+  const simd::vec zero = simd::splat(0);
+  uint64_t mask = simd::eq(__cstring::scan_load(p), zero) >>
+                  (skip * simd::kBitsPerByte);
+  if (mask) {
+    return __strsearch::__first_index(mask);
+  }
+  for (;;) {
+    p += simd::kWidth;
+    mask = simd::eq(__cstring::scan_load(p), zero);
+    if (mask) {
+      return (unsigned long long)(p - str) + __strsearch::__first_index(mask);
+    }
+  }
+#else
+  const char *p = str;
+  for (; __cstring::addr(p) & 7; p++) {
+    if (*p == '\0') {
+      return (unsigned long long)(p - str);
+    }
+  }
+  while (!__cstring::has_zero(__cstring::scan_load64(p))) {
+    p += 8;
+  }
+  while (*p) {
+    p++;
+  }
+  return (unsigned long long)(p - str);
+#endif
+}
+
+// Length of `str`, at most `maxlen`(POSIX). `str` needs no terminator within
+// the first `maxlen` chars.
+NANOSTL_HOST_AND_DEVICE_QUAL NANOSTL_NO_SANITIZE_ADDRESS
+inline unsigned long long strnlen(const char *str, unsigned long long maxlen) {
+  if (maxlen == 0) {
+    return 0;
+  }
+#if defined(NANOSTL_STRSEARCH_SIMD)
+  typedef __cstring::simd simd;
+  const unsigned long long skip = __cstring::addr(str) & (simd::kWidth - 1);
+  const char *p = __cstring::align_down(str, simd::kWidth);
+  const simd::vec zero = simd::splat(0);
+  uint64_t mask = simd::eq(__cstring::scan_load(p), zero) >>
+                  (skip * simd::kBitsPerByte);
+  // Bytes of `str` covered so far.
+  unsigned long long n = simd::kWidth - skip;
+  unsigned long long k = mask ? __strsearch::__first_index(mask) : maxlen;
+  while (!mask && (n < maxlen)) {
+    p += simd::kWidth;
+    mask = simd::eq(__cstring::scan_load(p), zero);
+    if (mask) {
+      k = n + __strsearch::__first_index(mask);
+    }
+    n += simd::kWidth;
+  }
+  return (k < maxlen) ? k : maxlen;
+#else
+  unsigned long long i = 0;
+  for (; (i < maxlen) && (__cstring::addr(str + i) & 7); i++) {
+    if (str[i] == '\0') {
+      return i;
+    }
+  }
+  for (; i < maxlen; i += 8) {
+    if (__cstring::has_zero(__cstring::scan_load64(str + i))) {
+      break;
+    }
+  }
+  for (; (i < maxlen) && str[i]; i++) {
+  }
+  return (i < maxlen) ? i : maxlen;
+#endif
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL NANOSTL_NO_SANITIZE_ADDRESS
+inline const char *strchr(const char *str, int ch) {
+  const char c = char(ch);
+#if defined(NANOSTL_STRSEARCH_SIMD)
+  typedef __cstring::simd simd;
+  const unsigned long long skip = __cstring::addr(str) & (simd::kWidth - 1);
+  const char *p = __cstring::align_down(str, simd::kWidth);
+  const simd::vec zero = simd::splat(0);
+  const simd::vec vc = simd::splat(c);
+  simd::vec v = __cstring::scan_load(p);
+  uint64_t mask = (simd::eq(v, zero) | simd::eq(v, vc)) >>
+                  (skip * simd::kBitsPerByte);
+  p = str;
+  while (!mask) {
+    p = __cstring::align_down(p, simd::kWidth) + simd::kWidth;
+    v = __cstring::scan_load(p);
+    mask = simd::eq(v, zero) | simd::eq(v, vc);
+  }
+  p += __strsearch::__first_index(mask);
+#else
+  const char *p = str;
+  for (; __cstring::addr(p) & 7; p++) {
+    if ((*p == c) || (*p == '\0')) {
+      return (*p == c) ? p : 0;
+    }
+  }
+  const uint64_t vc = uint64_t((unsigned char)c) * 0x0101010101010101ull;
+  for (;;) {
+    const uint64_t v = __cstring::scan_load64(p);
+    if (__cstring::has_zero(v) | __cstring::has_zero(v ^ vc)) {
+      break;
+    }
+    p += 8;
+  }
+  while ((*p != c) && (*p != '\0')) {
+    p++;
+  }
+#endif
+  return (*p == c) ? p : 0;
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline char *strchr(char *str, int ch) {
+  return const_cast<char *>(strchr(const_cast<const char *>(str), ch));
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL NANOSTL_NO_SANITIZE_ADDRESS
+inline const char *strrchr(const char *str, int ch) {
+  const char c = char(ch);
+#if defined(NANOSTL_STRSEARCH_SIMD)
+  typedef __cstring::simd simd;
+  const unsigned long long skip = __cstring::addr(str) & (simd::kWidth - 1);
+  const char *p = __cstring::align_down(str, simd::kWidth);
+  const simd::vec zero = simd::splat(0);
+  const simd::vec vc = simd::splat(c);
+  const char *last = 0;
+  // `base` is the address of mask bit 0.
+  const char *base = str;
+  simd::vec v = __cstring::scan_load(p);
+  uint64_t z = simd::eq(v, zero) >> (skip * simd::kBitsPerByte);
+  uint64_t m = simd::eq(v, vc) >> (skip * simd::kBitsPerByte);
+  for (;;) {
+    if (z) {
+      // Only matches up to(and including) the terminator.
+      const uint64_t lowest = z & (~z + 1);
+      m &= (lowest << (simd::kBitsPerByte - 1) << 1) - 1;
+      return m ? base + __strsearch::__last_index(m) : last;
+    }
+    if (m) {
+      last = base + __strsearch::__last_index(m);
+    }
+    p += simd::kWidth;
+    base = p;
+    v = __cstring::scan_load(p);
+    z = simd::eq(v, zero);
+    m = simd::eq(v, vc);
+  }
+#else
+  const char *last = 0;
+  for (;; str++) {
+    if (*str == c) {
+      last = str;
+    }
+    if (*str == '\0') {
+      return last;
+    }
+  }
+#endif
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline char *strrchr(char *str, int ch) {
+  return const_cast<char *>(strrchr(const_cast<const char *>(str), ch));
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL NANOSTL_NO_SANITIZE_ADDRESS
+inline int strncmp(const char *lhs, const char *rhs, unsigned long long num) {
+  const __cstring::byte *p = reinterpret_cast<const __cstring::byte *>(lhs);
+  const __cstring::byte *q = reinterpret_cast<const __cstring::byte *>(rhs);
+  unsigned long long i = 0;
+#if defined(NANOSTL_STRSEARCH_SIMD)
+  typedef __cstring::simd simd;
+  const simd::vec zero = simd::splat(0);
+  while (i < num) {
+    // Blocks which can be loaded before either string reaches a page end.
+    const unsigned long long ra = __cstring::page_left(lhs + i);
+    const unsigned long long rb = __cstring::page_left(rhs + i);
+    unsigned long long blocks = ((ra < rb) ? ra : rb) / simd::kWidth;
+    if (blocks == 0) {
+      // Close to a page end: one byte.
+      if ((p[i] != q[i]) || (p[i] == 0)) {
+        return int(p[i]) - int(q[i]);
+      }
+      i++;
+      continue;
+    }
+    for (; blocks && (i < num); blocks--, i += simd::kWidth) {
+      const simd::vec a = __cstring::scan_load(lhs + i);
+      const simd::vec b = __cstring::scan_load(rhs + i);
+      // Differing bytes and the terminator.
+      uint64_t mask = (simd::eq(a, b) ^ simd::full()) | simd::eq(a, zero);
+      if (num - i < simd::kWidth) {
+        mask &= __cstring::first_bytes(num - i);
+      }
+      if (mask) {
+        const unsigned long long k = i + __strsearch::__first_index(mask);
+        return int(p[k]) - int(q[k]);
+      }
+    }
+  }
+#else
+  for (; i < num; i++) {
+    if ((p[i] != q[i]) || (p[i] == 0)) {
+      return int(p[i]) - int(q[i]);
+    }
+  }
+#endif
+  return 0;
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline int strcmp(const char *lhs, const char *rhs) {
+  return strncmp(lhs, rhs, ~0ull);
+}
+
+// "C" locale only.
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline int strcoll(const char *lhs, const char *rhs) {
+  return strcmp(lhs, rhs);
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline unsigned long long strxfrm(char *dest, const char *src,
+                                  unsigned long long count) {
+  const unsigned long long n = strlen(src);
+  if (n < count) {
+    memcpy(dest, src, n + 1);
+  }
+  return n;
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline const char *strstr(const char *str, const char *target) {
+  const unsigned long long k =
+      __strsearch::find(str, strlen(str), target, strlen(target));
+  return (k == __strsearch::npos) ? 0 : str + k;
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline char *strstr(char *str, const char *target) {
+  return const_cast<char *>(strstr(const_cast<const char *>(str), target));
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline unsigned long long strspn(const char *dest, const char *src) {
+  const unsigned long long n = strlen(dest);
+  const unsigned long long k =
+      __strsearch::find_first_of(dest, n, src, strlen(src), false);
+  return (k == __strsearch::npos) ? n : k;
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline unsigned long long strcspn(const char *dest, const char *src) {
+  const unsigned long long n = strlen(dest);
+  const unsigned long long k =
+      __strsearch::find_first_of(dest, n, src, strlen(src), true);
+  return (k == __strsearch::npos) ? n : k;
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline const char *strpbrk(const char *dest, const char *breakset) {
+  const char *p = dest + strcspn(dest, breakset);
+  return (*p == '\0') ? 0 : p;
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline char *strpbrk(char *dest, const char *breakset) {
+  return const_cast<char *>(
+      strpbrk(const_cast<const char *>(dest), breakset));
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline char *strcpy(char *dest, const char *src) {
+  memcpy(dest, src, strlen(src) + 1);
+  return dest;
+}
+
+// `src` needs no terminator within `count` chars.
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline char *strncpy(char *dest, const char *src, unsigned long long count) {
+  const unsigned long long n = strnlen(src, count);
+  memcpy(dest, src, n);
+  memset(dest + n, 0, count - n);
+  return dest;
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline char *strcat(char *dest, const char *src) {
+  strcpy(dest + strlen(dest), src);
+  return dest;
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline char *strncat(char *dest, const char *src, unsigned long long count) {
+  const unsigned long long n = strnlen(src, count);
+  char *p = dest + strlen(dest);
+  memcpy(p, src, n);
+  p[n] = '\0';
+  return dest;
+}
+
+// Not thread-safe(as std::strtok).
+inline char *strtok(char *str, const char *delim) {
+  static char *next = 0;
+  if (str) {
+    next = str;
+  }
+  if (!next) {
+    return 0;
+  }
+  char *token = next + strspn(next, delim);
+  if (*token == '\0') {
+    next = 0;
+    return 0;
+  }
+  char *end = token + strcspn(token, delim);
+  if (*end) {
+    *end = '\0';
+    next = end + 1;
+  } else {
+    next = 0;
+  }
+  return token;
+}
+
 }  // namespace nanostl
 
 #endif  // NANOSTL_CSTRING_H_
@@ -0,0 +1,305 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 Light Transport Entertainment, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef NANOSTL_CUCKOO_FILTER_H_
+#define NANOSTL_CUCKOO_FILTER_H_
+
+#include "nanocommon.h"
+#include "nanocstdint.h"
+#include "nanovector.h"
+#include "nanohash_append.h"
+#include "__hashfunc.h"
+
+//
+// Cuckoo filter(Fan et al. 2014) with 4 fingerprints per bucket.
+// Unlike bloom_filter, keys can be removed.
+//
+// Measured false positive rate(uniform keys, ~76% load):
+//   uint8_t  : ~2.3%
+//   uint16_t : ~0.008%
+//
+// The table fills up to ~95% load before `insert` fails.
+//
+// `erase` must only be called for keys which were inserted, otherwise a
+// colliding key may be removed.
+//
+
+namespace nanostl {
+
+template <class Key, class Hash = uhash<fast_hasher>,
+          class Fingerprint = uint16_t>
+class cuckoo_filter {
+ public:
+  typedef Key key_type;
+  typedef Hash hasher;
+
+  static const size_t kSlotsPerBucket = 4;
+  static const size_t kMaxKicks = 500;
+
+  explicit cuckoo_filter(size_t capacity, const Hash &hash = Hash())
+      : num_items_(0), has_victim_(false), victim_index_(0), victim_fp_(0),
+        rng_(0x2545f4914f6cdd1dull), hash_(hash) {
+    // Keep load factor <= ~95%
+    size_t want = (capacity + kSlotsPerBucket - 1) / kSlotsPerBucket;
+    want = want + want / 16;
+    size_t n = 1;
+    while (n < want) {
+      n <<= 1;
+    }
+    mask_ = n - 1;
+    table_.resize(n * kSlotsPerBucket);
+    clear();
+  }
+
+  void clear() {
+    for (size_t i = 0; i < table_.size(); i++) {
+      table_[i] = 0;
+    }
+    num_items_ = 0;
+    has_victim_ = false;
+  }
+
+  ///
+  /// Returns false when the filter is too full. In that case the filter
+  /// still answers `contains()` correctly for every inserted key, but no
+  /// more keys can be inserted.
+  ///
+  bool insert(const Key &key) {
+    size_t i;
+    Fingerprint fp;
+    __index_and_fp(__hash(key), &i, &fp);
+    return __insert(i, fp);
+  }
+
+  bool contains(const Key &key) const {
+    size_t i1;
+    Fingerprint fp;
+    __index_and_fp(__hash(key), &i1, &fp);
+    return __contains(i1, __alt_index(i1, fp), fp);
+  }
+
+  ///
+  /// Removes one copy of `key`. Returns false if `key` is not found.
+  ///
+  bool erase(const Key &key) {
+    size_t i1;
+    Fingerprint fp;
+    __index_and_fp(__hash(key), &i1, &fp);
+    size_t i2 = __alt_index(i1, fp);
+
+    if (__remove_from_bucket(i1, fp) || __remove_from_bucket(i2, fp)) {
+      num_items_--;
+      // Room is available again: try to reinsert the victim.
+      if (has_victim_) {
+        has_victim_ = false;
+        __insert(victim_index_, victim_fp_);
+      }
+      return true;
+    }
+
+    if (has_victim_ && (victim_fp_ == fp) &&
+        ((victim_index_ == i1) || (victim_index_ == i2))) {
+      has_victim_ = false;
+      return true;
+    }
+
+    return false;
+  }
+
+  ///
+  /// Batch insert. Returns the number of inserted keys(stops at the first
+  /// failure).
+  ///
+  size_t insert(const Key *first, const Key *last) {
+    size_t count = 0;
+    size_t idx[kBatch];
+    Fingerprint fps[kBatch];
+    while (first != last) {
+      size_t n = 0;
+      for (; (n < kBatch) && (first + n != last); n++) {
+        __index_and_fp(__hash(first[n]), &idx[n], &fps[n]);
+        NANOSTL_PREFETCH(&table_[idx[n] * kSlotsPerBucket]);
+      }
+      for (size_t k = 0; k < n; k++) {
+        if (!__insert(idx[k], fps[k])) {
+          return count;
+        }
+        count++;
+      }
+      first += n;
+    }
+    return count;
+  }
+
+  ///
+  /// Batch query. `results[i]` receives `contains(keys[i])`.
+  /// Returns the number of keys which may be contained.
+  ///
+  size_t contains(const Key *keys, size_t n, bool *results) const {
+    size_t count = 0;
+    size_t idx[kBatch];
+    Fingerprint fps[kBatch];
+    for (size_t base = 0; base < n; base += kBatch) {
+      size_t m = n - base;
+      if (m > kBatch) {
+        m = kBatch;
+      }
+      for (size_t k = 0; k < m; k++) {
+        __index_and_fp(__hash(keys[base + k]), &idx[k], &fps[k]);
+        NANOSTL_PREFETCH(&table_[idx[k] * kSlotsPerBucket]);
+        NANOSTL_PREFETCH(
+            &table_[__alt_index(idx[k], fps[k]) * kSlotsPerBucket]);
+      }
+      for (size_t k = 0; k < m; k++) {
+        results[base + k] =
+            __contains(idx[k], __alt_index(idx[k], fps[k]), fps[k]);
+        count += results[base + k] ? 1 : 0;
+      }
+    }
+    return count;
+  }
+
+  size_t size() const { return num_items_ + (has_victim_ ? 1 : 0); }
+
+  size_t num_buckets() const { return mask_ + 1; }
+
+  // Number of fingerprint slots.
+  size_t capacity() const { return table_.size(); }
+
+  double load_factor() const { return double(size()) / double(capacity()); }
+
+  // In bytes.
+  size_t memory_usage() const { return table_.size() * sizeof(Fingerprint); }
+
+ private:
+  static const size_t kBatch = 16;
+
+  uint64_t __hash(const Key &key) const {
+    return __hash_mix64(static_cast<uint64_t>(hash_(key)));
+  }
+
+  // Lower bits select the bucket, upper bits give the fingerprint.
+  // Fingerprint 0 marks an empty slot.
+  void __index_and_fp(uint64_t h, size_t *index, Fingerprint *fp) const {
+    (*index) = size_t(h) & mask_;
+    const uint64_t fp_max = uint64_t(Fingerprint(~Fingerprint(0)));
+    (*fp) = Fingerprint((h >> 32) % fp_max + 1);
+  }
+
+  size_t __alt_index(size_t index, Fingerprint fp) const {
+    // xor with the hash of the fingerprint: i1 = alt(alt(i1))
+    return (index ^ size_t(__hash_mix64(uint64_t(fp)))) & mask_;
+  }
+
+  bool __bucket_contains(size_t index, Fingerprint fp) const {
+    const Fingerprint *b = &table_[index * kSlotsPerBucket];
+    return (b[0] == fp) | (b[1] == fp) | (b[2] == fp) | (b[3] == fp);
+  }
+
+  bool __contains(size_t i1, size_t i2, Fingerprint fp) const {
+    if (__bucket_contains(i1, fp) || __bucket_contains(i2, fp)) {
+      return true;
+    }
+    return has_victim_ && (victim_fp_ == fp) &&
+           ((victim_index_ == i1) || (victim_index_ == i2));
+  }
+
+  bool __insert_to_bucket(size_t index, Fingerprint fp) {
+    Fingerprint *b = &table_[index * kSlotsPerBucket];
+    for (size_t s = 0; s < kSlotsPerBucket; s++) {
+      if (b[s] == 0) {
+        b[s] = fp;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool __remove_from_bucket(size_t index, Fingerprint fp) {
+    Fingerprint *b = &table_[index * kSlotsPerBucket];
+    for (size_t s = 0; s < kSlotsPerBucket; s++) {
+      if (b[s] == fp) {
+        b[s] = 0;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  uint64_t __next_random() {
+    // xorshift64
+    rng_ ^= rng_ << 13;
+    rng_ ^= rng_ >> 7;
+    rng_ ^= rng_ << 17;
+    return rng_;
+  }
+
+  bool __insert(size_t i1, Fingerprint fp) {
+    if (has_victim_) {
+      return false;
+    }
+
+    if (__insert_to_bucket(i1, fp)) {
+      num_items_++;
+      return true;
+    }
+
+    size_t index = __alt_index(i1, fp);
+    for (size_t kick = 0; kick < kMaxKicks; kick++) {
+      if (__insert_to_bucket(index, fp)) {
+        num_items_++;
+        return true;
+      }
+
+      // Evict a random fingerprint and move it to its alternate bucket.
+      size_t s = size_t(__next_random() % kSlotsPerBucket);
+      Fingerprint &slot = table_[index * kSlotsPerBucket + s];
+      Fingerprint evicted = slot;
+      slot = fp;
+      fp = evicted;
+      index = __alt_index(index, fp);
+    }
+
+    // Keep the last evicted fingerprint so that no inserted key is lost.
+    has_victim_ = true;
+    victim_index_ = index;
+    victim_fp_ = fp;
+    return true;
+  }
+
+  vector<Fingerprint> table_;
+  size_t mask_;
+  size_t num_items_;
+
+  bool has_victim_;
+  size_t victim_index_;
+  Fingerprint victim_fp_;
+
+  uint64_t rng_;
+  Hash hash_;
+};
+
+}  // namespace nanostl
+
+#endif  // NANOSTL_CUCKOO_FILTER_H_
@@ -0,0 +1,255 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 Light Transport Entertainment, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef NANOSTL_FIXED_STRING_H_
+#define NANOSTL_FIXED_STRING_H_
+
+#include "nanocommon.h"
+#include "nanocstdint.h"
+#include "nanostring_view.h"
+#include "__hashfunc.h"
+
+//
+// String of exactly N chars stored inline('\0' terminated). Construction,
+// comparison, concatenation and hashing are constexpr(C++11), so string
+// literal keys cost nothing at runtime.
+//
+//   constexpr auto kName = nanostl::make_fixed_string("albedo");
+//   static_assert(kName.size() == 6, "");
+//   static_assert(kName.hash() == nanostl::make_fixed_string("albedo").hash(),
+//                 "");
+//   nanostl::string_view v = kName;  // no copy
+//
+// In C++17 the size is deduced: `nanostl::basic_fixed_string s("albedo");`.
+// In C++20 it can be a template argument(all members are public):
+//
+//   template <nanostl::basic_fixed_string Name> struct param { ... };
+//   param<"albedo"> p;
+//
+// NOTE: constexpr helpers are recursive(C++11), so they are intended for
+// short strings such as keys and names.
+//
+
+namespace nanostl {
+
+// C++11 constexpr helpers.
+
+// Index sequence(log depth). Local so that this header does not depend on
+// which integer_sequence the tao/seq config picks.
+template <size_t... I>
+struct __fixed_string_seq {};
+
+template <class A, class B>
+struct __fixed_string_seq_cat;
+
+template <size_t... I, size_t... J>
+struct __fixed_string_seq_cat<__fixed_string_seq<I...>,
+                              __fixed_string_seq<J...> > {
+  typedef __fixed_string_seq<I..., (sizeof...(I) + J)...> type;
+};
+
+template <size_t N>
+struct __make_fixed_string_seq {
+  typedef typename __fixed_string_seq_cat<
+      typename __make_fixed_string_seq<N / 2>::type,
+      typename __make_fixed_string_seq<N - N / 2>::type>::type type;
+};
+
+template <>
+struct __make_fixed_string_seq<0> {
+  typedef __fixed_string_seq<> type;
+};
+
+template <>
+struct __make_fixed_string_seq<1> {
+  typedef __fixed_string_seq<0> type;
+};
+
+template <class charT>
+NANOSTL_HOST_AND_DEVICE_QUAL constexpr int __fixed_string_compare(
+    const charT *a, unsigned long long na, const charT *b,
+    unsigned long long nb) {
+  return (na == 0 || nb == 0)
+             ? ((na == nb) ? 0 : ((na < nb) ? -1 : 1))
+             : ((*a != *b) ? ((static_cast<unsigned long long>(*a) <
+                               static_cast<unsigned long long>(*b))
+                                  ? -1
+                                  : 1)
+                           : __fixed_string_compare(a + 1, na - 1, b + 1,
+                                                    nb - 1));
+}
+
+template <class charT, size_t N>
+struct basic_fixed_string {
+  typedef charT value_type;
+  typedef unsigned long long size_type;
+  typedef const charT &const_reference;
+  typedef const charT *const_pointer;
+  typedef const charT *const_iterator;
+
+  // From a string literal of exactly N chars.
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr basic_fixed_string(const charT (&s)[N + 1])
+      : basic_fixed_string(s,
+                           typename __make_fixed_string_seq<N>::type()) {}
+
+  // Used by operator+: chars a[I]... followed by b[J]....
+  template <size_t... I, size_t... J>
+  NANOSTL_HOST_AND_DEVICE_QUAL constexpr basic_fixed_string(
+      const charT *a, __fixed_string_seq<I...>, const charT *b,
+      __fixed_string_seq<J...>)
+      : chars_{a[I]..., b[J]..., charT(0)} {}
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr size_type size() const { return N; }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr size_type length() const { return N; }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr bool empty() const { return N == 0; }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr const charT *data() const { return chars_; }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr const charT *c_str() const { return chars_; }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr const_iterator begin() const { return chars_; }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr const_iterator end() const { return chars_ + N; }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr const charT &operator[](size_type pos) const {
+    return chars_[pos];
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr basic_string_view<charT> view() const {
+    return basic_string_view<charT>(chars_, N);
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr operator basic_string_view<charT>() const { return view(); }
+
+  // 64bit FNV-1a of the chars(`__hash_fnv1a_n()`).
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr uint64_t hash() const { return __hash_fnv1a_n(chars_, N); }
+
+  template <size_t M>
+  NANOSTL_HOST_AND_DEVICE_QUAL constexpr int compare(
+      const basic_fixed_string<charT, M> &rhs) const {
+    return __fixed_string_compare(chars_, N, rhs.chars_, M);
+  }
+
+  // Public so that the type is structural(C++20 template argument). Do not
+  // modify.
+  charT chars_[N + 1];
+
+ private:
+  template <size_t... I>
+  NANOSTL_HOST_AND_DEVICE_QUAL constexpr basic_fixed_string(
+      const charT *s, __fixed_string_seq<I...>)
+      : chars_{s[I]..., charT(0)} {}
+};
+
+template <size_t N>
+using fixed_string = basic_fixed_string<char, N>;
+
+#if NANOSTL_CPLUSPLUS >= 201703L
+template <class charT, size_t M>
+basic_fixed_string(const charT (&)[M]) -> basic_fixed_string<charT, M - 1>;
+#endif
+
+template <class charT, size_t M>
+NANOSTL_HOST_AND_DEVICE_QUAL constexpr basic_fixed_string<charT, M - 1>
+make_fixed_string(const charT (&s)[M]) {
+  return basic_fixed_string<charT, M - 1>(s);
+}
+
+template <class charT, size_t N, size_t M>
+NANOSTL_HOST_AND_DEVICE_QUAL constexpr basic_fixed_string<charT, N + M>
+operator+(const basic_fixed_string<charT, N> &a,
+          const basic_fixed_string<charT, M> &b) {
+  return basic_fixed_string<charT, N + M>(
+      a.data(), typename __make_fixed_string_seq<N>::type(), b.data(),
+      typename __make_fixed_string_seq<M>::type());
+}
+
+#define NANOSTL_FIXED_STRING_COMPARE_OP(op)                               \
+  template <class charT, size_t N, size_t M>                              \
+  NANOSTL_HOST_AND_DEVICE_QUAL constexpr bool operator op(                \
+      const basic_fixed_string<charT, N> &a,                              \
+      const basic_fixed_string<charT, M> &b) {                            \
+    return a.compare(b) op 0;                                             \
+  }                                                                       \
+  template <class charT, size_t N, size_t M>                              \
+  NANOSTL_HOST_AND_DEVICE_QUAL constexpr bool operator op(                \
+      const basic_fixed_string<charT, N> &a, const charT (&b)[M]) {       \
+    return __fixed_string_compare(a.data(), N, b, M - 1) op 0;            \
+  }                                                                       \
+  template <class charT, size_t N, size_t M>                              \
+  NANOSTL_HOST_AND_DEVICE_QUAL constexpr bool operator op(                \
+      const charT (&a)[M], const basic_fixed_string<charT, N> &b) {       \
+    return __fixed_string_compare(a, M - 1, b.data(), N) op 0;            \
+  }
+
+NANOSTL_FIXED_STRING_COMPARE_OP(==)
+NANOSTL_FIXED_STRING_COMPARE_OP(!=)
+NANOSTL_FIXED_STRING_COMPARE_OP(<)
+NANOSTL_FIXED_STRING_COMPARE_OP(>)
+NANOSTL_FIXED_STRING_COMPARE_OP(<=)
+NANOSTL_FIXED_STRING_COMPARE_OP(>=)
+
+#undef NANOSTL_FIXED_STRING_COMPARE_OP
+
+// Hash functor for hash containers keyed by fixed strings or string views
+// (gives the same value for the same chars).
+struct fixed_string_hash {
+  typedef unsigned long long result_type;
+
+  template <class charT, size_t N>
+  NANOSTL_HOST_AND_DEVICE_QUAL constexpr unsigned long long operator()(
+      const basic_fixed_string<charT, N> &s) const {
+    return s.hash();
+  }
+
+  template <class charT>
+  NANOSTL_HOST_AND_DEVICE_QUAL unsigned long long operator()(
+      basic_string_view<charT> s) const {
+    // `__hash_fnv1a_n()` as a loop(views may be too long for the recursion).
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (unsigned long long i = 0; i < s.size(); i++) {
+      h = (h ^ __hash_fnv1a_unit(s[i])) * 0x100000001b3ull;
+    }
+    return h;
+  }
+};
+
+}  // namespace nanostl
+
+#endif  // NANOSTL_FIXED_STRING_H_
@@ -0,0 +1,122 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 Light Transport Entertainment, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef NANOSTL_FORMAT_NUMBERS_H_
+#define NANOSTL_FORMAT_NUMBERS_H_
+
+#include "nanocommon.h"
+#include "nanosystem_error.h"
+#include "nanostring.h"
+
+//
+// Bulk float/double -> text. Counterpart of parse_numbers.
+//
+//   nanostl::string text;
+//   nanostl::format_numbers(text, values.data(), values.size());
+//
+// Values are written with ryu(shortest round-trip, same text as
+// `to_string(float)`/`to_string(double)`) directly into the output, with
+// `separator` between values(not after the last one). Nothing is allocated
+// per value.
+//
+// The caller buffer overload writes into [first, last). If the buffer is too
+// small, returns `ec == errc::value_too_large` with `count` values(and their
+// separators) written and `ptr` past them. At most
+// `format_numbers_max_size()` chars are written.
+//
+// The string overload appends to `out` and returns the number of chars
+// appended.
+//
+// With `num_threads != 1`, the values are split into chunks of at least
+// `min_chunk_values` which are formatted in parallel. The output is identical
+// to the serial one.
+//
+// Implementation is in src/nanoformat_numbers.cc(requires src/nanothread.cc).
+//
+
+namespace nanostl {
+
+struct format_numbers_options {
+  // '\0' terminated separator written between values.
+  const char *separator;
+
+  // 1: format on the calling thread. 0: use hardware concurrency.
+  unsigned num_threads;
+
+  // Minimum values per thread.
+  unsigned long long min_chunk_values;
+
+  format_numbers_options()
+      : separator("\n"), num_threads(1), min_chunk_values(1 << 16) {}
+};
+
+struct format_numbers_result {
+  // One past the last written char.
+  char *ptr;
+  errc ec;
+
+  // Number of values written.
+  unsigned long long count;
+};
+
+// Max chars of one value(ryu f2s/d2s).
+static const int kFormatFloatMaxChars = 15;
+static const int kFormatDoubleMaxChars = 24;
+
+format_numbers_result format_numbers(
+    char *first, char *last, const float *values, unsigned long long n,
+    const format_numbers_options &options = format_numbers_options());
+
+format_numbers_result format_numbers(
+    char *first, char *last, const double *values, unsigned long long n,
+    const format_numbers_options &options = format_numbers_options());
+
+unsigned long long format_numbers(
+    string &out, const float *values, unsigned long long n,
+    const format_numbers_options &options = format_numbers_options());
+
+unsigned long long format_numbers(
+    string &out, const double *values, unsigned long long n,
+    const format_numbers_options &options = format_numbers_options());
+
+// Upper bound of chars written for `n` values.
+inline unsigned long long format_numbers_max_size(
+    unsigned long long n, int max_chars,
+    const format_numbers_options &options = format_numbers_options()) {
+  if (n == 0) {
+    return 0;
+  }
+  unsigned long long sep_len = 0;
+  if (options.separator) {
+    while (options.separator[sep_len]) {
+      sep_len++;
+    }
+  }
+  return n * (unsigned long long)max_chars + (n - 1) * sep_len;
+}
+
+}  // namespace nanostl
+
+#endif  // NANOSTL_FORMAT_NUMBERS_H_
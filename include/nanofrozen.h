@@ -0,0 +1,479 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 Light Transport Entertainment, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef NANOSTL_FROZEN_H_
+#define NANOSTL_FROZEN_H_
+
+#include "nanocommon.h"
+#include "nanocassert.h"
+#include "nanocstdint.h"
+#include "nanoutility.h"
+#include "nanostring_view.h"
+#include "__hashfunc.h"
+
+// abort(). __nullptr defines `nullptr` as a macro, which breaks system
+// headers.
+#pragma push_macro("nullptr")
+#undef nullptr
+#include <stdlib.h>
+#pragma pop_macro("nullptr")
+
+//
+// Immutable hash map/set whose layout is computed at compile time.
+//
+// The table is built with "hash, displace and compress"(CHD): keys are first
+// distributed into buckets, then each bucket gets a seed(pilot) which moves
+// all of its keys into free slots. Single key buckets directly store their
+// slot. Lookup is two hashes, two table reads and one key compare, without
+// allocation.
+//
+//   constexpr auto kOps = nanostl::make_frozen_map<const char *, int>(
+//       {{"add", 0}, {"sub", 1}, {"mul", 2}});
+//   static_assert(kOps.at("sub") == 1, "");
+//
+// Requires C++14 compiler(relaxed constexpr).
+//
+
+#if NANOSTL_CPLUSPLUS >= 201402L
+
+namespace nanostl {
+
+// Hash used to build frozen tables. Must be constexpr and must give
+// (pseudo-)independent values for different `seed`s.
+template <class Key>
+struct frozen_hash {
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr uint64_t operator()(const Key &k, uint64_t seed) const {
+    return __hash_mix64(static_cast<uint64_t>(k) +
+                        seed * 0x9e3779b97f4a7c15ull);
+  }
+};
+
+template <>
+struct frozen_hash<const char *> {
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr uint64_t operator()(const char *s, uint64_t seed) const {
+    return __hash_mix64(__hash_fnv1a(s) + seed * 0x9e3779b97f4a7c15ull);
+  }
+};
+
+template <>
+struct frozen_hash<string_view> {
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr uint64_t operator()(string_view s, uint64_t seed) const {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < s.size(); i++) {
+      h = (h ^ static_cast<unsigned char>(s[i])) * 0x100000001b3ull;
+    }
+    return __hash_mix64(h + seed * 0x9e3779b97f4a7c15ull);
+  }
+};
+
+template <class Key>
+struct frozen_equal {
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr bool operator()(const Key &a, const Key &b) const {
+    return a == b;
+  }
+};
+
+template <>
+struct frozen_equal<const char *> {
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr bool operator()(const char *a, const char *b) const {
+    while ((*a != '\0') && (*a == *b)) {
+      a++;
+      b++;
+    }
+    return *a == *b;
+  }
+};
+
+// Fixed size array usable in C++14 constexpr context.
+template <class T, size_t N>
+struct __frozen_carray {
+  T data_[N];
+
+  constexpr __frozen_carray() : data_{} {}
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr T &operator[](size_t i) { return data_[i]; }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr const T &operator[](size_t i) const { return data_[i]; }
+};
+
+// Smallest power of two >= n.
+constexpr size_t __frozen_table_size(size_t n) {
+  size_t m = 1;
+  while (m < n) {
+    m <<= 1;
+  }
+  return m;
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline void __frozen_abort() {
+#if defined(__CUDA_ARCH__)
+  __trap();
+#else
+  ::abort();
+#endif
+}
+
+// Never constexpr: reaching these in constant evaluation stops the
+// compilation with the function's name in the diagnostic. At runtime they
+// abort(with NDEBUG as well).
+inline void __frozen_error_duplicate_or_unhashable_keys() {
+  assert(0 && "frozen_map/frozen_set: duplicated keys or bad hash function.");
+  __frozen_abort();
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline void __frozen_error_key_not_found() {
+  assert(0 && "frozen_map::at: key not found.");
+  __frozen_abort();
+}
+
+// Slot layout shared by frozen_map and frozen_set.
+// N : the number of keys, M : the number of buckets and slots(power of two).
+template <size_t N, size_t M>
+struct __frozen_layout {
+  static const size_t kMaxPilotTrials = 1u << 16;
+  static const size_t kMaxSeedTrials = 64;
+
+  uint64_t seed_;
+
+  // >= 0 : pilot(seed) for the bucket. < 0 : -(slot + 1)
+  __frozen_carray<int64_t, M> pilots_;
+
+  // slot -> key index
+  __frozen_carray<size_t, M> index_;
+
+  constexpr __frozen_layout() : seed_(0), pilots_(), index_() {}
+
+  template <class Items, class GetKey, class Hash, class KeyEqual>
+  constexpr void build(const Items &items, GetKey get_key, const Hash &hash,
+                       const KeyEqual &equal) {
+    for (uint64_t s = 0; s < kMaxSeedTrials; s++) {
+      if (try_build(items, get_key, hash, equal, s)) {
+        return;
+      }
+    }
+    __frozen_error_duplicate_or_unhashable_keys();
+  }
+
+  template <class Key, class Hash>
+  NANOSTL_HOST_AND_DEVICE_QUAL constexpr size_t slot(const Key &k,
+                                                     const Hash &hash) const {
+    const int64_t p = pilots_[hash(k, seed_) & (M - 1)];
+    return (p < 0) ? size_t(-p - 1)
+                   : size_t(hash(k, uint64_t(p)) & (M - 1));
+  }
+
+ private:
+  template <class Items, class GetKey, class Hash, class KeyEqual>
+  constexpr bool try_build(const Items &items, GetKey get_key,
+                           const Hash &hash, const KeyEqual &equal,
+                           uint64_t seed) {
+    seed_ = seed;
+
+    // Bucketize keys(counting sort by bucket id).
+    __frozen_carray<size_t, N> bucket_of;
+    __frozen_carray<size_t, M + 1> bucket_start;
+    for (size_t i = 0; i < N; i++) {
+      bucket_of[i] = hash(get_key(items[i]), seed) & (M - 1);
+      bucket_start[bucket_of[i] + 1]++;
+    }
+    for (size_t b = 0; b < M; b++) {
+      bucket_start[b + 1] += bucket_start[b];
+    }
+
+    __frozen_carray<size_t, N> members;
+    {
+      __frozen_carray<size_t, M> fill;
+      for (size_t i = 0; i < N; i++) {
+        const size_t b = bucket_of[i];
+        members[bucket_start[b] + fill[b]] = i;
+        fill[b]++;
+      }
+    }
+
+    // Order buckets by size, largest first(counting sort by size).
+    __frozen_carray<size_t, N + 2> size_start;
+    for (size_t b = 0; b < M; b++) {
+      const size_t sz = bucket_start[b + 1] - bucket_start[b];
+      size_start[N - sz + 1]++;
+    }
+    for (size_t k = 0; k < N + 1; k++) {
+      size_start[k + 1] += size_start[k];
+    }
+    __frozen_carray<size_t, M> order;
+    for (size_t b = 0; b < M; b++) {
+      const size_t sz = bucket_start[b + 1] - bucket_start[b];
+      order[size_start[N - sz]++] = b;
+    }
+
+    __frozen_carray<bool, M> occupied;
+    for (size_t s = 0; s < M; s++) {
+      pilots_[s] = 0;
+      index_[s] = 0;
+    }
+
+    size_t free_slot = 0;
+    for (size_t o = 0; o < M; o++) {
+      const size_t b = order[o];
+      const size_t first = bucket_start[b];
+      const size_t count = bucket_start[b + 1] - first;
+
+      if (count == 0) {
+        break;  // remaining buckets are all empty.
+      }
+
+      if (count == 1) {
+        while (occupied[free_slot]) {
+          free_slot++;
+        }
+        occupied[free_slot] = true;
+        pilots_[b] = -int64_t(free_slot) - 1;
+        index_[free_slot] = members[first];
+        continue;
+      }
+
+      // Equal keys always fall into the same bucket.
+      for (size_t i = 0; i < count; i++) {
+        for (size_t j = i + 1; j < count; j++) {
+          if (equal(get_key(items[members[first + i]]),
+                    get_key(items[members[first + j]]))) {
+            __frozen_error_duplicate_or_unhashable_keys();
+            return false;
+          }
+        }
+      }
+
+      bool placed = false;
+      __frozen_carray<size_t, N> slots;
+      for (uint64_t p = 0; (p < kMaxPilotTrials) && !placed; p++) {
+        placed = true;
+        for (size_t i = 0; i < count; i++) {
+          const size_t s =
+              hash(get_key(items[members[first + i]]), p) & (M - 1);
+          if (occupied[s]) {
+            placed = false;
+            break;
+          }
+          for (size_t j = 0; j < i; j++) {
+            if (slots[j] == s) {
+              placed = false;
+              break;
+            }
+          }
+          if (!placed) {
+            break;
+          }
+          slots[i] = s;
+        }
+
+        if (placed) {
+          pilots_[b] = int64_t(p);
+          for (size_t i = 0; i < count; i++) {
+            occupied[slots[i]] = true;
+            index_[slots[i]] = members[first + i];
+          }
+        }
+      }
+
+      if (!placed) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+};
+
+template <class Key, class T>
+struct __frozen_map_key {
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr const Key &operator()(const pair<Key, T> &v) const {
+    return v.first;
+  }
+};
+
+template <class Key>
+struct __frozen_set_key {
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr const Key &operator()(const Key &k) const { return k; }
+};
+
+///
+/// Immutable map with `N` entries. Construct it in constexpr context to get
+/// the table without any startup cost.
+///
+template <class Key, class T, size_t N, class Hash = frozen_hash<Key>,
+          class KeyEqual = frozen_equal<Key> >
+class frozen_map {
+  static_assert(N > 0, "frozen_map requires at least one entry.");
+
+ public:
+  typedef Key key_type;
+  typedef T mapped_type;
+  typedef pair<Key, T> value_type;
+  typedef size_t size_type;
+  typedef const value_type &const_reference;
+  typedef const value_type *const_iterator;
+  typedef const_iterator iterator;
+
+  static const size_t table_size = __frozen_table_size(N);
+
+  constexpr explicit frozen_map(const value_type (&items)[N],
+                                const Hash &hash = Hash(),
+                                const KeyEqual &equal = KeyEqual())
+      : items_(), layout_(), hash_(hash), equal_(equal) {
+    for (size_t i = 0; i < N; i++) {
+      items_[i] = items[i];
+    }
+    layout_.build(items_, __frozen_map_key<Key, T>(), hash_, equal_);
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr const_iterator find(const Key &key) const {
+    const value_type &v = items_[layout_.index_[layout_.slot(key, hash_)]];
+    return equal_(v.first, key) ? &v : end();
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr size_type count(const Key &key) const {
+    return (find(key) != end()) ? 1 : 0;
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr bool contains(const Key &key) const { return find(key) != end(); }
+
+  // Key must exist. A missing key fails the compilation in constant
+  // evaluation and aborts at runtime(no exception).
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr const T &at(const Key &key) const {
+    const value_type &v = items_[layout_.index_[layout_.slot(key, hash_)]];
+    if (!equal_(v.first, key)) {
+      __frozen_error_key_not_found();
+    }
+    return v.second;
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr const_iterator begin() const { return &items_[0]; }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr const_iterator end() const { return &items_[0] + N; }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr size_type size() const { return N; }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr bool empty() const { return false; }
+
+ private:
+  __frozen_carray<value_type, N> items_;
+  __frozen_layout<N, table_size> layout_;
+  Hash hash_;
+  KeyEqual equal_;
+};
+
+///
+/// Immutable set with `N` keys.
+///
+template <class Key, size_t N, class Hash = frozen_hash<Key>,
+          class KeyEqual = frozen_equal<Key> >
+class frozen_set {
+  static_assert(N > 0, "frozen_set requires at least one key.");
+
+ public:
+  typedef Key key_type;
+  typedef Key value_type;
+  typedef size_t size_type;
+  typedef const value_type &const_reference;
+  typedef const value_type *const_iterator;
+  typedef const_iterator iterator;
+
+  static const size_t table_size = __frozen_table_size(N);
+
+  constexpr explicit frozen_set(const Key (&keys)[N], const Hash &hash = Hash(),
+                                const KeyEqual &equal = KeyEqual())
+      : keys_(), layout_(), hash_(hash), equal_(equal) {
+    for (size_t i = 0; i < N; i++) {
+      keys_[i] = keys[i];
+    }
+    layout_.build(keys_, __frozen_set_key<Key>(), hash_, equal_);
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr const_iterator find(const Key &key) const {
+    const Key &k = keys_[layout_.index_[layout_.slot(key, hash_)]];
+    return equal_(k, key) ? &k : end();
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr size_type count(const Key &key) const {
+    return (find(key) != end()) ? 1 : 0;
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr bool contains(const Key &key) const { return find(key) != end(); }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr const_iterator begin() const { return &keys_[0]; }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr const_iterator end() const { return &keys_[0] + N; }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr size_type size() const { return N; }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr bool empty() const { return false; }
+
+ private:
+  __frozen_carray<Key, N> keys_;
+  __frozen_layout<N, table_size> layout_;
+  Hash hash_;
+  KeyEqual equal_;
+};
+
+template <class Key, class T, size_t N>
+constexpr frozen_map<Key, T, N> make_frozen_map(
+    const pair<Key, T> (&items)[N]) {
+  return frozen_map<Key, T, N>(items);
+}
+
+template <class Key, size_t N>
+constexpr frozen_set<Key, N> make_frozen_set(const Key (&keys)[N]) {
+  return frozen_set<Key, N>(keys);
+}
+
+}  // namespace nanostl
+
+#endif  // NANOSTL_CPLUSPLUS >= 201402L
+
+#endif  // NANOSTL_FROZEN_H_
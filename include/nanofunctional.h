@@ -30,19 +30,11 @@
 #endif
 
 #include "__hashfunc.h"
+#include "__nanofunctional_base.h"  // less
 #include "__nullptr"
 
 namespace nanostl {
 
-// less
-
-template<class T>
-struct less {
-  bool operator()(const T& lhs, const T& rhs) const {
-    return lhs < rhs;
-  }
-};
-
 
 
 // from libc++ =======
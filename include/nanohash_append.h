@@ -0,0 +1,288 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 Light Transport Entertainment, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef NANOSTL_HASH_APPEND_H_
+#define NANOSTL_HASH_APPEND_H_
+
+#include "__hashfunc.h"
+#include "nanocommon.h"
+#include "nanotype_traits.h"
+#include "nanoutility.h"
+#include "nanostring.h"
+#include "nanostring_view.h"
+#include "nanovector.h"
+#include "nanotuple.h"
+
+//
+// Composable hashing in the style of N3980 "Types Don't Know #".
+//
+// A type describes *what* to hash by feeding its bytes into a hasher through
+// `hash_append(h, value)`. The hasher(`fast_hasher`, `siphash_hasher`, ...)
+// decides *how* to hash. A value is hashed once, with a single finalization.
+//
+//   nanostl::pair<int, nanostl::string> p(1, "a");
+//   size_t h = nanostl::uhash<>()(p);
+//   size_t s = nanostl::uhash<nanostl::siphash_hasher>()(p);
+//
+// Hash user types by providing `hash_append` in the type's namespace(found by
+// ADL):
+//
+//   template <class H>
+//   void hash_append(H &h, const Mesh &m) {
+//     using nanostl::hash_append;
+//     hash_append(h, m.name);
+//     hash_append(h, m.vertices);
+//   }
+//
+// `optional` and `variant` overloads are defined at the end of this file once
+// nanooptional.h / nanovariant.h have been included(in either order), so
+// this header does not pull them in.
+//
+// Types whose object representation is their value(no padding, no
+// floating point) may specialize `is_contiguously_hashable` so that arrays
+// and vectors of them are fed as one block.
+//
+
+namespace nanostl {
+
+template <class T>
+struct is_contiguously_hashable
+    : public integral_constant<bool, is_integral<T>::value ||
+                                         is_enum<T>::value ||
+                                         is_pointer<T>::value> {};
+
+template <class T, class U>
+struct is_contiguously_hashable<pair<T, U> >
+    : public integral_constant<bool, is_contiguously_hashable<T>::value &&
+                                         is_contiguously_hashable<U>::value &&
+                                         (sizeof(T) + sizeof(U) ==
+                                          sizeof(pair<T, U>))> {};
+
+template <class T, size_t N>
+struct is_contiguously_hashable<T[N]> : public is_contiguously_hashable<T> {};
+
+template <class T>
+struct is_contiguously_hashable<const T> : public is_contiguously_hashable<T> {
+};
+
+// Declarations first so that every overload is visible from the others.
+
+template <class H, class T>
+typename enable_if<is_contiguously_hashable<T>::value>::type hash_append(
+    H &h, const T &t);
+
+template <class H>
+void hash_append(H &h, float v);
+
+template <class H>
+void hash_append(H &h, double v);
+
+template <class H, class T, size_t N>
+typename enable_if<!is_contiguously_hashable<T>::value>::type hash_append(
+    H &h, const T (&a)[N]);
+
+template <class H, class T, class U>
+typename enable_if<!is_contiguously_hashable<pair<T, U> >::value>::type
+hash_append(H &h, const pair<T, U> &p);
+
+template <class H, class... Ts>
+void hash_append(H &h, const tao::tuple<Ts...> &t);
+
+template <class H, class charT, class Allocator>
+void hash_append(H &h, const basic_string<charT, Allocator> &s);
+
+template <class H, class charT>
+void hash_append(H &h, const basic_string_view<charT> &s);
+
+template <class H, class T, class Allocator>
+void hash_append(H &h, const vector<T, Allocator> &v);
+
+// Hash several values in order.
+template <class H, class T0, class T1, class... Ts>
+void hash_append(H &h, const T0 &t0, const T1 &t1, const Ts &... ts);
+
+//
+
+template <class H, class T>
+inline typename enable_if<is_contiguously_hashable<T>::value>::type
+hash_append(H &h, const T &t) {
+  h(&t, sizeof(t));
+}
+
+template <class H>
+inline void hash_append(H &h, float v) {
+  // -0.0 and 0.0 must give the same hash.
+  if (v == 0.0f) {
+    v = 0.0f;
+  }
+  h(&v, sizeof(v));
+}
+
+template <class H>
+inline void hash_append(H &h, double v) {
+  if (v == 0.0) {
+    v = 0.0;
+  }
+  h(&v, sizeof(v));
+}
+
+template <class H, class T, size_t N>
+inline typename enable_if<!is_contiguously_hashable<T>::value>::type
+hash_append(H &h, const T (&a)[N]) {
+  for (size_t i = 0; i < N; i++) {
+    hash_append(h, a[i]);
+  }
+}
+
+template <class H, class T, class U>
+inline typename enable_if<!is_contiguously_hashable<pair<T, U> >::value>::type
+hash_append(H &h, const pair<T, U> &p) {
+  hash_append(h, p.first);
+  hash_append(h, p.second);
+}
+
+template <class H, class Tuple, size_t... Is>
+inline void __hash_append_tuple(H &h, const Tuple &t,
+                                tao::seq::index_sequence<Is...>) {
+  int expand[] = {0, (hash_append(h, tao::get<Is>(t)), 0)...};
+  (void)expand;
+}
+
+template <class H, class... Ts>
+inline void hash_append(H &h, const tao::tuple<Ts...> &t) {
+  __hash_append_tuple(h, t, tao::seq::index_sequence_for<Ts...>());
+}
+
+template <class H, class charT, class Allocator>
+inline void hash_append(H &h, const basic_string<charT, Allocator> &s) {
+  // Contiguous block followed by the length, so that ("ab", "c") and
+  // ("a", "bc") hash differently.
+  h(s.c_str(), s.size() * sizeof(charT));
+  hash_append(h, static_cast<size_t>(s.size()));
+}
+
+// Same as `basic_string`, so a view and a string with the same contents give
+// the same hash.
+template <class H, class charT>
+inline void hash_append(H &h, const basic_string_view<charT> &s) {
+  h(s.data(), s.size() * sizeof(charT));
+  hash_append(h, static_cast<size_t>(s.size()));
+}
+
+template <class H, class T, class Allocator>
+inline void hash_append(H &h, const vector<T, Allocator> &v) {
+  if (is_contiguously_hashable<T>::value) {
+    if (v.size()) {
+      h(v.begin(), v.size() * sizeof(T));
+    }
+  } else {
+    for (size_t i = 0; i < v.size(); i++) {
+      hash_append(h, v[i]);
+    }
+  }
+  hash_append(h, static_cast<size_t>(v.size()));
+}
+
+template <class H, class T0, class T1, class... Ts>
+inline void hash_append(H &h, const T0 &t0, const T1 &t1, const Ts &... ts) {
+  hash_append(h, t0);
+  hash_append(h, t1, ts...);
+}
+
+///
+/// Hash functor: feeds a value into a fresh `Hasher` and finalizes it.
+/// Drop-in for the `Hash` template parameter of hash containers.
+///
+template <class Hasher = fast_hasher>
+struct uhash {
+  typedef size_t result_type;
+
+  template <class T>
+  size_t operator()(const T &t) const {
+    Hasher h;
+    hash_append(h, t);
+    return static_cast<size_t>(static_cast<typename Hasher::result_type>(h));
+  }
+};
+
+}  // namespace nanostl
+
+#endif  // NANOSTL_HASH_APPEND_H_
+
+// Overloads for optional/variant. These sit outside the include guard:
+// nanooptional.h and nanovariant.h re-include this header when it was included
+// before them, and each block is emitted once.
+
+#if defined(NANOSTL_OPTIONAL_H_) && !defined(NANOSTL_HASH_APPEND_OPTIONAL_)
+#define NANOSTL_HASH_APPEND_OPTIONAL_
+
+namespace nanostl {
+
+template <class H, class T>
+inline void hash_append(H &h, const optional<T> &o) {
+  if (o.has_value()) {
+    hash_append(h, o.value());
+  }
+  // Also distinguishes `optional<int>()` from `optional<int>(0)`
+  hash_append(h, o.has_value());
+}
+
+}  // namespace nanostl
+
+#endif  // NANOSTL_HASH_APPEND_OPTIONAL_
+
+#if defined(NANOSTL_VARIANT_H_) && !defined(NANOSTL_HASH_APPEND_VARIANT_)
+#define NANOSTL_HASH_APPEND_VARIANT_
+
+namespace nanostl {
+
+template <size_t I, size_t N>
+struct __hash_append_variant {
+  template <class H, class V>
+  static void apply(H &h, const V &v) {
+    if (v.index() == I) {
+      hash_append(h, nonstd::get<I>(v));
+      return;
+    }
+    __hash_append_variant<I + 1, N>::apply(h, v);
+  }
+};
+
+template <size_t N>
+struct __hash_append_variant<N, N> {
+  template <class H, class V>
+  static void apply(H &, const V &) {}
+};
+
+// Hashes the active alternative followed by its index.
+template <class H, class... Ts>
+inline void hash_append(H &h, const variant<Ts...> &v) {
+  __hash_append_variant<0, nonstd::variant_size<variant<Ts...> >::value>::apply(
+      h, v);
+  hash_append(h, static_cast<size_t>(v.index()));
+}
+
+}  // namespace nanostl
+
+#endif  // NANOSTL_HASH_APPEND_VARIANT_
@@ -26,6 +26,7 @@
 #define NANOSTL_MAP_H_
 
 #include "nanoutility.h"  // nanostl::pair
+#include "__nanofunctional_base.h"  // nanostl::less
 #include "nanovector.h"
 
 #ifdef NANOSTL_DEBUG
@@ -55,9 +56,15 @@ static inline priority_type priority_rand() {
   return y = y ^ (y << 5);
 }
 
-// TODO(LTE): Support Comparator and Allocator.
-template <class Key, class T>
-class map {
+// Nodes are allocated with `Allocator` rebound to node storage, so a
+// stateful allocator(e.g. `arena_allocator`) also works for maps.
+//
+// TODO(LTE): Support stateful Compare.
+template <class Key, class T, class Compare = less<Key>,
+          class Allocator = allocator<pair<const Key, T> > >
+class map : private __allocator_holder<Allocator> {
+  typedef __allocator_holder<Allocator> __base;
+
  public:
   typedef Key key_type;
   typedef nanostl::pair<const Key, T> value_type;
@@ -65,6 +72,8 @@ class map {
   typedef const value_type& const_reference;
   typedef value_type* pointer;
   typedef const value_type* const_pointer;
+  typedef Compare key_compare;
+  typedef Allocator allocator_type;
 
   struct Node {
     value_type val;
@@ -76,12 +85,12 @@ class map {
   };
 
   class iterator {
-    map<Key, T>* mp;
+    map* mp;
     Node* p;
 
    public:
     NANOSTL_HOST_AND_DEVICE_QUAL
-    iterator(map<Key, T>* _mp = 0, Node* _p = 0) : mp(_mp), p(_p) {}
+    iterator(map* _mp = 0, Node* _p = 0) : mp(_mp), p(_p) {}
 
     NANOSTL_HOST_AND_DEVICE_QUAL
     iterator& operator++() {
@@ -120,9 +129,18 @@ class map {
   NANOSTL_HOST_AND_DEVICE_QUAL
   map() { root = 0; }
 
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  explicit map(const allocator_type& alloc) : __base(alloc) { root = 0; }
+
   NANOSTL_HOST_AND_DEVICE_QUAL
   ~map() { __delete(root); }
 
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  allocator_type get_allocator() const { return this->__alloc(); }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  key_compare key_comp() const { return key_compare(); }
+
   // accessors:
 
   NANOSTL_HOST_AND_DEVICE_QUAL
@@ -178,6 +196,29 @@ class map {
  private:
   Node* root;
 
+  typedef typename Allocator::template rebind<Node>::other __node_allocator;
+  typedef allocator_traits<__node_allocator> __node_traits;
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  Node* __new_node(const value_type& x) {
+    __node_allocator alloc(this->__alloc());
+    Node* n = alloc.allocate(1);
+    __node_traits::construct(alloc, n, x);
+    return n;
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  void __free_node(Node* n) {
+    __node_allocator alloc(this->__alloc());
+    __node_traits::destroy(alloc, n);
+    alloc.deallocate(n, 1);
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  static bool __equal(const key_type& a, const key_type& b) {
+    return !key_compare()(a, b) && !key_compare()(b, a);
+  }
+
   // b: the direction of rotation
   NANOSTL_HOST_AND_DEVICE_QUAL
   Node* __rotate(Node* t, int b) {
@@ -192,14 +233,14 @@ class map {
   NANOSTL_HOST_AND_DEVICE_QUAL
   pair<Node*, pair_iterator_bool> __insert(Node* t, const value_type& x) {
     if (!t) {
-      Node* n = new Node(x);
+      Node* n = __new_node(x);
       return make_pair(n, make_pair(iterator(this, n), true));
     }
     Key key = x.first;
-    if (key == t->key()) {
+    if (__equal(key, t->key())) {
       return make_pair(t, make_pair(iterator(this, t), false));
     }
-    int b = key > t->key();
+    int b = key_compare()(t->key(), key);
     pair<Node*, pair_iterator_bool> p = __insert(t->ch[b], x);
     t->ch[b] = p.first;
     if (t->pri > t->ch[b]->pri) t = __rotate(t, 1 - b);
@@ -208,13 +249,15 @@ class map {
 
   NANOSTL_HOST_AND_DEVICE_QUAL
   Node* __find(Node* t, const key_type& key) const {
-    return (!t || key == t->key()) ? t : __find(t->ch[key > t->key()], key);
+    return (!t || __equal(key, t->key()))
+               ? t
+               : __find(t->ch[key_compare()(t->key(), key)], key);
   }
 
   NANOSTL_HOST_AND_DEVICE_QUAL
   Node* __upper_bound(Node* t, const key_type& key) const {
     if (!t) return 0;
-    if (key < t->key()) {
+    if (key_compare()(key, t->key())) {
       Node* s = __upper_bound(t->ch[0], key);
       return s ? s : t;
     }
@@ -226,7 +269,7 @@ class map {
     if (!t) return;
     __delete(t->ch[0]);
     __delete(t->ch[1]);
-    delete t;
+    __free_node(t);
   }
 
 #ifdef NANOSTL_DEBUG
@@ -0,0 +1,610 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 Light Transport Entertainment, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef NANOSTL_MEMORY_RESOURCE_H_
+#define NANOSTL_MEMORY_RESOURCE_H_
+
+#include "nanocommon.h"
+#include "nanoallocator.h"
+#include "nanoarena.h"
+#include "nanomap.h"
+#include "nanomutex.h"
+#include "nanopool_allocator.h"
+#include "nanostring.h"
+#include "nanovector.h"
+
+//
+// Polymorphic memory resources(like std::pmr).
+//
+// `memory_resource` is an abstract interface; `polymorphic_allocator<T>`
+// holds a pointer to one. Containers using `polymorphic_allocator` have a
+// single type whatever the memory strategy, which is chosen at runtime per
+// container:
+//
+//   nanostl::pmr::monotonic_buffer_resource arena;
+//   nanostl::pmr::unsynchronized_pool_resource pool;
+//
+//   nanostl::pmr::vector<int> a(&arena);  // same type as `b`
+//   nanostl::pmr::vector<int> b(&pool);
+//   nanostl::pmr::vector<int> c;          // get_default_resource()
+//
+// Resources:
+//
+//   - new_delete_resource() : `allocator`(the default resource).
+//   - monotonic_buffer_resource : `monotonic_arena`. deallocate is a no-op.
+//   - unsynchronized_pool_resource : Size class free lists(same classes as
+//     `pool_allocator`) over chunks from an upstream resource. Memory is
+//     returned upstream by release() or the destructor. Not thread-safe.
+//   - synchronized_pool_resource : unsynchronized_pool_resource behind a
+//     mutex(requires src/nanothread.cc unless NANOSTL_NO_THREAD is defined).
+//
+// Resources are not copyable and must outlive the containers using them.
+//
+
+namespace nanostl {
+namespace pmr {
+
+// Default alignment(alignof(max_align_t)).
+static const size_type kDefaultAlign = 16;
+
+class memory_resource {
+ public:
+  virtual ~memory_resource() {}
+
+  ///
+  /// Returns `bytes` of memory aligned to `align`(power of two), or NULL
+  /// when no memory is left.
+  ///
+  void *allocate(size_type bytes, size_type align = kDefaultAlign) {
+    return do_allocate(bytes, align);
+  }
+
+  ///
+  /// Frees memory from `allocate()`. `bytes` and `align` must be the ones
+  /// passed to `allocate()`.
+  ///
+  void deallocate(void *p, size_type bytes, size_type align = kDefaultAlign) {
+    do_deallocate(p, bytes, align);
+  }
+
+  ///
+  /// True when memory allocated from `this` can be freed by `other` and vice
+  /// versa.
+  ///
+  bool is_equal(const memory_resource &other) const {
+    return do_is_equal(other);
+  }
+
+ private:
+  virtual void *do_allocate(size_type bytes, size_type align) = 0;
+  virtual void do_deallocate(void *p, size_type bytes, size_type align) = 0;
+  virtual bool do_is_equal(const memory_resource &other) const = 0;
+};
+
+inline bool operator==(const memory_resource &a, const memory_resource &b) {
+  return (&a == &b) || a.is_equal(b);
+}
+
+inline bool operator!=(const memory_resource &a, const memory_resource &b) {
+  return !(a == b);
+}
+
+namespace __detail {
+
+// Allocation unit of `new_delete_resource`(kDefaultAlign).
+struct alignas(kDefaultAlign) __unit {
+  unsigned char b[16];
+};
+
+// Goes through `allocator`, so the mimalloc backend(NANOSTL_USE_MIMALLOC)
+// and the allocation profiler(NANOSTL_ALLOC_PROFILE) apply.
+class __new_delete_resource : public memory_resource {
+ private:
+  static size_type __units(size_type bytes) {
+    return bytes / sizeof(__unit) + ((bytes % sizeof(__unit)) ? 1 : 0);
+  }
+
+  virtual void *do_allocate(size_type bytes, size_type align) {
+    if (bytes < 1) {
+      bytes = 1;
+    }
+    allocator<__unit> alloc;
+    if (align <= sizeof(__unit)) {
+      return alloc.allocate(__units(bytes));
+    }
+    if (bytes > ~size_type(0) - align) {
+      return 0;
+    }
+    void *base = alloc.allocate(__units(bytes + align));
+    if (!base) {
+      return 0;
+    }
+    return __align_block(base, align);
+  }
+
+  virtual void do_deallocate(void *p, size_type bytes, size_type align) {
+    if (!p) {
+      return;
+    }
+    if (bytes < 1) {
+      bytes = 1;
+    }
+    allocator<__unit> alloc;
+    if (align <= sizeof(__unit)) {
+      alloc.deallocate(static_cast<__unit *>(p), __units(bytes));
+      return;
+    }
+    alloc.deallocate(static_cast<__unit *>(__aligned_block_base(p)),
+                     __units(bytes + align));
+  }
+
+  virtual bool do_is_equal(const memory_resource &other) const {
+    return this == &other;
+  }
+};
+
+inline memory_resource *&__default_resource() {
+  static memory_resource *r = 0;
+  return r;
+}
+
+}  // namespace __detail
+
+///
+/// Resource which allocates through `allocator`(malloc/free, or mimalloc).
+/// Never destroyed, so it can be used by objects with static storage
+/// duration.
+///
+inline memory_resource *new_delete_resource() {
+  static union {
+    char bytes[sizeof(__detail::__new_delete_resource)];
+    void *align;
+  } storage;
+  static memory_resource *r =
+      new (&storage, __placement_tag()) __detail::__new_delete_resource();
+  return r;
+}
+
+///
+/// Resource used by default constructed `polymorphic_allocator`s.
+/// `new_delete_resource()` unless set by `set_default_resource()`.
+///
+inline memory_resource *get_default_resource() {
+  memory_resource *r = __detail::__default_resource();
+  return r ? r : new_delete_resource();
+}
+
+///
+/// Sets the default resource(`new_delete_resource()` if `r` is null) and
+/// returns the previous one. Not synchronized: set it before starting
+/// threads which use the default resource.
+///
+inline memory_resource *set_default_resource(memory_resource *r) {
+  memory_resource *prev = get_default_resource();
+  __detail::__default_resource() = r;
+  return prev;
+}
+
+///
+/// Bump pointer resource on top of `monotonic_arena`. Memory is freed all
+/// at once by `release()` or the destructor.
+///
+class monotonic_buffer_resource : public memory_resource {
+ public:
+  explicit monotonic_buffer_resource(
+      size_type initial_size = monotonic_arena::kDefaultBlockSize)
+      : arena_(initial_size) {}
+
+  ///
+  /// Allocates from `buffer` first. `buffer` must outlive the resource.
+  ///
+  monotonic_buffer_resource(void *buffer, size_type size)
+      : arena_(buffer, size) {}
+
+  void release() { arena_.release(); }
+
+  // For statistics(bytes_allocated() etc.) and `reset()`.
+  monotonic_arena &arena() { return arena_; }
+  const monotonic_arena &arena() const { return arena_; }
+
+ private:
+  monotonic_buffer_resource(const monotonic_buffer_resource &);
+  monotonic_buffer_resource &operator=(const monotonic_buffer_resource &);
+
+  virtual void *do_allocate(size_type bytes, size_type align) {
+    return arena_.allocate(bytes, align);
+  }
+
+  virtual void do_deallocate(void *p, size_type bytes, size_type align) {
+    (void)align;
+    arena_.deallocate(p, bytes);
+  }
+
+  virtual bool do_is_equal(const memory_resource &other) const {
+    return this == &other;
+  }
+
+  monotonic_arena arena_;
+};
+
+struct pool_options {
+  // Upper limit of blocks in a chunk taken from upstream. 0: default(1024).
+  size_type max_blocks_per_chunk;
+
+  // Larger requests go directly to upstream. 0: default(kPoolMaxSize).
+  // Values above kPoolMaxSize are reduced to it.
+  size_type largest_required_pool_block;
+
+  pool_options() : max_blocks_per_chunk(0), largest_required_pool_block(0) {}
+};
+
+///
+/// Pool resource with a free list per size class. Chunks for the pools are
+/// allocated from `upstream`, growing 2x per class up to
+/// `max_blocks_per_chunk` blocks. Requests larger than
+/// `largest_required_pool_block` or aligned to more than kPoolAlign go to
+/// `upstream` directly. `release()`(or the destructor) returns everything to
+/// `upstream`, including outstanding blocks.
+///
+/// Not thread-safe, see `synchronized_pool_resource`.
+///
+class unsynchronized_pool_resource : public memory_resource {
+ public:
+  explicit unsynchronized_pool_resource(
+      memory_resource *upstream = get_default_resource()) {
+    __init(pool_options(), upstream);
+  }
+
+  unsynchronized_pool_resource(const pool_options &opts,
+                               memory_resource *upstream =
+                                   get_default_resource()) {
+    __init(opts, upstream);
+  }
+
+  virtual ~unsynchronized_pool_resource() { release(); }
+
+  void release() {
+    while (chunks_) {
+      __chunk *next = chunks_->next;
+      upstream_->deallocate(chunks_, chunks_->bytes, kPoolAlign);
+      chunks_ = next;
+    }
+    while (large_) {
+      __large *next = large_->next;
+      upstream_->deallocate(
+          reinterpret_cast<char *>(large_ + 1) - large_->offset,
+          large_->bytes, large_->align);
+      large_ = next;
+    }
+    for (unsigned c = 0; c < kPoolNumClasses; c++) {
+      pools_[c].free = 0;
+      pools_[c].cur = 0;
+      pools_[c].end = 0;
+      pools_[c].next_blocks = 0;
+    }
+  }
+
+  memory_resource *upstream_resource() const { return upstream_; }
+
+  pool_options options() const { return options_; }
+
+ private:
+  unsynchronized_pool_resource(const unsynchronized_pool_resource &);
+  unsynchronized_pool_resource &operator=(const unsynchronized_pool_resource &);
+
+  struct __free_block {
+    __free_block *next;
+  };
+
+  // Header of a chunk(kPoolAlign bytes), blocks follow.
+  struct __chunk {
+    __chunk *next;
+    size_type bytes;
+  };
+
+  // Header just before a block from upstream(doubly linked so deallocate is
+  // O(1)).
+  struct __large {
+    __large *prev;
+    __large *next;
+    size_type bytes;   // of the upstream allocation
+    size_type align;   // of the upstream allocation
+    size_type offset;  // from the upstream allocation to the block
+    size_type pad;
+  };
+
+  struct __pool {
+    __free_block *free;
+    char *cur;  // unused part of the newest chunk
+    char *end;
+    size_type next_blocks;  // blocks of the next chunk(0: not started)
+  };
+
+  void __init(const pool_options &opts, memory_resource *upstream) {
+    upstream_ = upstream ? upstream : get_default_resource();
+    options_ = opts;
+    if (options_.max_blocks_per_chunk == 0) {
+      options_.max_blocks_per_chunk = 1024;
+    }
+    if ((options_.largest_required_pool_block == 0) ||
+        (options_.largest_required_pool_block > kPoolMaxSize)) {
+      options_.largest_required_pool_block = kPoolMaxSize;
+    }
+    // Round up to the size of its class.
+    options_.largest_required_pool_block = __pool_class_size(
+        __pool_size_class(options_.largest_required_pool_block));
+    chunks_ = 0;
+    large_ = 0;
+    for (unsigned c = 0; c < kPoolNumClasses; c++) {
+      pools_[c].free = 0;
+      pools_[c].cur = 0;
+      pools_[c].end = 0;
+      pools_[c].next_blocks = 0;
+    }
+  }
+
+  bool __pooled(size_type bytes, size_type align) const {
+    return (bytes <= options_.largest_required_pool_block) &&
+           (align <= kPoolAlign);
+  }
+
+  void *__refill(unsigned c) {
+    __pool &pl = pools_[c];
+    const size_type size = __pool_class_size(c);
+    if (pl.cur == pl.end) {
+      // First chunk is about 1 KB(at least 4 blocks), then 2x.
+      size_type blocks = pl.next_blocks;
+      if (blocks == 0) {
+        blocks = (size < 256) ? 1024 / size : 4;
+      }
+      if (blocks > options_.max_blocks_per_chunk) {
+        blocks = options_.max_blocks_per_chunk;
+      }
+
+      const size_type bytes = kPoolAlign + blocks * size;
+      __chunk *ch =
+          static_cast<__chunk *>(upstream_->allocate(bytes, kPoolAlign));
+      if (!ch) {
+        return 0;
+      }
+      pl.next_blocks = blocks * 2;
+      ch->next = chunks_;
+      ch->bytes = bytes;
+      chunks_ = ch;
+      pl.cur = reinterpret_cast<char *>(ch) + kPoolAlign;
+      pl.end = pl.cur + blocks * size;
+    }
+    void *p = pl.cur;
+    pl.cur += size;
+    return p;
+  }
+
+  void *__allocate_large(size_type bytes, size_type align) {
+    if (align < kPoolAlign) {
+      align = kPoolAlign;
+    }
+    const size_type offset = (sizeof(__large) + align - 1) & ~(align - 1);
+    if (bytes > ~size_type(0) - offset) {
+      return 0;
+    }
+    char *base = static_cast<char *>(upstream_->allocate(offset + bytes, align));
+    if (!base) {
+      return 0;
+    }
+    __large *h = reinterpret_cast<__large *>(base + offset) - 1;
+    h->prev = 0;
+    h->next = large_;
+    h->bytes = offset + bytes;
+    h->align = align;
+    h->offset = offset;
+    if (large_) {
+      large_->prev = h;
+    }
+    large_ = h;
+    return base + offset;
+  }
+
+  void __deallocate_large(void *p) {
+    __large *h = static_cast<__large *>(p) - 1;
+    if (h->prev) {
+      h->prev->next = h->next;
+    } else {
+      large_ = h->next;
+    }
+    if (h->next) {
+      h->next->prev = h->prev;
+    }
+    upstream_->deallocate(static_cast<char *>(p) - h->offset, h->bytes,
+                          h->align);
+  }
+
+  virtual void *do_allocate(size_type bytes, size_type align) {
+    if (!__pooled(bytes, align)) {
+      return __allocate_large(bytes, align);
+    }
+    const unsigned c = __pool_size_class(bytes ? bytes : 1);
+    __free_block *b = pools_[c].free;
+    if (b) {
+      pools_[c].free = b->next;
+      return b;
+    }
+    return __refill(c);
+  }
+
+  virtual void do_deallocate(void *p, size_type bytes, size_type align) {
+    if (!p) {
+      return;
+    }
+    if (!__pooled(bytes, align)) {
+      __deallocate_large(p);
+      return;
+    }
+    const unsigned c = __pool_size_class(bytes ? bytes : 1);
+    __free_block *b = static_cast<__free_block *>(p);
+    b->next = pools_[c].free;
+    pools_[c].free = b;
+  }
+
+  virtual bool do_is_equal(const memory_resource &other) const {
+    return this == &other;
+  }
+
+  memory_resource *upstream_;
+  pool_options options_;
+  __chunk *chunks_;
+  __large *large_;
+  __pool pools_[kPoolNumClasses];
+};
+
+///
+/// `unsynchronized_pool_resource` guarded by a mutex. Can be shared by
+/// threads.
+///
+class synchronized_pool_resource : public memory_resource {
+ public:
+  explicit synchronized_pool_resource(
+      memory_resource *upstream = get_default_resource())
+      : pool_(upstream) {}
+
+  synchronized_pool_resource(const pool_options &opts,
+                             memory_resource *upstream =
+                                 get_default_resource())
+      : pool_(opts, upstream) {}
+
+  void release() {
+#if !defined(NANOSTL_NO_THREAD)
+    lock_guard<mutex> guard(lock_);
+#endif
+    pool_.release();
+  }
+
+  memory_resource *upstream_resource() const {
+    return pool_.upstream_resource();
+  }
+
+  pool_options options() const { return pool_.options(); }
+
+ private:
+  synchronized_pool_resource(const synchronized_pool_resource &);
+  synchronized_pool_resource &operator=(const synchronized_pool_resource &);
+
+  virtual void *do_allocate(size_type bytes, size_type align) {
+#if !defined(NANOSTL_NO_THREAD)
+    lock_guard<mutex> guard(lock_);
+#endif
+    return pool_.allocate(bytes, align);
+  }
+
+  virtual void do_deallocate(void *p, size_type bytes, size_type align) {
+#if !defined(NANOSTL_NO_THREAD)
+    lock_guard<mutex> guard(lock_);
+#endif
+    pool_.deallocate(p, bytes, align);
+  }
+
+  virtual bool do_is_equal(const memory_resource &other) const {
+    return this == &other;
+  }
+
+  unsynchronized_pool_resource pool_;
+#if !defined(NANOSTL_NO_THREAD)
+  mutex lock_;
+#endif
+};
+
+///
+/// Allocator which allocates from a `memory_resource`. Like `allocator`, it
+/// returns raw storage.
+///
+template <typename T>
+class polymorphic_allocator {
+ public:
+  typedef T value_type;
+  typedef T *pointer;
+  typedef const T *const_pointer;
+  typedef T &reference;
+  typedef const T &const_reference;
+
+  template <class U>
+  struct rebind {
+    typedef polymorphic_allocator<U> other;
+  };
+
+  polymorphic_allocator() : resource_(get_default_resource()) {}
+
+  // Implicit, so that `pmr::vector<int> v(&pool)` works.
+  polymorphic_allocator(memory_resource *r)
+      : resource_(r ? r : get_default_resource()) {}
+
+  template <class U>
+  polymorphic_allocator(const polymorphic_allocator<U> &rhs)
+      : resource_(rhs.resource()) {}
+
+  T *allocate(size_type n, const void *hint = 0) {
+    (void)hint;
+    if (n < 1) {
+      return 0;
+    }
+    return static_cast<T *>(resource_->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T *p, size_type n) {
+    if (!p) {
+      return;
+    }
+    resource_->deallocate(p, n * sizeof(T), alignof(T));
+  }
+
+  memory_resource *resource() const { return resource_; }
+
+ private:
+  memory_resource *resource_;
+};
+
+template <typename T, typename U>
+inline bool operator==(const polymorphic_allocator<T> &a,
+                       const polymorphic_allocator<U> &b) {
+  return *a.resource() == *b.resource();
+}
+
+template <typename T, typename U>
+inline bool operator!=(const polymorphic_allocator<T> &a,
+                       const polymorphic_allocator<U> &b) {
+  return !(a == b);
+}
+
+template <class T>
+using vector = nanostl::vector<T, polymorphic_allocator<T> >;
+
+typedef nanostl::basic_string<char, polymorphic_allocator<char> > string;
+
+template <class Key, class T, class Compare = nanostl::less<Key> >
+using map = nanostl::map<Key, T, Compare,
+                         polymorphic_allocator<nanostl::pair<const Key, T> > >;
+
+}  // namespace pmr
+}  // namespace nanostl
+
+#endif  // NANOSTL_MEMORY_RESOURCE_H_
@@ -29,8 +29,42 @@
 
 namespace nanostl {
 
+///
+/// Non-recursive mutex. Implemented on top of libs_thread(src/nanothread.cc),
+/// so you need to compile and link src/nanothread.cc.
+///
 class mutex {
+ public:
+  mutex();
+  ~mutex();
 
+  void lock();
+  void unlock();
+
+ private:
+  mutex(const mutex &);
+  mutex &operator=(const mutex &);
+
+  // Opaque storage for `thread_mutex_t`
+  union {
+    void *align_;
+    char data_[64];
+  } storage_;
+};
+
+template <class Mutex>
+class lock_guard {
+ public:
+  typedef Mutex mutex_type;
+
+  explicit lock_guard(mutex_type &m) : m_(m) { m_.lock(); }
+  ~lock_guard() { m_.unlock(); }
+
+ private:
+  lock_guard(const lock_guard &);
+  lock_guard &operator=(const lock_guard &);
+
+  mutex_type &m_;
 };
 
 } // namespace nanostl
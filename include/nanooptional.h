@@ -9,4 +9,9 @@ using nonstd::optional;
 
 } // nanostl
 
-#endif // NANOSTL_ANY_H_
+// `hash_append` for optional lives in nanohash_append.h.
+#if defined(NANOSTL_HASH_APPEND_H_)
+#include "nanohash_append.h"
+#endif
+
+#endif // NANOSTL_OPTIONAL_H_
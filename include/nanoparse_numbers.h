@@ -0,0 +1,103 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 Light Transport Entertainment, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef NANOSTL_PARSE_NUMBERS_H_
+#define NANOSTL_PARSE_NUMBERS_H_
+
+#include "nanocommon.h"
+#include "nanosystem_error.h"
+#include "nanovector.h"
+
+//
+// Bulk number parsing: text buffer -> vector<float>/vector<double>/vector<int>.
+//
+//   nanostl::vector<float> values;
+//   nanostl::parse_numbers_result ret =
+//       nanostl::parse_numbers(buf, buf + len, values);
+//   if (ret.ec != nanostl::errc()) {
+//     // bad token at `ret.ptr`(line `ret.line`)
+//   }
+//
+// Tokens are maximal runs of non-separator chars and each token must be a
+// complete number(same syntax as `from_chars`, plus an optional leading '+').
+// Parsed values are appended to `out`. Nothing is allocated per token: the
+// separator set is prepared once(SIMD scan, see __nanostrsearch.h), values go
+// through a small local block and are appended with one resize per block.
+//
+// On error, values before the bad token stay appended, `ptr` points to the
+// start of the bad token and `ec` is `errc::invalid_argument`(not a number) or
+// `errc::result_out_of_range`(does not fit in the value type).
+//
+// With `num_threads != 1`, the buffer is split at separators into chunks of
+// at least `min_chunk_bytes` which are parsed in parallel and appended in
+// order. The result is identical to the serial one.
+//
+// Implementation is in src/nanoparse_numbers.cc(requires src/nanocharconv.cc
+// and src/nanothread.cc).
+//
+
+namespace nanostl {
+
+struct parse_numbers_options {
+  // '\0' terminated set of separator chars.
+  const char *separators;
+
+  // 1: parse on the calling thread. 0: use hardware concurrency.
+  unsigned num_threads;
+
+  // Minimum bytes per thread.
+  unsigned long long min_chunk_bytes;
+
+  parse_numbers_options()
+      : separators(" \t\r\n,"), num_threads(1), min_chunk_bytes(1 << 20) {}
+};
+
+struct parse_numbers_result {
+  // `last` on success. Start of the bad token on error.
+  const char *ptr;
+  errc ec;
+
+  // Number of values appended to `out`.
+  unsigned long long count;
+
+  // 1-based line number of `ptr`(only computed on error, 0 on success).
+  unsigned long long line;
+};
+
+parse_numbers_result parse_numbers(
+    const char *first, const char *last, vector<float> &out,
+    const parse_numbers_options &options = parse_numbers_options());
+
+parse_numbers_result parse_numbers(
+    const char *first, const char *last, vector<double> &out,
+    const parse_numbers_options &options = parse_numbers_options());
+
+parse_numbers_result parse_numbers(
+    const char *first, const char *last, vector<int> &out,
+    const parse_numbers_options &options = parse_numbers_options());
+
+}  // namespace nanostl
+
+#endif  // NANOSTL_PARSE_NUMBERS_H_
@@ -0,0 +1,175 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 Light Transport Entertainment, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef NANOSTL_POOL_ALLOCATOR_H_
+#define NANOSTL_POOL_ALLOCATOR_H_
+
+#include "nanocommon.h"
+#include "nanoallocator.h"
+
+//
+// Size class pool allocator with per-thread caches.
+//
+// Requests up to `kPoolMaxSize` bytes are rounded up to one of
+// `kPoolNumClasses` size classes(16 byte steps up to 128, then four classes
+// per power of two). Each thread keeps a free list per class and allocates
+// and frees without locking. When a thread's list is empty it takes a whole
+// magazine(a batch of blocks) from the shared central pool; when it holds
+// two magazines' worth it gives one back. Only those transfers lock, one
+// mutex per class.
+//
+// Larger requests go to `allocator`(malloc/free, or mimalloc when
+// NANOSTL_USE_MIMALLOC is defined).
+//
+//   nanostl::vector<int, nanostl::pool_allocator<int> > v;
+//
+// Memory of the central pool is reused but never returned to the system.
+// Blocks may be freed by another thread than the one which allocated them.
+// A thread's cache is given back to the central pool when the thread exits.
+//
+// Implementation is in src/nanopool_allocator.cc(also requires
+// src/nanothread.cc unless NANOSTL_NO_THREAD is defined).
+//
+
+namespace nanostl {
+
+static const size_type kPoolMaxSize = 4096;
+static const unsigned kPoolNumClasses = 28;
+
+// Blocks are aligned to this.
+static const size_type kPoolAlign = 16;
+
+///
+/// Returns a block of at least `bytes`(1 <= bytes <= kPoolMaxSize), or NULL
+/// when no memory is left.
+///
+void *__pool_allocate(size_type bytes);
+
+///
+/// Frees a block from `__pool_allocate`. `bytes` must be the requested
+/// size(any size in the same class works).
+///
+void __pool_deallocate(void *p, size_type bytes);
+
+struct pool_stats {
+  size_type reserved_bytes;     // memory taken from the system
+  size_type central_magazines;  // full magazines in the central pool
+};
+
+pool_stats get_pool_stats();
+
+///
+/// Returns the size class of `bytes`(1 <= bytes <= kPoolMaxSize).
+///
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline unsigned __pool_size_class(size_type bytes) {
+  if (bytes <= 128) {
+    return unsigned((bytes + 15) / 16) - 1;
+  }
+  const size_type s = bytes - 1;
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(__CUDACC__)
+  const unsigned lg = 63 - unsigned(__builtin_clzll(s));
+#else
+  unsigned lg = 7;
+  while ((s >> (lg + 1)) != 0) {
+    lg++;
+  }
+#endif
+  return 8 + (lg - 7) * 4 + unsigned((s >> (lg - 2)) & 3);
+}
+
+///
+/// Block size of size class `c`.
+///
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline size_type __pool_class_size(unsigned c) {
+  if (c < 8) {
+    return (c + 1) * 16;
+  }
+  const unsigned lg = 7 + (c - 8) / 4;
+  return (size_type(1) << lg) + ((c - 8) % 4 + 1) * (size_type(1) << (lg - 2));
+}
+
+///
+/// Stateless allocator on top of the pool. Like `allocator`, it returns raw
+/// storage.
+///
+template <typename T>
+class pool_allocator {
+ public:
+  typedef T value_type;
+  typedef T *pointer;
+  typedef const T *const_pointer;
+  typedef T &reference;
+  typedef const T &const_reference;
+
+  template <class U>
+  struct rebind {
+    typedef pool_allocator<U> other;
+  };
+
+  pool_allocator() {}
+
+  template <class U>
+  pool_allocator(const pool_allocator<U> &) {}
+
+  T *allocate(size_type n, const void *hint = 0) {
+    (void)hint;
+    if (n < 1) {
+      return 0;
+    }
+    const size_type bytes = n * sizeof(T);
+    if ((bytes > kPoolMaxSize) || (alignof(T) > kPoolAlign)) {
+      return allocator<T>().allocate(n);
+    }
+    return static_cast<T *>(__pool_allocate(bytes));
+  }
+
+  void deallocate(T *p, size_type n) {
+    if (!p) {
+      return;
+    }
+    const size_type bytes = n * sizeof(T);
+    if ((bytes > kPoolMaxSize) || (alignof(T) > kPoolAlign)) {
+      allocator<T>().deallocate(p, n);
+      return;
+    }
+    __pool_deallocate(p, bytes);
+  }
+};
+
+template <typename T, typename U>
+inline bool operator==(const pool_allocator<T> &, const pool_allocator<U> &) {
+  return true;
+}
+
+template <typename T, typename U>
+inline bool operator!=(const pool_allocator<T> &, const pool_allocator<U> &) {
+  return false;
+}
+
+}  // namespace nanostl
+
+#endif  // NANOSTL_POOL_ALLOCATOR_H_
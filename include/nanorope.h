@@ -0,0 +1,651 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 Light Transport Entertainment, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef NANOSTL_ROPE_H_
+#define NANOSTL_ROPE_H_
+
+#include "nanocommon.h"
+#include "nanocstdint.h"
+#include "nanocstring.h"
+#include "nanoallocator.h"
+#include "nanostring.h"
+#include "nanostring_view.h"
+
+//
+// Rope(a.k.a. cord) for building large text incrementally.
+//
+// The text is stored in leaves of at most `kMaxLeaf` chars, joined by an
+// AVL balanced tree. Nodes are immutable and reference counted, so copying a
+// rope is O(1) and copies share their chunks.
+//
+//   append/insert/erase/substr/concat : O(log n) nodes touched
+//   operator[]                        : O(log n)
+//   str()                             : O(n), the only place text is flattened
+//
+// Appending short pieces to a rope which does not share its right edge with
+// another copy is done in place in the last leaf(no allocation).
+//
+// Reference counts are atomic, so copies of a rope may be used and destroyed
+// from different threads. As with `basic_string`, a single rope object must
+// not be modified concurrently.
+//
+// Host only(not usable in CUDA device code).
+//
+
+#if defined(_MSC_VER) && !defined(__clang__) && !defined(NANOSTL_NO_THREAD)
+extern "C" long _InterlockedIncrement(long volatile *);
+extern "C" long _InterlockedDecrement(long volatile *);
+#pragma intrinsic(_InterlockedIncrement)
+#pragma intrinsic(_InterlockedDecrement)
+#endif
+
+namespace nanostl {
+
+inline void __rope_ref_inc(long *p) {
+#if defined(NANOSTL_NO_THREAD)
+  (*p)++;
+#elif defined(__GNUC__) || defined(__clang__)
+  __atomic_fetch_add(p, 1, __ATOMIC_RELAXED);
+#elif defined(_MSC_VER)
+  _InterlockedIncrement(p);
+#else
+  (*p)++;
+#endif
+}
+
+// Returns the new count.
+inline long __rope_ref_dec(long *p) {
+#if defined(NANOSTL_NO_THREAD)
+  return --(*p);
+#elif defined(__GNUC__) || defined(__clang__)
+  return __atomic_sub_fetch(p, 1, __ATOMIC_ACQ_REL);
+#elif defined(_MSC_VER)
+  return _InterlockedDecrement(p);
+#else
+  return --(*p);
+#endif
+}
+
+inline bool __rope_ref_unique(const long *p) {
+#if defined(NANOSTL_NO_THREAD)
+  return (*p) == 1;
+#elif defined(__GNUC__) || defined(__clang__)
+  return __atomic_load_n(p, __ATOMIC_ACQUIRE) == 1;
+#else
+  return (*static_cast<const volatile long *>(p)) == 1;
+#endif
+}
+
+// Leaf(height 0): chars follow the node. Concat node: `left` and `right`.
+template <class charT>
+struct __rope_node {
+  long refs;
+  int height;
+  unsigned long long size;
+  unsigned long long capacity;  // leaf only
+  __rope_node *left;
+  __rope_node *right;
+
+  charT *chars() { return reinterpret_cast<charT *>(this + 1); }
+  const charT *chars() const {
+    return reinterpret_cast<const charT *>(this + 1);
+  }
+};
+
+template <class charT>
+class basic_rope {
+ public:
+  typedef unsigned long long size_type;
+  typedef charT value_type;
+
+  static const size_type npos = ~size_type(0);
+
+  // Leaves are at most this many chars.
+  static const size_type kMaxLeaf = 1024;
+
+  basic_rope() : root_(0) {}
+
+  basic_rope(const charT *s) : root_(__build(s, __strlen(s))) {}
+
+  basic_rope(const charT *s, size_type n) : root_(__build(s, n)) {}
+
+  explicit basic_rope(basic_string_view<charT> v)
+      : root_(__build(v.data(), v.size())) {}
+
+  basic_rope(const basic_rope &rhs) : root_(rhs.root_) { __retain(root_); }
+
+  basic_rope(basic_rope &&rhs) : root_(rhs.root_) { rhs.root_ = 0; }
+
+  ~basic_rope() { __release(root_); }
+
+  basic_rope &operator=(const basic_rope &rhs) {
+    __retain(rhs.root_);
+    __release(root_);
+    root_ = rhs.root_;
+    return *this;
+  }
+
+  basic_rope &operator=(basic_rope &&rhs) {
+    if (this != &rhs) {
+      __release(root_);
+      root_ = rhs.root_;
+      rhs.root_ = 0;
+    }
+    return *this;
+  }
+
+  size_type size() const { return root_ ? root_->size : 0; }
+  size_type length() const { return size(); }
+  bool empty() const { return size() == 0; }
+
+  // Tree height(0 for a single leaf). For diagnostics.
+  int depth() const { return root_ ? root_->height : 0; }
+
+  void clear() {
+    __release(root_);
+    root_ = 0;
+  }
+
+  void swap(basic_rope &rhs) {
+    __node *tmp = root_;
+    root_ = rhs.root_;
+    rhs.root_ = tmp;
+  }
+
+  charT operator[](size_type pos) const { return at(pos); }
+
+  charT at(size_type pos) const {
+    const __node *n = root_;
+    while (n->height > 0) {
+      if (pos < n->left->size) {
+        n = n->left;
+      } else {
+        pos -= n->left->size;
+        n = n->right;
+      }
+    }
+    return n->chars()[pos];
+  }
+
+  basic_rope &append(const charT *s, size_type n) {
+    if (n == 0) {
+      return *this;
+    }
+    if (!__append_in_place(root_, s, n)) {
+      // Short pieces start a full size leaf so that the following appends
+      // go in place.
+      __node *x = (n < kMaxLeaf) ? __leaf(s, n, kMaxLeaf) : __build(s, n);
+      root_ = __join(root_, x);
+    }
+    return *this;
+  }
+
+  basic_rope &append(basic_string_view<charT> v) {
+    return append(v.data(), v.size());
+  }
+
+  basic_rope &append(const basic_rope &r) {
+    __node *n = r.root_;
+    __retain(n);
+    root_ = __join(root_, n);
+    return *this;
+  }
+
+  void push_back(charT c) { append(&c, 1); }
+
+  basic_rope &operator+=(const basic_rope &r) { return append(r); }
+  basic_rope &operator+=(basic_string_view<charT> v) { return append(v); }
+  basic_rope &operator+=(const charT *s) { return append(s, __strlen(s)); }
+  basic_rope &operator+=(charT c) { return append(&c, 1); }
+
+  ///
+  /// Inserts `r` before `pos`. `pos` is clamped to `size()`.
+  ///
+  basic_rope &insert(size_type pos, const basic_rope &r) {
+    __node *n = r.root_;
+    __retain(n);
+    __insert(pos, n);
+    return *this;
+  }
+
+  basic_rope &insert(size_type pos, basic_string_view<charT> v) {
+    __insert(pos, __build(v.data(), v.size()));
+    return *this;
+  }
+
+  ///
+  /// Removes `[pos, pos + count)`(clamped to `size()`).
+  ///
+  basic_rope &erase(size_type pos = 0, size_type count = npos) {
+    const size_type sz = size();
+    if (pos >= sz) {
+      return *this;
+    }
+    if (count > sz - pos) {
+      count = sz - pos;
+    }
+    __node *head, *rest, *mid, *tail;
+    __split(root_, pos, &head, &rest);
+    __split(rest, count, &mid, &tail);
+    __release(rest);
+    __release(mid);
+    __release(root_);
+    root_ = __join(head, tail);
+    return *this;
+  }
+
+  ///
+  /// Returns `[pos, pos + count)`(clamped to `size()`). Shares chunks with
+  /// this rope except at the two ends.
+  ///
+  basic_rope substr(size_type pos = 0, size_type count = npos) const {
+    const size_type sz = size();
+    basic_rope r;
+    if (pos >= sz) {
+      return r;
+    }
+    if (count > sz - pos) {
+      count = sz - pos;
+    }
+    r.root_ = __sub(root_, pos, pos + count);
+    return r;
+  }
+
+  ///
+  /// Calls `f(basic_string_view<charT>)` for each chunk in order.
+  ///
+  template <class F>
+  void for_each_chunk(F f) const {
+    if (root_) {
+      __for_each(root_, f);
+    }
+  }
+
+  ///
+  /// Copies `[pos, pos + count)` to `dst`. Returns the number of chars
+  /// copied.
+  ///
+  size_type copy(charT *dst, size_type count, size_type pos = 0) const {
+    const size_type sz = size();
+    if (pos >= sz) {
+      return 0;
+    }
+    if (count > sz - pos) {
+      count = sz - pos;
+    }
+    __copy(root_, pos, pos + count, dst);
+    return count;
+  }
+
+  ///
+  /// Flattens to a contiguous string.
+  ///
+  basic_string<charT> str() const {
+    basic_string<charT> s;
+    s.resize(size());
+    if (root_) {
+      __copy(root_, 0, root_->size, &s[0]);
+    }
+    return s;
+  }
+
+ private:
+  typedef __rope_node<charT> __node;
+
+  static size_type __strlen(const charT *s) {
+    size_type n = 0;
+    while (s[n] != charT(0)) {
+      n++;
+    }
+    return n;
+  }
+
+  static unsigned long long __words(size_type capacity) {
+    return (sizeof(__node) + capacity * sizeof(charT) + sizeof(uint64_t) - 1) /
+           sizeof(uint64_t);
+  }
+
+  static __node *__alloc(size_type capacity) {
+    allocator<uint64_t> alloc;
+    __node *n = reinterpret_cast<__node *>(alloc.allocate(__words(capacity)));
+    n->refs = 1;
+    n->capacity = capacity;
+    return n;
+  }
+
+  static void __retain(__node *n) {
+    if (n) {
+      __rope_ref_inc(&n->refs);
+    }
+  }
+
+  static void __release(__node *n) {
+    if (n && (__rope_ref_dec(&n->refs) == 0)) {
+      if (n->height > 0) {
+        __release(n->left);
+        __release(n->right);
+      }
+      allocator<uint64_t> alloc;
+      alloc.deallocate(reinterpret_cast<uint64_t *>(n), __words(n->capacity));
+    }
+  }
+
+  static __node *__leaf(const charT *s, size_type n, size_type capacity) {
+    __node *leaf = __alloc(capacity);
+    leaf->height = 0;
+    leaf->size = n;
+    leaf->left = 0;
+    leaf->right = 0;
+    if (n) {
+      memcpy(leaf->chars(), s, n * sizeof(charT));
+    }
+    return leaf;
+  }
+
+  // Takes ownership of `l` and `r`.
+  static __node *__concat(__node *l, __node *r) {
+    __node *n = __alloc(0);
+    n->height = 1 + ((l->height > r->height) ? l->height : r->height);
+    n->size = l->size + r->size;
+    n->left = l;
+    n->right = r;
+    return n;
+  }
+
+  // Gives up the reference to `n` and returns owned references to its
+  // children.
+  static void __unpack(__node *n, __node **l, __node **r) {
+    (*l) = n->left;
+    (*r) = n->right;
+    __retain(*l);
+    __retain(*r);
+    __release(n);
+  }
+
+  // Balanced tree for `[s, s + n)` with leaves filled up to kMaxLeaf.
+  static __node *__build(const charT *s, size_type n) {
+    if (n == 0) {
+      return 0;
+    }
+    if (n <= kMaxLeaf) {
+      return __leaf(s, n, n);
+    }
+    size_type half = n / 2;
+    return __concat(__build(s, half), __build(s + half, n - half));
+  }
+
+  static int __height(const __node *n) { return n->height; }
+
+  // Concat of two AVL trees whose heights differ by at most 2.
+  // Takes ownership of `a` and `b`.
+  static __node *__balance(__node *a, __node *b) {
+    if (__height(b) > __height(a) + 1) {
+      __node *bl, *br;
+      __unpack(b, &bl, &br);
+      if (__height(bl) <= __height(br)) {
+        return __concat(__concat(a, bl), br);
+      }
+      __node *bll, *blr;
+      __unpack(bl, &bll, &blr);
+      return __concat(__concat(a, bll), __concat(blr, br));
+    }
+    if (__height(a) > __height(b) + 1) {
+      __node *al, *ar;
+      __unpack(a, &al, &ar);
+      if (__height(ar) <= __height(al)) {
+        return __concat(al, __concat(ar, b));
+      }
+      __node *arl, *arr;
+      __unpack(ar, &arl, &arr);
+      return __concat(__concat(al, arl), __concat(arr, b));
+    }
+    return __concat(a, b);
+  }
+
+  static const __node *__rightmost(const __node *n) {
+    while (n->height > 0) {
+      n = n->right;
+    }
+    return n;
+  }
+
+  static const __node *__leftmost(const __node *n) {
+    while (n->height > 0) {
+      n = n->left;
+    }
+    return n;
+  }
+
+  // Two leaves which fit in one. Takes ownership of `l` and `r`.
+  static __node *__merge_leaves(__node *l, __node *r) {
+    const size_type total = l->size + r->size;
+    if (__rope_ref_unique(&l->refs) && (l->capacity >= total)) {
+      memcpy(l->chars() + l->size, r->chars(), r->size * sizeof(charT));
+      l->size = total;
+      __release(r);
+      return l;
+    }
+    if (__rope_ref_unique(&r->refs) && (r->capacity >= total)) {
+      charT *c = r->chars();
+      for (size_type i = r->size; i > 0; i--) {
+        c[l->size + i - 1] = c[i - 1];
+      }
+      memcpy(r->chars(), l->chars(), l->size * sizeof(charT));
+      r->size = total;
+      __release(l);
+      return r;
+    }
+    // Leave room so that repeated small appends are amortized O(1).
+    size_type capacity = total * 2;
+    if (capacity > kMaxLeaf) {
+      capacity = kMaxLeaf;
+    }
+    __node *n = __leaf(l->chars(), l->size, capacity);
+    memcpy(n->chars() + l->size, r->chars(), r->size * sizeof(charT));
+    n->size = total;
+    __release(l);
+    __release(r);
+    return n;
+  }
+
+  // AVL join. Takes ownership of `l` and `r`. Short leaves at the seam are
+  // merged so that building text piece by piece does not create tiny leaves.
+  static __node *__join(__node *l, __node *r) {
+    if (!l) {
+      return r;
+    }
+    if (!r) {
+      return l;
+    }
+
+    const bool l_leaf = (l->height == 0);
+    const bool r_leaf = (r->height == 0);
+    if (l_leaf && r_leaf && (l->size + r->size <= kMaxLeaf)) {
+      return __merge_leaves(l, r);
+    }
+
+    if ((__height(l) > __height(r) + 1) ||
+        (r_leaf && !l_leaf &&
+         (__rightmost(l)->size + r->size <= kMaxLeaf))) {
+      __node *a, *b;
+      __unpack(l, &a, &b);
+      return __balance(a, __join(b, r));
+    }
+
+    if ((__height(r) > __height(l) + 1) ||
+        (l_leaf && !r_leaf && (__leftmost(r)->size + l->size <= kMaxLeaf))) {
+      __node *a, *b;
+      __unpack(r, &a, &b);
+      return __balance(__join(l, a), b);
+    }
+
+    return __concat(l, r);
+  }
+
+  // Appends to the last leaf when the whole right edge is owned by this rope
+  // only and the leaf has room. Heights do not change.
+  static bool __append_in_place(__node *root, const charT *s, size_type n) {
+    __node *path[128];
+    int depth = 0;
+    __node *p = root;
+    while (p) {
+      if (!__rope_ref_unique(&p->refs) || (depth >= 128)) {
+        return false;
+      }
+      path[depth++] = p;
+      if (p->height == 0) {
+        break;
+      }
+      p = p->right;
+    }
+    if (!p || (p->capacity - p->size < n)) {
+      return false;
+    }
+    memcpy(p->chars() + p->size, s, n * sizeof(charT));
+    for (int i = 0; i < depth; i++) {
+      path[i]->size += n;
+    }
+    return true;
+  }
+
+  // Splits `n`(borrowed) at `pos` into owned `[0, pos)` and `[pos, size)`.
+  static void __split(__node *n, size_type pos, __node **l, __node **r) {
+    if (!n || (pos == 0)) {
+      (*l) = 0;
+      (*r) = n;
+      __retain(n);
+      return;
+    }
+    if (pos >= n->size) {
+      (*l) = n;
+      (*r) = 0;
+      __retain(n);
+      return;
+    }
+    if (n->height == 0) {
+      (*l) = __leaf(n->chars(), pos, pos);
+      (*r) = __leaf(n->chars() + pos, n->size - pos, n->size - pos);
+      return;
+    }
+
+    const size_type lsize = n->left->size;
+    if (pos <= lsize) {
+      __node *x;
+      __split(n->left, pos, l, &x);
+      __retain(n->right);
+      (*r) = __join(x, n->right);
+    } else {
+      __node *x;
+      __split(n->right, pos - lsize, &x, r);
+      __retain(n->left);
+      (*l) = __join(n->left, x);
+    }
+  }
+
+  // Owned `[lo, hi)` of `n`(borrowed). 0 <= lo < hi <= n->size.
+  static __node *__sub(__node *n, size_type lo, size_type hi) {
+    if ((lo == 0) && (hi == n->size)) {
+      __retain(n);
+      return n;
+    }
+    if (n->height == 0) {
+      return __leaf(n->chars() + lo, hi - lo, hi - lo);
+    }
+    const size_type lsize = n->left->size;
+    if (hi <= lsize) {
+      return __sub(n->left, lo, hi);
+    }
+    if (lo >= lsize) {
+      return __sub(n->right, lo - lsize, hi - lsize);
+    }
+    return __join(__sub(n->left, lo, lsize), __sub(n->right, 0, hi - lsize));
+  }
+
+  void __insert(size_type pos, __node *x) {
+    if (!x) {
+      return;
+    }
+    __node *l, *r;
+    __split(root_, pos, &l, &r);
+    __release(root_);
+    root_ = __join(__join(l, x), r);
+  }
+
+  template <class F>
+  static void __for_each(const __node *n, F &f) {
+    if (n->height == 0) {
+      f(basic_string_view<charT>(n->chars(), n->size));
+      return;
+    }
+    __for_each(n->left, f);
+    __for_each(n->right, f);
+  }
+
+  static void __copy(const __node *n, size_type lo, size_type hi, charT *dst) {
+    if (n->height == 0) {
+      memcpy(dst, n->chars() + lo, (hi - lo) * sizeof(charT));
+      return;
+    }
+    const size_type lsize = n->left->size;
+    if (lo < lsize) {
+      const size_type h = (hi < lsize) ? hi : lsize;
+      __copy(n->left, lo, h, dst);
+      dst += h - lo;
+    }
+    if (hi > lsize) {
+      __copy(n->right, (lo > lsize) ? lo - lsize : 0, hi - lsize, dst);
+    }
+  }
+
+  __node *root_;
+};
+
+template <class charT>
+basic_rope<charT> operator+(const basic_rope<charT> &a,
+                            const basic_rope<charT> &b) {
+  basic_rope<charT> r(a);
+  r.append(b);
+  return r;
+}
+
+template <class charT>
+basic_rope<charT> operator+(const basic_rope<charT> &a,
+                            basic_string_view<charT> b) {
+  basic_rope<charT> r(a);
+  r.append(b);
+  return r;
+}
+
+template <class charT>
+basic_rope<charT> operator+(const basic_rope<charT> &a, const charT *b) {
+  basic_rope<charT> r(a);
+  r += b;
+  return r;
+}
+
+typedef basic_rope<char> rope;
+
+}  // namespace nanostl
+
+#endif  // NANOSTL_ROPE_H_
@@ -29,6 +29,12 @@
 #include "nanolimits.h"
 #include "nanovector.h"
 #include "nanoutility.h"
+#include "nanotype_traits.h"
+#include "nanoallocator.h"
+#include "nanocstring.h"
+#include "nanocharconv.h"
+#include "nanostring_view.h"
+#include "__nanostrsearch.h"
 #include "nanoiosfwd.h"
 
 #ifdef NANOSTL_DEBUG
@@ -39,14 +45,30 @@
 
 //
 // Simple alternative implementation of std::string
-// Implement `string' as `vector<char>`
-// TODO(LTE): Support traits and allocator.
+//
+// Short strings are stored inline(small string optimization). With 64bit
+// `size_type`, `basic_string<char>` is 24 bytes and holds up to 22 chars
+// without heap allocation. Layout is similar to libc++'s:
+//
+//   long  : [capacity | flag][size][pointer]
+//   short : [size][chars ... '\0']
+//
+// The flag bit lives in the first byte, overlapping the short size, so that
+// both representations can be distinguished. On little endian it is the LSB
+// of the capacity, on big endian(NANOSTL_BIG_ENDIAN) the MSB.
+//
+// The allocator may be stateful(e.g. `arena_allocator`). An empty
+// allocator(the default) takes no space.
+//
+// TODO(LTE): Support traits.
 //
 
 namespace nanostl {
 
-template <class charT>
-class basic_string {
+template <class charT, class Allocator = nanostl::allocator<charT> >
+class basic_string : private __allocator_holder<Allocator> {
+  typedef __allocator_holder<Allocator> __base;
+
  public:
   typedef unsigned long long size_type;
 
@@ -57,109 +79,392 @@ class basic_string {
   typedef const charT *const_pointer;
   typedef pointer iterator;
   typedef const_pointer const_iterator;
+  typedef Allocator allocator_type;
+
+  static const size_type npos = ~size_type(0);
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  basic_string() { __zero(); }
 
   NANOSTL_HOST_AND_DEVICE_QUAL
-  basic_string() {
-    data_.resize(1);
-    data_[0] = '\0';
+  explicit basic_string(const allocator_type &alloc) : __base(alloc) {
+    __zero();
   }
 
   NANOSTL_HOST_AND_DEVICE_QUAL
-  basic_string(const basic_string &s) { data_ = s.data_; }
+  basic_string(const basic_string &s) : __base(s.__alloc()) {
+    __init(s.data(), s.size());
+  }
 
   NANOSTL_HOST_AND_DEVICE_QUAL
-  basic_string(const charT *s) {
-    data_.clear();
-    while (s && (*s) != '\0') {
-      data_.push_back(*s);
-      s++;
-    }
-    data_.push_back('\0');
+  basic_string(basic_string &&s) : __base(s.__alloc()) {
+    __r_ = s.__r_;
+    s.__zero();
   }
 
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  basic_string(const charT *s) { __init(s, __strlen(s)); }
+
   NANOSTL_HOST_AND_DEVICE_QUAL
   basic_string(const charT *first, const charT *last) {
-    const char *s = first;
-    while (s && (s <= last)) {
-      data_.push_back(*s);
-      s++;
-    }
+    __init(first, size_type(last - first));
   }
 
   NANOSTL_HOST_AND_DEVICE_QUAL
-  basic_string(const charT *s, size_type count) {
-    for (size_type i = 0; i < count; i++) {
-      data_.push_back(s[i]);
-    }
+  basic_string(const charT *s, size_type count) { __init(s, count); }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  explicit basic_string(basic_string_view<charT> v) {
+    __init(v.data(), v.size());
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  basic_string(const charT *s, const allocator_type &alloc) : __base(alloc) {
+    __init(s, __strlen(s));
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  basic_string(const charT *s, size_type count, const allocator_type &alloc)
+      : __base(alloc) {
+    __init(s, count);
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  basic_string(basic_string_view<charT> v, const allocator_type &alloc)
+      : __base(alloc) {
+    __init(v.data(), v.size());
   }
 
   NANOSTL_HOST_AND_DEVICE_QUAL
-  bool empty() const { return data_.size() == 0; }
+  ~basic_string() { __deallocate(); }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  allocator_type get_allocator() const { return this->__alloc(); }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  bool empty() const { return size() == 0; }
 
   NANOSTL_HOST_AND_DEVICE_QUAL
   size_type size() const {
-    // -1 for '\0'
-    return data_.size() - 1;
+    return __is_long() ? __r_.__l.size_ : __get_short_size();
   }
 
   NANOSTL_HOST_AND_DEVICE_QUAL
-  size_type length() const {
-    // -1 for '\0'
-    return data_.size() - 1;
+  size_type length() const { return size(); }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  size_type capacity() const {
+    return __is_long() ? __get_long_cap() : size_type(kShortCap);
   }
 
   NANOSTL_HOST_AND_DEVICE_QUAL
-  void clear() { data_.clear();
-    data_.resize(1);
-    data_[0] = '\0';
+  void clear() { __set_size(0); }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  const charT *c_str() const { return __get_pointer(); }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  const charT *data() const { return __get_pointer(); }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  operator basic_string_view<charT>() const {
+    return basic_string_view<charT>(data(), size());
   }
 
   NANOSTL_HOST_AND_DEVICE_QUAL
-  const charT *c_str() const { return &data_.at(0); }
+  charT &at(size_type pos) { return __get_pointer()[pos]; }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  const charT &at(size_type pos) const { return __get_pointer()[pos]; }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  charT &operator[](size_type pos) { return __get_pointer()[pos]; }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  const charT &operator[](size_type pos) const { return __get_pointer()[pos]; }
 
   NANOSTL_HOST_AND_DEVICE_QUAL
-  char &at(size_type pos) { return data_[pos]; }
+  iterator begin() { return __get_pointer(); }
 
   NANOSTL_HOST_AND_DEVICE_QUAL
-  const charT &at(size_type pos) const { return data_[pos]; }
+  const_iterator begin() const { return __get_pointer(); }
 
   NANOSTL_HOST_AND_DEVICE_QUAL
-  char &operator[](size_type pos) { return data_[pos]; }
+  iterator end() { return __get_pointer() + size(); }
 
   NANOSTL_HOST_AND_DEVICE_QUAL
-  const charT &operator[](size_type pos) const { return data_[pos]; }
+  const_iterator end() const { return __get_pointer() + size(); }
 
   NANOSTL_HOST_AND_DEVICE_QUAL
   int compare(const basic_string &str) const {
-    return compare_(&data_[0], &str[0]);
+    return compare_(data(), size(), str.data(), str.size());
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  int compare(const charT *s) const {
+    return compare_(data(), size(), s, __strlen(s));
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  int compare(basic_string_view<charT> v) const {
+    return compare_(data(), size(), v.data(), v.size());
+  }
+
+  //
+  // Search. `char` strings use SIMD kernels(see __nanostrsearch.h).
+  //
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  size_type find(basic_string_view<charT> v, size_type pos = 0) const {
+    if (pos > size()) {
+      return npos;
+    }
+    return __offset(
+        __strsearch::find(data() + pos, size() - pos, v.data(), v.size()),
+        pos);
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  size_type find(const charT *s, size_type pos, size_type n) const {
+    return find(basic_string_view<charT>(s, n), pos);
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  size_type find(charT c, size_type pos = 0) const {
+    if (pos >= size()) {
+      return npos;
+    }
+    return __offset(__strsearch::find_char(data() + pos, size() - pos, c),
+                    pos);
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  size_type rfind(basic_string_view<charT> v, size_type pos = npos) const {
+    if (v.size() > size()) {
+      return npos;
+    }
+    size_type start = size() - v.size();
+    if (pos < start) {
+      start = pos;
+    }
+    return __strsearch::rfind(data(), start + v.size(), v.data(), v.size());
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  size_type rfind(charT c, size_type pos = npos) const {
+    return __strsearch::rfind_char(data(), __search_end(pos), c);
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  size_type find_first_of(basic_string_view<charT> v, size_type pos = 0) const {
+    if (pos >= size()) {
+      return npos;
+    }
+    return __offset(__strsearch::find_first_of(data() + pos, size() - pos,
+                                               v.data(), v.size(), true),
+                    pos);
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  size_type find_first_of(charT c, size_type pos = 0) const {
+    return find(c, pos);
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  size_type find_last_of(basic_string_view<charT> v,
+                         size_type pos = npos) const {
+    return __strsearch::find_last_of(data(), __search_end(pos), v.data(),
+                                     v.size(), true);
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  size_type find_last_of(charT c, size_type pos = npos) const {
+    return rfind(c, pos);
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  size_type find_first_not_of(basic_string_view<charT> v,
+                              size_type pos = 0) const {
+    if (pos >= size()) {
+      return npos;
+    }
+    return __offset(__strsearch::find_first_of(data() + pos, size() - pos,
+                                               v.data(), v.size(), false),
+                    pos);
   }
 
   NANOSTL_HOST_AND_DEVICE_QUAL
-  int compare(const charT *s) const { return compare_(&data_[0], s); }
+  size_type find_first_not_of(charT c, size_type pos = 0) const {
+    return find_first_not_of(basic_string_view<charT>(&c, 1), pos);
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  size_type find_last_not_of(basic_string_view<charT> v,
+                             size_type pos = npos) const {
+    return __strsearch::find_last_of(data(), __search_end(pos), v.data(),
+                                     v.size(), false);
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  size_type find_last_not_of(charT c, size_type pos = npos) const {
+    return find_last_not_of(basic_string_view<charT>(&c, 1), pos);
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  iterator erase(iterator pos) {
+    nanostl::memmove(pos, pos + 1, size_type(end() - pos - 1) * sizeof(charT));
+    __set_size(size() - 1);
+    return pos;
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  void swap(basic_string &s) {
+    __rep tmp = __r_;
+    __r_ = s.__r_;
+    s.__r_ = tmp;
+    allocator_type a = this->__alloc();
+    this->__alloc() = s.__alloc();
+    s.__alloc() = a;
+  }
+
+  //
+  // Modifiers. Growth is geometric(2x), so repeated append is amortized
+  // O(1) per char.
+  //
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  void reserve(size_type new_cap) { __grow_exact(new_cap); }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  void resize(size_type n, charT c = charT()) {
+    const size_type sz = size();
+    if (n > sz) {
+      append(n - sz, c);
+    } else {
+      __set_size(n);
+    }
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  void push_back(charT c) {
+    const size_type sz = size();
+    if (sz == capacity()) {
+      __grow(sz + 1);
+    }
+    __get_pointer()[sz] = c;
+    __set_size(sz + 1);
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  void pop_back() { __set_size(size() - 1); }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  basic_string &append(const charT *s, size_type n) {
+    __append(s, n);
+    return (*this);
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  basic_string &append(basic_string_view<charT> v) {
+    __append(v.data(), v.size());
+    return (*this);
+  }
 
   NANOSTL_HOST_AND_DEVICE_QUAL
-  iterator erase(iterator pos) { return data_.erase(pos); }
+  basic_string &append(size_type n, charT c) {
+    const size_type sz = size();
+    if (sz + n > capacity()) {
+      __grow(sz + n);
+    }
+    charT *p = __get_pointer() + sz;
+    for (size_type i = 0; i < n; i++) {
+      p[i] = c;
+    }
+    __set_size(sz + n);
+    return (*this);
+  }
 
+  ///
+  /// Inserts `n` chars at `pos`(`pos` <= size()).
+  ///
   NANOSTL_HOST_AND_DEVICE_QUAL
-  basic_string operator+(const basic_string &s) const;
+  basic_string &insert(size_type pos, const charT *s, size_type n);
 
   NANOSTL_HOST_AND_DEVICE_QUAL
-  basic_string &operator+=(const basic_string &s);
+  basic_string &insert(size_type pos, basic_string_view<charT> v) {
+    return insert(pos, v.data(), v.size());
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  basic_string &operator+=(const basic_string &s) {
+    __append(s.data(), s.size());
+    return (*this);
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  basic_string &operator+=(basic_string_view<charT> v) {
+    __append(v.data(), v.size());
+    return (*this);
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  basic_string &operator+=(const charT *s) {
+    __append(s, __strlen(s));
+    return (*this);
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  basic_string &operator+=(charT c) {
+    push_back(c);
+    return (*this);
+  }
 
   NANOSTL_HOST_AND_DEVICE_QUAL
   basic_string &operator=(const basic_string &s) {
-    this->data_ = s.data_;
+    if (this != &s) {
+      __assign(s.data(), s.size());
+    }
     return (*this);
   }
 
   NANOSTL_HOST_AND_DEVICE_QUAL
-  bool operator==(const basic_string &str) const { return compare(str) == 0; }
+  basic_string &operator=(basic_string &&s) {
+    if (this == &s) {
+      return (*this);
+    }
+    if (!(this->__alloc() == s.__alloc())) {
+      // Can't take a buffer which our allocator doesn't own.
+      __assign(s.data(), s.size());
+      return (*this);
+    }
+    __deallocate();
+    __r_ = s.__r_;
+    s.__zero();
+    return (*this);
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  basic_string &operator=(const charT *s) {
+    __assign(s, __strlen(s));
+    return (*this);
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  basic_string &operator=(basic_string_view<charT> v) {
+    __assign(v.data(), v.size());
+    return (*this);
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  bool operator==(const basic_string &str) const {
+    return (size() == str.size()) && (compare(str) == 0);
+  }
 
   NANOSTL_HOST_AND_DEVICE_QUAL
   bool operator==(const charT *s) const { return compare(s) == 0; }
 
   NANOSTL_HOST_AND_DEVICE_QUAL
-  bool operator!=(const basic_string &str) const { return compare(str) != 0; }
+  bool operator!=(const basic_string &str) const { return !(*this == str); }
 
   NANOSTL_HOST_AND_DEVICE_QUAL
   bool operator!=(const charT *s) const { return compare(s) != 0; }
@@ -177,196 +482,455 @@ class basic_string {
   bool operator>(const charT *s) const { return compare(s) > 0; }
 
  private:
-  nanostl::vector<charT> data_;
+  struct __long {
+    size_type cap_;  // capacity with the long flag
+    size_type size_;
+    charT *data_;
+  };
 
-  inline int compare_(const charT *p, const charT *q) const {
-    while (*p && (*p == *q)) {
-      p++;
-      q++;
-    }
+  enum {
+    kShortBuf = (sizeof(__long) - sizeof(charT)) / sizeof(charT),
+    kShortCap = kShortBuf - 1  // -1 for '\0'
+  };
 
-    return *reinterpret_cast<const unsigned char *>(p) -
-           *reinterpret_cast<const unsigned char *>(q);
-  }
-};
+  struct __short {
+    unsigned char size_;
+    charT data_[kShortBuf];
+  };
 
-template <class charT>
-basic_string<charT> basic_string<charT>::operator+(
-    const basic_string<charT> &s) const {
-  basic_string<charT> result(*this);
-  result += s;
-  return result;
-}
+  union __rep {
+    __long __l;
+    __short __s;
+  };
 
-template <class charT>
-basic_string<charT> &basic_string<charT>::operator+=(
-    const basic_string<charT> &s) {
-  // remove '\0'
-  if (data_.size() < 1) {
-    // this should not be happen
-  } else {
-    data_.pop_back();
-  }
+#if defined(NANOSTL_BIG_ENDIAN)
+  static const unsigned char kShortLongFlag = 0x80;
+  static const size_type kLongCapFlag = 0x8000000000000000ull;
+#else
+  static const unsigned char kShortLongFlag = 0x01;
+  static const size_type kLongCapFlag = 0x1ull;
+#endif
 
-  const_iterator first = s.data_.begin();
-  const_iterator last = s.data_.end(); // this contains `\0`
+  __rep __r_;
 
-  for (; first != last; ++first) {
-#ifdef NANOSTL_DEBUG
-    printf("first = %c\n", *first);
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  bool __is_long() const { return (__r_.__s.size_ & kShortLongFlag) != 0; }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  size_type __get_short_size() const {
+#if defined(NANOSTL_BIG_ENDIAN)
+    return __r_.__s.size_;
+#else
+    return __r_.__s.size_ >> 1;
 #endif
-    data_.push_back(*first);
   }
 
-#ifdef NANOSTL_DEBUG
-  printf("data_ = %s\n", &data_.at(0));
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  void __set_short_size(size_type n) {
+#if defined(NANOSTL_BIG_ENDIAN)
+    __r_.__s.size_ = static_cast<unsigned char>(n);
+#else
+    __r_.__s.size_ = static_cast<unsigned char>(n << 1);
 #endif
+  }
 
-  return (*this);
-}
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  size_type __get_long_cap() const {
+#if defined(NANOSTL_BIG_ENDIAN)
+    return __r_.__l.cap_ & ~kLongCapFlag;
+#else
+    return __r_.__l.cap_ >> 1;
+#endif
+  }
 
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  void __set_long_cap(size_type cap) {
+#if defined(NANOSTL_BIG_ENDIAN)
+    __r_.__l.cap_ = cap | kLongCapFlag;
+#else
+    __r_.__l.cap_ = (cap << 1) | kLongCapFlag;
+#endif
+  }
 
-typedef basic_string<char> string;
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  charT *__get_pointer() {
+    return __is_long() ? __r_.__l.data_ : __r_.__s.data_;
+  }
 
-// stream
-ostream &operator<<(ostream &os, const string &s)
-{
-  os << s;
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  const charT *__get_pointer() const {
+    return __is_long() ? __r_.__l.data_ : __r_.__s.data_;
+  }
 
-  return os;
-}
+  // Sets the size and writes the terminating '\0'.
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  void __set_size(size_type n) {
+    if (__is_long()) {
+      __r_.__l.size_ = n;
+      __r_.__l.data_[n] = charT(0);
+    } else {
+      __set_short_size(n);
+      __r_.__s.data_[n] = charT(0);
+    }
+  }
 
-NANOSTL_HOST_AND_DEVICE_QUAL
-string to_string(int value);
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  void __zero() {
+    __set_short_size(0);
+    __r_.__s.data_[0] = charT(0);
+  }
 
-NANOSTL_HOST_AND_DEVICE_QUAL
-string to_string(unsigned int value);
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  void __init(const charT *s, size_type n) {
+    charT *p;
+    if (n <= size_type(kShortCap)) {
+      __set_short_size(n);
+      p = __r_.__s.data_;
+    } else {
+      p = this->__alloc().allocate(n + 1);
+      __set_long_cap(n);
+      __r_.__l.size_ = n;
+      __r_.__l.data_ = p;
+    }
+    if (n) {
+      nanostl::memcpy(p, s, n * sizeof(charT));
+    }
+    p[n] = charT(0);
+  }
 
-NANOSTL_HOST_AND_DEVICE_QUAL
-string to_string(int64_t value);
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  void __deallocate() {
+    if (__is_long()) {
+      this->__alloc().deallocate(__r_.__l.data_, __get_long_cap() + 1);
+    }
+  }
 
-NANOSTL_HOST_AND_DEVICE_QUAL
-string to_string(uint64_t value);
+  // Ensures capacity() >= new_cap, keeping the contents. Grows at least 2x.
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  void __grow(size_type new_cap) {
+    const size_type cap = capacity();
+    if (new_cap <= cap) {
+      return;
+    }
+    if (new_cap < 2 * cap) {
+      new_cap = 2 * cap;
+    }
+    __grow_exact(new_cap);
+  }
 
-NANOSTL_HOST_AND_DEVICE_QUAL
-string to_string(float value);
+  // Ensures capacity() >= new_cap, keeping the contents.
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  void __grow_exact(size_type new_cap) {
+    if (new_cap <= capacity()) {
+      return;
+    }
 
-NANOSTL_HOST_AND_DEVICE_QUAL
-string to_string(double value);
+    const size_type n = size();
+    charT *p = this->__alloc().allocate(new_cap + 1);
+    nanostl::memcpy(p, __get_pointer(), (n + 1) * sizeof(charT));
+    __deallocate();
 
-NANOSTL_HOST_AND_DEVICE_QUAL
-float stof(const nanostl::string &str, nanostl::size_t *idx = nullptr);
+    __set_long_cap(new_cap);
+    __r_.__l.size_ = n;
+    __r_.__l.data_ = p;
+  }
 
-NANOSTL_HOST_AND_DEVICE_QUAL
-float stod(const nanostl::string &str, nanostl::size_t *idx = nullptr);
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  void __assign(const charT *s, size_type n) {
+    if (n > capacity()) {
+      // `s` can't point into our buffer since n > capacity().
+      __deallocate();
+      __init(s, n);
+      return;
+    }
+    charT *p = __get_pointer();
+    if ((s >= p) && (s <= p + size())) {
+      // Assigning a substring of itself.
+      nanostl::memmove(p, s, n * sizeof(charT));
+    } else if (n) {
+      nanostl::memcpy(p, s, n * sizeof(charT));
+    }
+    __set_size(n);
+  }
 
-#if defined(NANOSTL_IMPLEMENTATION)
-#ifndef NANOSTL_STRING_IMPLEMENTATION
-#define NANOSTL_STRING_IMPLEMENTATION
-#endif
-#endif
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  void __append(const charT *s, size_type n) {
+    const size_type sz = size();
+    if (sz + n > capacity()) {
+      const charT *p = __get_pointer();
+      if ((s >= p) && (s <= p + sz)) {
+        // Appending a part of itself: rebase `s` after reallocation.
+        const size_type offset = size_type(s - p);
+        __grow(sz + n);
+        s = __get_pointer() + offset;
+      } else {
+        __grow(sz + n);
+      }
+    }
+    charT *p = __get_pointer();
+    if (n) {
+      nanostl::memcpy(p + sz, s, n * sizeof(charT));
+    }
+    __set_size(sz + n);
+  }
 
-#if defined(NANOSTL_STRING_IMPLEMENTATION)
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  static size_type __offset(size_type r, size_type pos) {
+    return (r == npos) ? npos : r + pos;
+  }
 
-#include "fast_float/fast_float.h"
+  // Number of chars to search backward from `pos`(inclusive).
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  size_type __search_end(size_type pos) const {
+    return (pos < size()) ? pos + 1 : size();
+  }
 
-NANOSTL_HOST_AND_DEVICE_QUAL
-string to_string(int value) {
-  // naiive implementation of base-10 int to ascii
-  // based on https://www.techiedelight.com/implement-itoa-function-in-c/
-
-  auto myreverse = [](char *buf, int i, int j) {
-    while (i < j) {
-      char tmp = buf[j];
-      buf[j] = buf[i];
-      buf[i] = tmp;
-      i++;
-      j--;
-
-      //swap(buf[i++], buf[j--]);
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  static size_type __strlen(const charT *s) {
+    if (s && (sizeof(charT) == 1)) {
+      return nanostl::strlen(reinterpret_cast<const char *>(s));
     }
-  };
-
-  char buffer[numeric_limits<int>::digits10 + 2];  // +2 for sign and null
-
-  int n = (value < 0) ? -value : value;  // abs
-  int i = 0;
-  int base = 10;
-  while (n) {
-    int r = n % base;
+    size_type n = 0;
+    while (s && (s[n] != charT(0))) {
+      n++;
+    }
+    return n;
+  }
 
-    if (r >= 10) {
-      buffer[i++] = 'A' + (r - 10);  //
-    } else {
-      buffer[i++] = '0' + r;
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  static int compare_(const charT *p, size_type plen, const charT *q,
+                      size_type qlen) {
+    const size_type n = (plen < qlen) ? plen : qlen;
+    // Bytes before the first differing one are equal, so the char containing
+    // it is the first differing char.
+    const size_type i =
+        __cstring::mismatch(reinterpret_cast<const unsigned char *>(p),
+                            reinterpret_cast<const unsigned char *>(q),
+                            n * sizeof(charT)) /
+        sizeof(charT);
+    if (i < n) {
+      return (static_cast<unsigned long long>(p[i]) <
+              static_cast<unsigned long long>(q[i]))
+                 ? -1
+                 : 1;
     }
+    if (plen == qlen) {
+      return 0;
+    }
+    return (plen < qlen) ? -1 : 1;
+  }
+};
 
-    n = n / base;
+template <class charT, class Allocator>
+const typename basic_string<charT, Allocator>::size_type
+    basic_string<charT, Allocator>::npos;
+
+template <class charT, class Allocator>
+basic_string<charT, Allocator> &basic_string<charT, Allocator>::insert(
+    size_type pos, const charT *s, size_type n) {
+  const size_type sz = size();
+  if (n == 0) {
+    return (*this);
   }
 
-  if (i == 0) {
-    buffer[i++] = '0';
+  const charT *p = __get_pointer();
+  if ((s >= p) && (s <= p + sz)) {
+    // Inserting a part of itself.
+    basic_string tmp(s, n, this->__alloc());
+    return insert(pos, tmp.data(), n);
   }
 
-  if ((value < 0) && (base == 10)) {
-    buffer[i++] = '-';
+  if (sz + n > capacity()) {
+    __grow(sz + n);
   }
+  charT *q = __get_pointer();
+  // Move the tail(regions may overlap).
+  nanostl::memmove(q + pos + n, q + pos, (sz - pos) * sizeof(charT));
+  nanostl::memcpy(q + pos, s, n * sizeof(charT));
+  __set_size(sz + n);
+  return (*this);
+}
 
-  buffer[i] = '\0';
+//
+// Concatenation. Overloads taking an rvalue reuse its buffer, so
+// `a + b + c + d` allocates(amortized) once instead of copying each partial
+// result.
+//
 
-  myreverse(buffer, 0, i - 1);
+// The result uses the allocator of `alloc_from`.
+template <class charT, class Allocator>
+basic_string<charT, Allocator> __concat(
+    const basic_string<charT, Allocator> &alloc_from, const charT *a,
+    unsigned long long n, const charT *b, unsigned long long m) {
+  basic_string<charT, Allocator> result(alloc_from.get_allocator());
+  result.reserve(n + m);
+  result.append(a, n);
+  result.append(b, m);
+  return result;
+}
 
-  return string(buffer);
+template <class charT, class Allocator>
+basic_string<charT, Allocator> operator+(
+    const basic_string<charT, Allocator> &a,
+    const basic_string<charT, Allocator> &b) {
+  return __concat(a, a.data(), a.size(), b.data(), b.size());
 }
 
-NANOSTL_HOST_AND_DEVICE_QUAL
-string to_string(int64_t value) {
-  // naiive implementation of base-10 int to ascii
-  // based on https://www.techiedelight.com/implement-itoa-function-in-c/
-
-  auto myreverse = [](char *buf, int i, int j) {
-    while (i < j) {
-      char tmp = buf[j];
-      buf[j] = buf[i];
-      buf[i] = tmp;
-      i++;
-      j--;
-      //swap(buf[i++], buf[j--]);
-    }
-  };
+template <class charT, class Allocator>
+basic_string<charT, Allocator> operator+(
+    const basic_string<charT, Allocator> &a, basic_string_view<charT> b) {
+  return __concat(a, a.data(), a.size(), b.data(), b.size());
+}
+
+template <class charT, class Allocator>
+basic_string<charT, Allocator> operator+(
+    basic_string_view<charT> a, const basic_string<charT, Allocator> &b) {
+  return __concat(b, a.data(), a.size(), b.data(), b.size());
+}
 
-  char buffer[numeric_limits<int64_t>::digits10 + 2];  // +2 for sign and null
+template <class charT, class Allocator>
+basic_string<charT, Allocator> operator+(
+    const basic_string<charT, Allocator> &a, const charT *b) {
+  basic_string_view<charT> v(b);
+  return __concat(a, a.data(), a.size(), v.data(), v.size());
+}
 
-  int n = (value < 0) ? -value : value;  // abs
-  int i = 0;
-  int base = 10;
-  while (n) {
-    int r = n % base;
+template <class charT, class Allocator>
+basic_string<charT, Allocator> operator+(
+    const charT *a, const basic_string<charT, Allocator> &b) {
+  basic_string_view<charT> v(a);
+  return __concat(b, v.data(), v.size(), b.data(), b.size());
+}
 
-    if (r >= 10) {
-      buffer[i++] = 'A' + (r - 10);  //
-    } else {
-      buffer[i++] = '0' + r;
-    }
+template <class charT, class Allocator>
+basic_string<charT, Allocator> operator+(
+    const basic_string<charT, Allocator> &a, charT b) {
+  return __concat(a, a.data(), a.size(), &b, 1);
+}
 
-    n = n / base;
-  }
+template <class charT, class Allocator>
+basic_string<charT, Allocator> operator+(
+    basic_string<charT, Allocator> &&a,
+    const basic_string<charT, Allocator> &b) {
+  return nanostl::move(a.append(b.data(), b.size()));
+}
 
-  if (i == 0) {
-    buffer[i++] = '0';
-  }
+template <class charT, class Allocator>
+basic_string<charT, Allocator> operator+(basic_string<charT, Allocator> &&a,
+                                         basic_string_view<charT> b) {
+  return nanostl::move(a.append(b.data(), b.size()));
+}
+
+template <class charT, class Allocator>
+basic_string<charT, Allocator> operator+(basic_string<charT, Allocator> &&a,
+                                         const charT *b) {
+  return nanostl::move(a += b);
+}
+
+template <class charT, class Allocator>
+basic_string<charT, Allocator> operator+(basic_string<charT, Allocator> &&a,
+                                         charT b) {
+  a.push_back(b);
+  return nanostl::move(a);
+}
 
-  if ((value < 0) && (base == 10)) {
-    buffer[i++] = '-';
+template <class charT, class Allocator>
+basic_string<charT, Allocator> operator+(
+    const basic_string<charT, Allocator> &a,
+    basic_string<charT, Allocator> &&b) {
+  return nanostl::move(b.insert(0, a.data(), a.size()));
+}
+
+template <class charT, class Allocator>
+basic_string<charT, Allocator> operator+(const charT *a,
+                                         basic_string<charT, Allocator> &&b) {
+  return nanostl::move(b.insert(0, basic_string_view<charT>(a)));
+}
+
+template <class charT, class Allocator>
+basic_string<charT, Allocator> operator+(basic_string<charT, Allocator> &&a,
+                                         basic_string<charT, Allocator> &&b) {
+  // Prefer the buffer of `a`(append is cheaper than insert).
+  if ((a.capacity() < a.size() + b.size()) &&
+      (b.capacity() >= a.size() + b.size())) {
+    return nanostl::move(b.insert(0, a.data(), a.size()));
   }
+  return nanostl::move(a.append(b.data(), b.size()));
+}
+
+
+typedef basic_string<char> string;
+typedef basic_string<char16_t> u16string;
+typedef basic_string<char32_t> u32string;
 
-  buffer[i] = '\0';
+// stream
+template <class charT, class Traits, class Allocator>
+inline basic_ostream<charT, Traits> &operator<<(
+    basic_ostream<charT, Traits> &os, const basic_string<charT, Allocator> &s) {
+  return os.write(s.data(), s.size());
+}
+
+template <class T>
+NANOSTL_HOST_AND_DEVICE_QUAL inline string __integer_to_string(T value) {
+  char buf[24];  // 20 digits + sign
+  to_chars_result r = to_chars(buf, buf + sizeof(buf), value);
+  return string(buf, string::size_type(r.ptr - buf));
+}
 
-  myreverse(buffer, 0, i - 1);
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline string to_string(int value) { return __integer_to_string(value); }
 
-  return string(buffer);
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline string to_string(unsigned int value) {
+  return __integer_to_string(value);
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline string to_string(long value) { return __integer_to_string(value); }
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline string to_string(unsigned long value) {
+  return __integer_to_string(value);
 }
 
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline string to_string(long long value) { return __integer_to_string(value); }
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+inline string to_string(unsigned long long value) {
+  return __integer_to_string(value);
+}
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+string to_string(float value);
+
+NANOSTL_HOST_AND_DEVICE_QUAL
+string to_string(double value);
+
+///
+/// String to number. Leading whitespace and '+' are skipped. `*idx`(if
+/// given) receives the number of chars consumed, 0 if no number was found.
+///
+/// Errors are not thrown: stof/stod return NaN if no number is found and
+/// +-inf if out of range, stoi returns 0 or the saturated value.
+/// from_chars(requires src/nanocharconv.cc for float/double) reports errors
+/// in detail.
+///
+float stof(const nanostl::string &str, nanostl::size_t *idx = nullptr);
+
+double stod(const nanostl::string &str, nanostl::size_t *idx = nullptr);
+
+int stoi(const nanostl::string &str, nanostl::size_t *idx = nullptr,
+         int base = 10);
+
+#if defined(NANOSTL_IMPLEMENTATION)
+#ifndef NANOSTL_STRING_IMPLEMENTATION
+#define NANOSTL_STRING_IMPLEMENTATION
+#endif
+#endif
+
+#if defined(NANOSTL_STRING_IMPLEMENTATION)
+
 // TODO: Move implementation to .cc and remove `static`
 NANOSTL_HOST_AND_DEVICE_QUAL
 string to_string(float value) {
@@ -384,35 +948,81 @@ string to_string(double value) {
   return string(buf);
 }
 
-#if 0
-NANOSTL_HOST_AND_DEVICE_QUAL
-float stof(const nanostl::string &str, nanostl::size_t *idx) {
-  (void)idx;  // TODO(LTE):
-  float value;
-  ryu::RyuStatus ret = ryu::s2f_n(str.c_str(), str.size(), &value);
+namespace {
 
-  if (ret != ryu::RYU_SUCCESS) {
-    // TODO(LTE): Report an error
-    return nanostl::numeric_limits<float>::signaling_NaN();
+// Skips whitespace and '+' as strtod/strtol do.
+inline const char *__sto_skip(const char *p, const char *last) {
+  while ((p != last) && ((*p == ' ') || ((*p >= '\t') && (*p <= '\r')))) {
+    p++;
   }
+  if ((p != last) && (*p == '+') && (last - p > 1) && (p[1] != '-')) {
+    p++;
+  }
+  return p;
+}
+
+template <class T>
+T __sto_float(const nanostl::string &str, nanostl::size_t *idx) {
+  const char *first = str.data();
+  const char *last = first + str.size();
+  const char *p = __sto_skip(first, last);
 
+  T value = T(0);
+  from_chars_result r = from_chars(p, last, value);
+  if (idx) {
+    (*idx) = (r.ec == errc::invalid_argument) ? 0 : size_t(r.ptr - first);
+  }
+  if (r.ec == errc::invalid_argument) {
+    return numeric_limits<T>::quiet_NaN();
+  }
+  if (r.ec == errc::result_out_of_range) {
+    return (*p == '-') ? -numeric_limits<T>::infinity()
+                       : numeric_limits<T>::infinity();
+  }
   return value;
 }
-#else
-#endif
 
-NANOSTL_HOST_AND_DEVICE_QUAL
-float stod(const nanostl::string &str, nanostl::size_t *idx) {
-  (void)idx;  // TODO(LTE):
-  double value;
-  ryu::RyuStatus ret = ryu::s2d_n(str.c_str(), str.size(), &value);
+}  // namespace
+
+float stof(const nanostl::string &str, nanostl::size_t *idx) {
+  return __sto_float<float>(str, idx);
+}
+
+double stod(const nanostl::string &str, nanostl::size_t *idx) {
+  return __sto_float<double>(str, idx);
+}
 
-  if (ret != ryu::RYU_SUCCESS) {
-    // TODO(LTE): Report an error
-    return nanostl::numeric_limits<double>::signaling_NaN();
+int stoi(const nanostl::string &str, nanostl::size_t *idx, int base) {
+  const char *first = str.data();
+  const char *last = first + str.size();
+  const char *p = __sto_skip(first, last);
+
+  const bool neg = (p != last) && (*p == '-');
+  const char *digits = neg ? p + 1 : p;
+
+  // "0x" prefix for base 16, base 0 detects 16/8/10 like strtol.
+  if (((base == 16) || (base == 0)) && (last - digits > 2) &&
+      (digits[0] == '0') && ((digits[1] | 0x20) == 'x') &&
+      (__charconv::digit_value(digits[2]) < 16)) {
+    digits += 2;
+    base = 16;
+  } else if (base == 0) {
+    base = ((last - digits > 1) && (digits[0] == '0')) ? 8 : 10;
   }
 
-  return value;
+  unsigned int u = 0;
+  from_chars_result r = from_chars(digits, last, u, base);
+  if (idx) {
+    (*idx) = (r.ec == errc::invalid_argument) ? 0 : size_t(r.ptr - first);
+  }
+  if (r.ec == errc::invalid_argument) {
+    return 0;
+  }
+  const unsigned int limit = neg ? 2147483648u : 2147483647u;
+  if ((r.ec == errc::result_out_of_range) || (u > limit)) {
+    return neg ? (-2147483647 - 1) : 2147483647;
+  }
+  return neg ? int(0u - u) : int(u);
 }
 #endif
 
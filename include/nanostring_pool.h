@@ -0,0 +1,161 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 Light Transport Entertainment, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef NANOSTL_STRING_POOL_H_
+#define NANOSTL_STRING_POOL_H_
+
+#include "nanocommon.h"
+#include "nanocstdint.h"
+#include "nanostring_view.h"
+#include "nanomutex.h"
+
+//
+// String interning.
+//
+// `string_pool::intern()` stores each unique string once(in arena memory owned
+// by the pool) and returns an `atom`: a pointer sized handle. Two atoms from
+// the same pool are equal iff their strings are equal, so comparison is a
+// pointer compare and `atom::hash()` is precomputed.
+//
+//   nanostl::string_pool pool;
+//   nanostl::atom a = pool.intern("position");
+//   nanostl::atom b = pool.intern(some_string);
+//   if (a == b) { ... }
+//
+// Atoms are valid while the pool is alive. `intern()` and `find()` are
+// thread-safe(unless NANOSTL_NO_THREAD is defined). The table is split into
+// shards with their own lock to reduce contention.
+//
+// Implementation is in src/nanostring_pool.cc
+//
+
+namespace nanostl {
+
+// Interned string: hash, length and '\0' terminated chars.
+struct __atom_rep {
+  uint64_t hash;
+  unsigned long long size;
+  // chars follow
+  const char *data() const { return reinterpret_cast<const char *>(this + 1); }
+};
+
+class atom {
+ public:
+  // Null atom. Not equal to any interned string(including "").
+  atom() : rep_(0) {}
+
+  bool valid() const { return rep_ != 0; }
+
+  string_view view() const {
+    return rep_ ? string_view(rep_->data(), rep_->size) : string_view();
+  }
+
+  const char *c_str() const { return rep_ ? rep_->data() : ""; }
+
+  unsigned long long size() const { return rep_ ? rep_->size : 0; }
+
+  // Hash of the string contents(same for every pool).
+  uint64_t hash() const { return rep_ ? rep_->hash : 0; }
+
+  bool operator==(atom rhs) const { return rep_ == rhs.rep_; }
+  bool operator!=(atom rhs) const { return rep_ != rhs.rep_; }
+
+  // Arbitrary but consistent order(address), for ordered containers.
+  bool operator<(atom rhs) const { return rep_ < rhs.rep_; }
+
+ private:
+  friend class string_pool;
+  explicit atom(const __atom_rep *rep) : rep_(rep) {}
+
+  const __atom_rep *rep_;
+};
+
+// Hash functor for hash containers.
+struct atom_hash {
+  typedef unsigned long long result_type;
+  unsigned long long operator()(atom a) const { return a.hash(); }
+};
+
+class string_pool {
+ public:
+  string_pool();
+  ~string_pool();
+
+  ///
+  /// Returns the atom for `s`, adding it to the pool if needed.
+  ///
+  atom intern(string_view s);
+
+  ///
+  /// Returns the atom for `s` if it was interned, otherwise a null atom.
+  ///
+  atom find(string_view s) const;
+
+  // Number of unique strings.
+  unsigned long long size() const;
+
+  // Bytes of arena and table memory.
+  unsigned long long memory_usage() const;
+
+  static uint64_t hash(string_view s);
+
+  static const unsigned kNumShards = 16;
+
+ private:
+  string_pool(const string_pool &);
+  string_pool &operator=(const string_pool &);
+
+  struct slot {
+    uint64_t hash;
+    const __atom_rep *rep;
+  };
+
+  struct shard {
+    slot *slots;
+    unsigned long long capacity;  // power of two
+    unsigned long long count;
+
+    // Arena: singly linked chunks. `cur`/`end` point into the head chunk.
+    char *chunks;
+    char *cur;
+    char *end;
+    unsigned long long arena_bytes;
+
+#if !defined(NANOSTL_NO_THREAD)
+    mutable mutex lock;
+#endif
+  };
+
+  static const __atom_rep *__lookup(const shard &sh, uint64_t h,
+                                    string_view s);
+  static void __insert_slot(shard &sh, uint64_t h, const __atom_rep *rep);
+  static void __rehash(shard &sh);
+  static __atom_rep *__allocate(shard &sh, unsigned long long bytes);
+
+  shard shards_[kNumShards];
+};
+
+}  // namespace nanostl
+
+#endif  // NANOSTL_STRING_POOL_H_
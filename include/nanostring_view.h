@@ -0,0 +1,309 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 Light Transport Entertainment, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef NANOSTL_STRING_VIEW_H_
+#define NANOSTL_STRING_VIEW_H_
+
+#include "nanocommon.h"
+
+//
+// Non-owning reference to a character sequence(C++17 std::string_view).
+// Available in C++11. Member functions are constexpr in C++14 or later.
+//
+// `basic_string` converts to `basic_string_view` implicitly.
+// The viewed characters are not required to be '\0' terminated.
+//
+
+namespace nanostl {
+
+template <class charT>
+class basic_string_view {
+ public:
+  typedef unsigned long long size_type;
+
+  typedef charT value_type;
+  typedef const charT &reference;
+  typedef const charT &const_reference;
+  typedef const charT *pointer;
+  typedef const charT *const_pointer;
+  typedef const charT *iterator;
+  typedef const charT *const_iterator;
+
+  static const size_type npos = ~size_type(0);
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr basic_string_view() : data_(0), size_(0) {}
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr basic_string_view(const charT *s, size_type count)
+      : data_(s), size_(count) {}
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  NANOSTL_CONSTEXPR14 basic_string_view(const charT *s)
+      : data_(s), size_(__strlen(s)) {}
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr const_iterator begin() const { return data_; }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr const_iterator end() const { return data_ + size_; }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr size_type size() const { return size_; }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr size_type length() const { return size_; }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr bool empty() const { return size_ == 0; }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr const charT *data() const { return data_; }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr const charT &operator[](size_type pos) const { return data_[pos]; }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr const charT &at(size_type pos) const { return data_[pos]; }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr const charT &front() const { return data_[0]; }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr const charT &back() const { return data_[size_ - 1]; }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  NANOSTL_CONSTEXPR14 void remove_prefix(size_type n) {
+    data_ += n;
+    size_ -= n;
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  NANOSTL_CONSTEXPR14 void remove_suffix(size_type n) { size_ -= n; }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  NANOSTL_CONSTEXPR14 void swap(basic_string_view &v) {
+    basic_string_view tmp(*this);
+    *this = v;
+    v = tmp;
+  }
+
+  ///
+  /// `pos` is clamped to size()(no exception).
+  ///
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  NANOSTL_CONSTEXPR14 basic_string_view substr(size_type pos = 0,
+                                               size_type n = npos) const {
+    if (pos > size_) {
+      pos = size_;
+    }
+    if (n > size_ - pos) {
+      n = size_ - pos;
+    }
+    return basic_string_view(data_ + pos, n);
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  NANOSTL_CONSTEXPR14 int compare(basic_string_view v) const {
+    const size_type n = (size_ < v.size_) ? size_ : v.size_;
+    int r = __compare(data_, v.data_, n);
+    if (r != 0) {
+      return r;
+    }
+    if (size_ == v.size_) {
+      return 0;
+    }
+    return (size_ < v.size_) ? -1 : 1;
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  NANOSTL_CONSTEXPR14 int compare(size_type pos, size_type n,
+                                  basic_string_view v) const {
+    return substr(pos, n).compare(v);
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  NANOSTL_CONSTEXPR14 bool starts_with(basic_string_view v) const {
+    return (size_ >= v.size_) && (__compare(data_, v.data_, v.size_) == 0);
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr bool starts_with(charT c) const {
+    return (size_ > 0) && (data_[0] == c);
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  NANOSTL_CONSTEXPR14 bool ends_with(basic_string_view v) const {
+    return (size_ >= v.size_) &&
+           (__compare(data_ + (size_ - v.size_), v.data_, v.size_) == 0);
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  constexpr bool ends_with(charT c) const {
+    return (size_ > 0) && (data_[size_ - 1] == c);
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  NANOSTL_CONSTEXPR14 size_type find(basic_string_view v,
+                                     size_type pos = 0) const {
+    if ((pos > size_) || (v.size_ > size_ - pos)) {
+      return npos;
+    }
+    if (v.size_ == 0) {
+      return pos;
+    }
+    const size_type last = size_ - v.size_;
+    for (size_type i = pos; i <= last; i++) {
+      if ((data_[i] == v.data_[0]) &&
+          (__compare(data_ + i + 1, v.data_ + 1, v.size_ - 1) == 0)) {
+        return i;
+      }
+    }
+    return npos;
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  NANOSTL_CONSTEXPR14 size_type find(charT c, size_type pos = 0) const {
+    for (size_type i = pos; i < size_; i++) {
+      if (data_[i] == c) {
+        return i;
+      }
+    }
+    return npos;
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  NANOSTL_CONSTEXPR14 size_type rfind(basic_string_view v,
+                                      size_type pos = npos) const {
+    if (v.size_ > size_) {
+      return npos;
+    }
+    size_type i = size_ - v.size_;
+    if (pos < i) {
+      i = pos;
+    }
+    for (;;) {
+      if (__compare(data_ + i, v.data_, v.size_) == 0) {
+        return i;
+      }
+      if (i == 0) {
+        break;
+      }
+      i--;
+    }
+    return npos;
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  NANOSTL_CONSTEXPR14 size_type rfind(charT c, size_type pos = npos) const {
+    if (size_ == 0) {
+      return npos;
+    }
+    size_type i = (pos < size_) ? pos : size_ - 1;
+    for (;;) {
+      if (data_[i] == c) {
+        return i;
+      }
+      if (i == 0) {
+        break;
+      }
+      i--;
+    }
+    return npos;
+  }
+
+ private:
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  static NANOSTL_CONSTEXPR14 size_type __strlen(const charT *s) {
+    size_type n = 0;
+    while (s && (s[n] != charT(0))) {
+      n++;
+    }
+    return n;
+  }
+
+  NANOSTL_HOST_AND_DEVICE_QUAL
+  static NANOSTL_CONSTEXPR14 int __compare(const charT *p, const charT *q,
+                                           size_type n) {
+    for (size_type i = 0; i < n; i++) {
+      if (p[i] != q[i]) {
+        return (static_cast<unsigned long long>(p[i]) <
+                static_cast<unsigned long long>(q[i]))
+                   ? -1
+                   : 1;
+      }
+    }
+    return 0;
+  }
+
+  const charT *data_;
+  size_type size_;
+};
+
+template <class charT>
+const typename basic_string_view<charT>::size_type
+    basic_string_view<charT>::npos;
+
+typedef basic_string_view<char> string_view;
+
+// Comparison. The `__sv_identity` overloads make one side non-deduced, so
+// that anything convertible to a view(`basic_string`, `const charT *`) can be
+// compared with a view.
+
+template <class T>
+struct __sv_identity {
+  typedef T type;
+};
+
+#define NANOSTL_STRING_VIEW_COMPARE_OP(op)                                   \
+  template <class charT>                                                     \
+  NANOSTL_HOST_AND_DEVICE_QUAL NANOSTL_CONSTEXPR14 bool operator op(         \
+      basic_string_view<charT> a, basic_string_view<charT> b) {              \
+    return a.compare(b) op 0;                                                \
+  }                                                                          \
+  template <class charT>                                                     \
+  NANOSTL_HOST_AND_DEVICE_QUAL NANOSTL_CONSTEXPR14 bool operator op(         \
+      basic_string_view<charT> a,                                            \
+      typename __sv_identity<basic_string_view<charT> >::type b) {           \
+    return a.compare(b) op 0;                                                \
+  }                                                                          \
+  template <class charT>                                                     \
+  NANOSTL_HOST_AND_DEVICE_QUAL NANOSTL_CONSTEXPR14 bool operator op(         \
+      typename __sv_identity<basic_string_view<charT> >::type a,             \
+      basic_string_view<charT> b) {                                          \
+    return a.compare(b) op 0;                                                \
+  }
+
+NANOSTL_STRING_VIEW_COMPARE_OP(==)
+NANOSTL_STRING_VIEW_COMPARE_OP(!=)
+NANOSTL_STRING_VIEW_COMPARE_OP(<)
+NANOSTL_STRING_VIEW_COMPARE_OP(>)
+NANOSTL_STRING_VIEW_COMPARE_OP(<=)
+NANOSTL_STRING_VIEW_COMPARE_OP(>=)
+
+#undef NANOSTL_STRING_VIEW_COMPARE_OP
+
+}  // namespace nanostl
+
+#endif  // NANOSTL_STRING_VIEW_H_
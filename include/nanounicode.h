@@ -0,0 +1,891 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 Light Transport Entertainment, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef NANOSTL_UNICODE_H_
+#define NANOSTL_UNICODE_H_
+
+#include "nanocommon.h"
+#include "nanocstdint.h"
+#include "nanosystem_error.h"
+#include "nanostring.h"
+#include "nanostring_view.h"
+#include "__nanostrsearch.h"
+
+//
+// UTF-8 validation and UTF-8/UTF-16/UTF-32 transcoding.
+//
+//   if (!nanostl::validate_utf8(text)) { ... }
+//
+//   nanostl::u16string w;
+//   nanostl::utf_result r = nanostl::utf8_to_utf16(text, w);
+//   if (r.ec != nanostl::errc()) {
+//     // invalid sequence starts at text[r.count]
+//   }
+//
+// Raw span functions(`convert_*`) write to a caller buffer which must be
+// large enough(`*_length_from_*` gives the exact size for valid input).
+// The string functions size the output themselves.
+//
+// `utf_result`: on success `ec` is `errc()` and `count` is the number of code
+// units written(validation: input length). On error `ec` is
+// `errc::illegal_byte_sequence` and `count` is the input index of the first
+// code unit of the invalid sequence. Overlong forms, surrogates(in UTF-8 and
+// UTF-32), unpaired surrogates(in UTF-16), values above U+10FFFF and
+// truncated sequences are errors.
+//
+// SIMD: UTF-8 validation uses the Keiser-Lemire nibble lookup algorithm
+// (16 bytes per step, SSSE3/AVX2/NEON) and switches to the scalar validator
+// to locate an error. SSE2 only builds validate with the scalar routine and
+// skip ASCII runs 16 bytes at a time. Transcoding converts ASCII runs 16(8 for UTF-16/32
+// input) code units at a time(SSE2/NEON) and decodes other chars with the
+// scalar routines. Define NANOSTL_NO_SIMD to force the scalar path.
+//
+
+#if defined(NANOSTL_STRSEARCH_SIMD)
+#if defined(NANOSTL_STRSEARCH_AVX2) || defined(NANOSTL_STRSEARCH_SSE2)
+#define NANOSTL_UTF_SSE2
+#if defined(NANOSTL_STRSEARCH_AVX2) || defined(NANOSTL_STRSEARCH_SSSE3)
+#define NANOSTL_UTF_SSSE3
+#endif
+#elif defined(NANOSTL_STRSEARCH_NEON)
+#define NANOSTL_UTF_NEON
+#endif
+#endif
+
+namespace nanostl {
+
+struct utf_result {
+  errc ec;
+  unsigned long long count;
+};
+
+namespace __utf {
+
+inline utf_result ok(unsigned long long count) {
+  utf_result r = {errc(), count};
+  return r;
+}
+
+inline utf_result error(unsigned long long pos) {
+  utf_result r = {errc::illegal_byte_sequence, pos};
+  return r;
+}
+
+inline bool is_continuation(unsigned char c) { return (c & 0xc0) == 0x80; }
+
+// Length of the UTF-8 sequence starting with `c`(0 if `c` can not start
+// one).
+inline int sequence_length(unsigned char c) {
+  if (c < 0x80) {
+    return 1;
+  }
+  if (c < 0xc2) {
+    return 0;
+  }
+  if (c < 0xe0) {
+    return 2;
+  }
+  if (c < 0xf0) {
+    return 3;
+  }
+  if (c < 0xf5) {
+    return 4;
+  }
+  return 0;
+}
+
+// Decodes one UTF-8 sequence at `s`(`n` bytes available, n >= 1). Returns its
+// length, or 0 if it is invalid(Unicode Table 3-7).
+inline int decode(const unsigned char *s, unsigned long long n, uint32_t &cp) {
+  const uint32_t c = s[0];
+  if (c < 0x80) {
+    cp = c;
+    return 1;
+  }
+  if (c < 0xe0) {
+    if ((c < 0xc2) || (n < 2) || !is_continuation(s[1])) {
+      return 0;
+    }
+    cp = ((c & 0x1f) << 6) | (s[1] & 0x3fu);
+    return 2;
+  }
+  if (c < 0xf0) {
+    if ((n < 3) || !is_continuation(s[1]) || !is_continuation(s[2])) {
+      return 0;
+    }
+    cp = ((c & 0x0f) << 12) | (uint32_t(s[1] & 0x3f) << 6) | (s[2] & 0x3fu);
+    // Overlong or surrogate.
+    if ((cp < 0x800) || ((cp & 0xf800) == 0xd800)) {
+      return 0;
+    }
+    return 3;
+  }
+  if ((n < 4) || !is_continuation(s[1]) || !is_continuation(s[2]) ||
+      !is_continuation(s[3])) {
+    return 0;
+  }
+  cp = ((c & 0x07) << 18) | (uint32_t(s[1] & 0x3f) << 12) |
+       (uint32_t(s[2] & 0x3f) << 6) | (s[3] & 0x3fu);
+  // Overlong, above U+10FFFF, or a 5+ byte lead(c >= 0xf8).
+  if ((cp < 0x10000) || (cp > 0x10ffff) || (c >= 0xf8)) {
+    return 0;
+  }
+  return 4;
+}
+
+// Writes `cp`(valid scalar value) as UTF-8. Returns the length.
+inline int encode(uint32_t cp, char *out) {
+  if (cp < 0x80) {
+    out[0] = char(cp);
+    return 1;
+  }
+  if (cp < 0x800) {
+    out[0] = char(0xc0 | (cp >> 6));
+    out[1] = char(0x80 | (cp & 0x3f));
+    return 2;
+  }
+  if (cp < 0x10000) {
+    out[0] = char(0xe0 | (cp >> 12));
+    out[1] = char(0x80 | ((cp >> 6) & 0x3f));
+    out[2] = char(0x80 | (cp & 0x3f));
+    return 3;
+  }
+  out[0] = char(0xf0 | (cp >> 18));
+  out[1] = char(0x80 | ((cp >> 12) & 0x3f));
+  out[2] = char(0x80 | ((cp >> 6) & 0x3f));
+  out[3] = char(0x80 | (cp & 0x3f));
+  return 4;
+}
+
+// 8 bytes, s[0] in the lowest byte.
+inline uint64_t load8(const unsigned char *s) {
+  uint64_t v = 0;
+  for (int i = 0; i < 8; i++) {
+    v |= uint64_t(s[i]) << (8 * i);
+  }
+  return v;
+}
+
+inline bool is_ascii8(const unsigned char *s) {
+  return (load8(s) & 0x8080808080808080ull) == 0;
+}
+
+// Index of the first non-ASCII byte in [i, n).
+inline unsigned long long skip_ascii(const unsigned char *s,
+                                     unsigned long long i,
+                                     unsigned long long n) {
+#if defined(NANOSTL_UTF_SSE2)
+  for (; i + 16 <= n; i += 16) {
+    const int mask = _mm_movemask_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i)));
+    if (mask) {
+      return i + __strsearch::__ctz64(uint64_t(mask));
+    }
+  }
+#endif
+  for (; i + 8 <= n; i += 8) {
+    const uint64_t high = load8(s + i) & 0x8080808080808080ull;
+    if (high) {
+      return i + __strsearch::__ctz64(high) / 8;
+    }
+  }
+  while ((i < n) && (s[i] < 0x80)) {
+    i++;
+  }
+  return i;
+}
+
+inline utf_result validate_utf8_scalar(const unsigned char *s,
+                                       unsigned long long i,
+                                       unsigned long long n) {
+  while (i < n) {
+    if (s[i] < 0x80) {
+      i = skip_ascii(s, i, n);
+      continue;
+    }
+    uint32_t cp;
+    const int len = decode(s + i, n - i, cp);
+    if (len == 0) {
+      return error(i);
+    }
+    i += (unsigned long long)len;
+  }
+  return ok(n);
+}
+
+// Start of the char containing s[pos], given that [0, pos) is valid except
+// for a possibly truncated(or invalid) last char.
+inline unsigned long long char_boundary(const unsigned char *s,
+                                        unsigned long long pos) {
+  for (unsigned long long k = 1; (k <= 3) && (k <= pos); k++) {
+    const unsigned long long p = pos - k;
+    if (!is_continuation(s[p])) {
+      const int len = sequence_length(s[p]);
+      return ((len != 0) && (p + (unsigned long long)len <= pos)) ? pos : p;
+    }
+  }
+  return pos;
+}
+
+#if defined(NANOSTL_UTF_SSSE3) || defined(NANOSTL_UTF_NEON)
+
+//
+// Keiser, Lemire: "Validating UTF-8 In Less Than One Instruction Per Byte".
+// Each byte pair(prev1, input) is classified by three 16 entry tables indexed
+// with the high and low nibble of prev1 and the high nibble of input; a set
+// bit in all three is an error. 3/4 byte lengths are checked with prev2/prev3.
+//
+static const uint8_t kTooShort = 1 << 0;
+static const uint8_t kTooLong = 1 << 1;
+static const uint8_t kOverlong3 = 1 << 2;
+static const uint8_t kTooLarge = 1 << 3;
+static const uint8_t kSurrogate = 1 << 4;
+static const uint8_t kOverlong2 = 1 << 5;
+static const uint8_t kTooLarge1000 = 1 << 6;
+static const uint8_t kOverlong4 = 1 << 6;
+static const uint8_t kTwoConts = 1 << 7;
+static const uint8_t kCarry = kTooShort | kTooLong | kTwoConts;
+
+static const uint8_t kByte1High[16] = {
+    kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong,
+    kTooLong, kTwoConts, kTwoConts, kTwoConts, kTwoConts,
+    kTooShort | kOverlong2, kTooShort, kTooShort | kOverlong3 | kSurrogate,
+    kTooShort | kTooLarge | kTooLarge1000 | kOverlong4};
+
+static const uint8_t kByte1Low[16] = {
+    kCarry | kOverlong3 | kOverlong2 | kOverlong4,
+    kCarry | kOverlong2,
+    kCarry,
+    kCarry,
+    kCarry | kTooLarge,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000 | kSurrogate,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000};
+
+static const uint8_t kByte2High[16] = {
+    kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort,
+    kTooShort, kTooShort,
+    kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge1000 | kOverlong4,
+    kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge,
+    kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+    kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge, kTooShort,
+    kTooShort, kTooShort, kTooShort};
+
+// Max value of the last 3 bytes of a block that does not leave an incomplete
+// sequence.
+static const uint8_t kIncompleteMax[16] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xf0 - 1, 0xe0 - 1, 0xc0 - 1};
+
+#if defined(NANOSTL_UTF_SSSE3)
+
+typedef __m128i vec;
+
+inline vec load(const unsigned char *p) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+inline vec table(const uint8_t *t) { return load(t); }
+inline bool is_ascii(vec v) { return _mm_movemask_epi8(v) == 0; }
+inline bool any(vec v) {
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())) != 0xffff;
+}
+inline vec high_nibble(vec v) {
+  return _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0x0f));
+}
+inline vec low_nibble(vec v) { return _mm_and_si128(v, _mm_set1_epi8(0x0f)); }
+inline vec lookup(vec t, vec idx) { return _mm_shuffle_epi8(t, idx); }
+template <int N>
+inline vec prev(vec cur, vec before) {
+  return _mm_alignr_epi8(cur, before, 16 - N);
+}
+inline vec subs(vec a, vec b) { return _mm_subs_epu8(a, b); }
+inline vec splat(uint8_t c) { return _mm_set1_epi8(char(c)); }
+inline vec vand(vec a, vec b) { return _mm_and_si128(a, b); }
+inline vec vor(vec a, vec b) { return _mm_or_si128(a, b); }
+inline vec vxor(vec a, vec b) { return _mm_xor_si128(a, b); }
+inline vec zero() { return _mm_setzero_si128(); }
+
+#else  // NEON
+
+typedef uint8x16_t vec;
+
+inline vec load(const unsigned char *p) { return vld1q_u8(p); }
+inline vec table(const uint8_t *t) { return vld1q_u8(t); }
+inline bool is_ascii(vec v) { return vmaxvq_u8(v) < 0x80; }
+inline bool any(vec v) { return vmaxvq_u8(v) != 0; }
+inline vec high_nibble(vec v) { return vshrq_n_u8(v, 4); }
+inline vec low_nibble(vec v) { return vandq_u8(v, vdupq_n_u8(0x0f)); }
+inline vec lookup(vec t, vec idx) { return vqtbl1q_u8(t, idx); }
+template <int N>
+inline vec prev(vec cur, vec before) {
+  return vextq_u8(before, cur, 16 - N);
+}
+inline vec subs(vec a, vec b) { return vqsubq_u8(a, b); }
+inline vec splat(uint8_t c) { return vdupq_n_u8(c); }
+inline vec vand(vec a, vec b) { return vandq_u8(a, b); }
+inline vec vor(vec a, vec b) { return vorrq_u8(a, b); }
+inline vec vxor(vec a, vec b) { return veorq_u8(a, b); }
+inline vec zero() { return vdupq_n_u8(0); }
+
+#endif
+
+inline utf_result validate_utf8_simd(const unsigned char *s,
+                                     unsigned long long n) {
+  const vec byte1_high = table(kByte1High);
+  const vec byte1_low = table(kByte1Low);
+  const vec byte2_high = table(kByte2High);
+  const vec incomplete_max = table(kIncompleteMax);
+
+  vec prev_input = zero();
+  vec prev_incomplete = zero();
+  unsigned long long i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const vec input = load(s + i);
+    vec err;
+    if (is_ascii(input)) {
+      err = prev_incomplete;
+    } else {
+      const vec prev1 = prev<1>(input, prev_input);
+      const vec sc = vand(vand(lookup(byte1_high, high_nibble(prev1)),
+                               lookup(byte1_low, low_nibble(prev1))),
+                          lookup(byte2_high, high_nibble(input)));
+      const vec prev2 = prev<2>(input, prev_input);
+      const vec prev3 = prev<3>(input, prev_input);
+      const vec must23 = vor(subs(prev2, splat(0xe0 - 0x80)),
+                             subs(prev3, splat(0xf0 - 0x80)));
+      err = vxor(vand(must23, splat(0x80)), sc);
+      prev_incomplete = subs(input, incomplete_max);
+    }
+    if (any(err)) {
+      return validate_utf8_scalar(s, char_boundary(s, i), n);
+    }
+    prev_input = input;
+  }
+  return validate_utf8_scalar(s, char_boundary(s, i), n);
+}
+
+#endif  // NANOSTL_UTF_SSSE3 || NANOSTL_UTF_NEON
+
+// Writes up to 16 ASCII bytes from `s` widened to `T`. Returns the number
+// of bytes converted(a multiple of 16, stops at the first non-ASCII block).
+template <typename T>
+inline unsigned long long ascii_run(const unsigned char *s,
+                                    unsigned long long n, T *out);
+
+#if defined(NANOSTL_UTF_SSE2)
+
+template <>
+inline unsigned long long ascii_run<char16_t>(const unsigned char *s,
+                                              unsigned long long n,
+                                              char16_t *out) {
+  unsigned long long i = 0;
+  const __m128i z = _mm_setzero_si128();
+  for (; i + 16 <= n; i += 16) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i));
+    if (_mm_movemask_epi8(v)) {
+      break;
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i),
+                     _mm_unpacklo_epi8(v, z));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i + 8),
+                     _mm_unpackhi_epi8(v, z));
+  }
+  return i;
+}
+
+template <>
+inline unsigned long long ascii_run<char32_t>(const unsigned char *s,
+                                              unsigned long long n,
+                                              char32_t *out) {
+  unsigned long long i = 0;
+  const __m128i z = _mm_setzero_si128();
+  for (; i + 16 <= n; i += 16) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i));
+    if (_mm_movemask_epi8(v)) {
+      break;
+    }
+    const __m128i lo = _mm_unpacklo_epi8(v, z);
+    const __m128i hi = _mm_unpackhi_epi8(v, z);
+    __m128i *dst = reinterpret_cast<__m128i *>(out + i);
+    _mm_storeu_si128(dst + 0, _mm_unpacklo_epi16(lo, z));
+    _mm_storeu_si128(dst + 1, _mm_unpackhi_epi16(lo, z));
+    _mm_storeu_si128(dst + 2, _mm_unpacklo_epi16(hi, z));
+    _mm_storeu_si128(dst + 3, _mm_unpackhi_epi16(hi, z));
+  }
+  return i;
+}
+
+// 8 UTF-16 units < 0x80 -> 8 bytes.
+inline unsigned long long ascii_run16(const char16_t *s, unsigned long long n,
+                                      char *out) {
+  unsigned long long i = 0;
+  const __m128i mask = _mm_set1_epi16(short(0xff80));
+  const __m128i z = _mm_setzero_si128();
+  for (; i + 8 <= n; i += 8) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, mask), z)) !=
+        0xffff) {
+      break;
+    }
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(out + i),
+                     _mm_packus_epi16(v, v));
+  }
+  return i;
+}
+
+// 8 UTF-32 units < 0x80 -> 8 bytes.
+inline unsigned long long ascii_run32(const char32_t *s, unsigned long long n,
+                                      char *out) {
+  unsigned long long i = 0;
+  const __m128i mask = _mm_set1_epi32(int(0xffffff80));
+  const __m128i z = _mm_setzero_si128();
+  for (; i + 8 <= n; i += 8) {
+    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i));
+    const __m128i b =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i + 4));
+    const __m128i m = _mm_and_si128(_mm_or_si128(a, b), mask);
+    if (_mm_movemask_epi8(_mm_cmpeq_epi32(m, z)) != 0xffff) {
+      break;
+    }
+    const __m128i w = _mm_packs_epi32(a, b);
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(out + i),
+                     _mm_packus_epi16(w, w));
+  }
+  return i;
+}
+
+#elif defined(NANOSTL_UTF_NEON)
+
+template <>
+inline unsigned long long ascii_run<char16_t>(const unsigned char *s,
+                                              unsigned long long n,
+                                              char16_t *out) {
+  unsigned long long i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const uint8x16_t v = vld1q_u8(s + i);
+    if (vmaxvq_u8(v) >= 0x80) {
+      break;
+    }
+    uint16_t *dst = reinterpret_cast<uint16_t *>(out + i);
+    vst1q_u16(dst, vmovl_u8(vget_low_u8(v)));
+    vst1q_u16(dst + 8, vmovl_u8(vget_high_u8(v)));
+  }
+  return i;
+}
+
+template <>
+inline unsigned long long ascii_run<char32_t>(const unsigned char *s,
+                                              unsigned long long n,
+                                              char32_t *out) {
+  unsigned long long i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const uint8x16_t v = vld1q_u8(s + i);
+    if (vmaxvq_u8(v) >= 0x80) {
+      break;
+    }
+    const uint16x8_t lo = vmovl_u8(vget_low_u8(v));
+    const uint16x8_t hi = vmovl_u8(vget_high_u8(v));
+    uint32_t *dst = reinterpret_cast<uint32_t *>(out + i);
+    vst1q_u32(dst, vmovl_u16(vget_low_u16(lo)));
+    vst1q_u32(dst + 4, vmovl_u16(vget_high_u16(lo)));
+    vst1q_u32(dst + 8, vmovl_u16(vget_low_u16(hi)));
+    vst1q_u32(dst + 12, vmovl_u16(vget_high_u16(hi)));
+  }
+  return i;
+}
+
+inline unsigned long long ascii_run16(const char16_t *s, unsigned long long n,
+                                      char *out) {
+  unsigned long long i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const uint16x8_t v = vld1q_u16(reinterpret_cast<const uint16_t *>(s + i));
+    if (vmaxvq_u16(v) >= 0x80) {
+      break;
+    }
+    vst1_u8(reinterpret_cast<uint8_t *>(out + i), vmovn_u16(v));
+  }
+  return i;
+}
+
+inline unsigned long long ascii_run32(const char32_t *s, unsigned long long n,
+                                      char *out) {
+  unsigned long long i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const uint32x4_t a = vld1q_u32(reinterpret_cast<const uint32_t *>(s + i));
+    const uint32x4_t b =
+        vld1q_u32(reinterpret_cast<const uint32_t *>(s + i + 4));
+    if (vmaxvq_u32(vorrq_u32(a, b)) >= 0x80) {
+      break;
+    }
+    const uint16x8_t w = vcombine_u16(vmovn_u32(a), vmovn_u32(b));
+    vst1_u8(reinterpret_cast<uint8_t *>(out + i), vmovn_u16(w));
+  }
+  return i;
+}
+
+#else
+
+template <typename T>
+inline unsigned long long ascii_run(const unsigned char *s,
+                                    unsigned long long n, T *out) {
+  unsigned long long i = 0;
+  for (; (i + 8 <= n) && is_ascii8(s + i); i += 8) {
+    for (int k = 0; k < 8; k++) {
+      out[i + k] = T(s[i + k]);
+    }
+  }
+  return i;
+}
+
+template <typename T>
+inline unsigned long long __ascii_run_units(const T *s, unsigned long long n,
+                                            char *out) {
+  unsigned long long i = 0;
+  for (; i + 8 <= n; i += 8) {
+    uint32_t v = 0;
+    for (int k = 0; k < 8; k++) {
+      v |= uint32_t(s[i + k]);
+    }
+    if (v >= 0x80) {
+      break;
+    }
+    for (int k = 0; k < 8; k++) {
+      out[i + k] = char(s[i + k]);
+    }
+  }
+  return i;
+}
+
+inline unsigned long long ascii_run16(const char16_t *s, unsigned long long n,
+                                      char *out) {
+  return __ascii_run_units(s, n, out);
+}
+
+inline unsigned long long ascii_run32(const char32_t *s, unsigned long long n,
+                                      char *out) {
+  return __ascii_run_units(s, n, out);
+}
+
+#endif
+
+template <typename T>
+inline void put_utf16(uint32_t cp, T *out, unsigned long long &k);
+
+template <>
+inline void put_utf16<char16_t>(uint32_t cp, char16_t *out,
+                                unsigned long long &k) {
+  if (cp < 0x10000) {
+    out[k++] = char16_t(cp);
+  } else {
+    cp -= 0x10000;
+    out[k++] = char16_t(0xd800 + (cp >> 10));
+    out[k++] = char16_t(0xdc00 + (cp & 0x3ff));
+  }
+}
+
+template <>
+inline void put_utf16<char32_t>(uint32_t cp, char32_t *out,
+                                unsigned long long &k) {
+  out[k++] = char32_t(cp);
+}
+
+// UTF-8 -> UTF-16(T = char16_t) or UTF-32(T = char32_t).
+template <typename T>
+inline utf_result from_utf8(const char *src, unsigned long long n, T *out) {
+  const unsigned char *s = reinterpret_cast<const unsigned char *>(src);
+  unsigned long long i = 0;
+  unsigned long long k = 0;
+  while (i < n) {
+    if (s[i] < 0x80) {
+      const unsigned long long m = ascii_run(s + i, n - i, out + k);
+      if (m) {
+        i += m;
+        k += m;
+        continue;
+      }
+      out[k++] = T(s[i++]);
+      continue;
+    }
+    uint32_t cp;
+    const int len = decode(s + i, n - i, cp);
+    if (len == 0) {
+      return error(i);
+    }
+    put_utf16(cp, out, k);
+    i += (unsigned long long)len;
+  }
+  return ok(k);
+}
+
+inline utf_result from_utf16(const char16_t *s, unsigned long long n,
+                             char *out) {
+  unsigned long long i = 0;
+  unsigned long long k = 0;
+  while (i < n) {
+    uint32_t c = s[i];
+    if (c < 0x80) {
+      const unsigned long long m = ascii_run16(s + i, n - i, out + k);
+      if (m) {
+        i += m;
+        k += m;
+        continue;
+      }
+      out[k++] = char(c);
+      i++;
+      continue;
+    }
+    if ((c & 0xf800) == 0xd800) {
+      // Surrogate pair.
+      if ((c >= 0xdc00) || (i + 1 >= n) || ((s[i + 1] & 0xfc00) != 0xdc00)) {
+        return error(i);
+      }
+      c = 0x10000 + ((c - 0xd800) << 10) + (uint32_t(s[i + 1]) - 0xdc00);
+      i++;
+    }
+    k += (unsigned long long)encode(c, out + k);
+    i++;
+  }
+  return ok(k);
+}
+
+inline utf_result from_utf32(const char32_t *s, unsigned long long n,
+                             char *out) {
+  unsigned long long i = 0;
+  unsigned long long k = 0;
+  while (i < n) {
+    const uint32_t c = s[i];
+    if (c < 0x80) {
+      const unsigned long long m = ascii_run32(s + i, n - i, out + k);
+      if (m) {
+        i += m;
+        k += m;
+        continue;
+      }
+      out[k++] = char(c);
+      i++;
+      continue;
+    }
+    if ((c > 0x10ffff) || ((c & 0xfffff800) == 0xd800)) {
+      return error(i);
+    }
+    k += (unsigned long long)encode(c, out + k);
+    i++;
+  }
+  return ok(k);
+}
+
+// Number of bytes in `v`(8 bytes) which are not continuation bytes.
+inline unsigned count_non_continuation8(uint64_t v) {
+  const uint64_t cont = v & ~(v << 1) & 0x8080808080808080ull;
+  return 8 - unsigned(((cont >> 7) * 0x0101010101010101ull) >> 56);
+}
+
+}  // namespace __utf
+
+///
+/// Validation.
+///
+
+inline utf_result validate_utf8_with_errors(const char *s,
+                                            unsigned long long n) {
+  const unsigned char *p = reinterpret_cast<const unsigned char *>(s);
+#if defined(NANOSTL_UTF_SSSE3) || defined(NANOSTL_UTF_NEON)
+  return __utf::validate_utf8_simd(p, n);
+#else
+  return __utf::validate_utf8_scalar(p, 0, n);
+#endif
+}
+
+inline bool validate_utf8(const char *s, unsigned long long n) {
+  return validate_utf8_with_errors(s, n).ec == errc();
+}
+
+inline bool validate_utf8(string_view s) {
+  return validate_utf8(s.data(), s.size());
+}
+
+inline utf_result validate_utf16_with_errors(const char16_t *s,
+                                             unsigned long long n) {
+  for (unsigned long long i = 0; i < n; i++) {
+    const uint32_t c = s[i];
+    if ((c & 0xf800) == 0xd800) {
+      if ((c >= 0xdc00) || (i + 1 >= n) || ((s[i + 1] & 0xfc00) != 0xdc00)) {
+        return __utf::error(i);
+      }
+      i++;
+    }
+  }
+  return __utf::ok(n);
+}
+
+inline bool validate_utf16(const char16_t *s, unsigned long long n) {
+  return validate_utf16_with_errors(s, n).ec == errc();
+}
+
+inline utf_result validate_utf32_with_errors(const char32_t *s,
+                                             unsigned long long n) {
+  for (unsigned long long i = 0; i < n; i++) {
+    const uint32_t c = s[i];
+    if ((c > 0x10ffff) || ((c & 0xfffff800) == 0xd800)) {
+      return __utf::error(i);
+    }
+  }
+  return __utf::ok(n);
+}
+
+inline bool validate_utf32(const char32_t *s, unsigned long long n) {
+  return validate_utf32_with_errors(s, n).ec == errc();
+}
+
+///
+/// Output sizes. Exact for valid input, and enough for the partial output
+/// of invalid input.
+///
+
+inline unsigned long long utf32_length_from_utf8(const char *s,
+                                                 unsigned long long n) {
+  unsigned long long count = 0;
+  unsigned long long i = 0;
+  for (; i + 8 <= n; i += 8) {
+    count += __utf::count_non_continuation8(
+        __utf::load8(reinterpret_cast<const unsigned char *>(s + i)));
+  }
+  for (; i < n; i++) {
+    count += __utf::is_continuation((unsigned char)s[i]) ? 0 : 1;
+  }
+  return count;
+}
+
+inline unsigned long long utf16_length_from_utf8(const char *s,
+                                                 unsigned long long n) {
+  // 4 byte sequences become surrogate pairs.
+  unsigned long long count = utf32_length_from_utf8(s, n);
+  for (unsigned long long i = 0; i < n; i++) {
+    count += ((unsigned char)s[i] >= 0xf0) ? 1 : 0;
+  }
+  return count;
+}
+
+inline unsigned long long utf8_length_from_utf16(const char16_t *s,
+                                                 unsigned long long n) {
+  unsigned long long count = 0;
+  for (unsigned long long i = 0; i < n; i++) {
+    const uint32_t c = s[i];
+    // A surrogate pair is 4 bytes: 2 per unit.
+    count += (c < 0x80) ? 1 : ((c < 0x800) || ((c & 0xf800) == 0xd800)) ? 2 : 3;
+  }
+  return count;
+}
+
+inline unsigned long long utf8_length_from_utf32(const char32_t *s,
+                                                 unsigned long long n) {
+  unsigned long long count = 0;
+  for (unsigned long long i = 0; i < n; i++) {
+    const uint32_t c = s[i];
+    count += (c < 0x80) ? 1 : (c < 0x800) ? 2 : (c < 0x10000) ? 3 : 4;
+  }
+  return count;
+}
+
+///
+/// Transcoding into a caller buffer. The input is validated while
+/// converting. On error, `out` holds an unspecified partial result.
+///
+
+inline utf_result convert_utf8_to_utf16(const char *s, unsigned long long n,
+                                        char16_t *out) {
+  return __utf::from_utf8(s, n, out);
+}
+
+inline utf_result convert_utf8_to_utf32(const char *s, unsigned long long n,
+                                        char32_t *out) {
+  return __utf::from_utf8(s, n, out);
+}
+
+inline utf_result convert_utf16_to_utf8(const char16_t *s,
+                                        unsigned long long n, char *out) {
+  return __utf::from_utf16(s, n, out);
+}
+
+inline utf_result convert_utf32_to_utf8(const char32_t *s,
+                                        unsigned long long n, char *out) {
+  return __utf::from_utf32(s, n, out);
+}
+
+///
+/// Transcoding into strings. `out` is replaced(cleared on error).
+///
+
+inline utf_result utf8_to_utf16(string_view in, u16string &out) {
+  // At most one UTF-16 unit per input byte.
+  out.resize(in.size());
+  utf_result r =
+      in.size() ? convert_utf8_to_utf16(in.data(), in.size(), &out[0])
+                : __utf::ok(0);
+  out.resize((r.ec == errc()) ? r.count : 0);
+  return r;
+}
+
+inline utf_result utf8_to_utf32(string_view in, u32string &out) {
+  out.resize(in.size());
+  utf_result r =
+      in.size() ? convert_utf8_to_utf32(in.data(), in.size(), &out[0])
+                : __utf::ok(0);
+  out.resize((r.ec == errc()) ? r.count : 0);
+  return r;
+}
+
+inline utf_result utf16_to_utf8(basic_string_view<char16_t> in,
+                                string &out) {
+  // At most 3 bytes per UTF-16 unit.
+  out.resize(in.size() * 3);
+  utf_result r =
+      in.size() ? convert_utf16_to_utf8(in.data(), in.size(), &out[0])
+                : __utf::ok(0);
+  out.resize((r.ec == errc()) ? r.count : 0);
+  return r;
+}
+
+inline utf_result utf32_to_utf8(basic_string_view<char32_t> in,
+                                string &out) {
+  out.resize(in.size() * 4);
+  utf_result r =
+      in.size() ? convert_utf32_to_utf8(in.data(), in.size(), &out[0])
+                : __utf::ok(0);
+  out.resize((r.ec == errc()) ? r.count : 0);
+  return r;
+}
+
+}  // namespace nanostl
+
+#endif  // NANOSTL_UNICODE_H_
@@ -34,8 +34,8 @@ template <class T1, class T2>
 struct pair {
   T1 first;
   T2 second;
-  pair() {}
-  pair(const T1& a, const T2& b) : first(a), second(b) {}
+  constexpr pair() : first(), second() {}
+  constexpr pair(const T1& a, const T2& b) : first(a), second(b) {}
 };
 
 template <class T1, class T2>
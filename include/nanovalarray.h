@@ -47,6 +47,8 @@ namespace nanostl {
 // TODO(LTE): Support allocator.
 template <class T, class Allocator = nanostl::allocator<T> >
 class valarray {
+  typedef allocator_traits<Allocator> __traits;
+
  public:
   typedef T value_type;
   typedef T& reference;
@@ -74,6 +76,7 @@ class valarray {
 
   NANOSTL_HOST_AND_DEVICE_QUAL
   ~valarray() {
+    clear();
     allocator_type allocator;
     if (elements_) {
       allocator.deallocate(elements_, capacity_);
@@ -100,9 +103,8 @@ class valarray {
       value_type* new_elements = allocator.allocate(n);
       size_type new_capacity = n;
 
-      for (size_type i = 0; i < size(); i++) {
-        new_elements[i] = elements_[i];
-      }
+      uninitialized_move(elements_, elements_ + size_, new_elements);
+      destroy(elements_, elements_ + size_);
 
       // delete old buffer
       allocator.deallocate(elements_, capacity_);
@@ -111,6 +113,14 @@ class valarray {
       capacity_ = new_capacity;
     }
 
+    allocator_type allocator;
+    for (size_type i = size_; i < count; i++) {
+      __traits::construct(allocator, elements_ + i);
+    }
+    for (size_type i = count; i < size_; i++) {
+      __traits::destroy(allocator, elements_ + i);
+    }
+
     size_ = count;
   }
 
@@ -121,7 +131,10 @@ class valarray {
   size_type size() const { return size_; }
 
   NANOSTL_HOST_AND_DEVICE_QUAL
-  void clear() { size_ = 0; }
+  void clear() {
+    destroy(elements_, elements_ + size_);
+    size_ = 0;
+  }
 
   NANOSTL_HOST_AND_DEVICE_QUAL
   size_type capacity() const { return capacity_; }
@@ -154,6 +167,7 @@ class valarray {
       pos++;
     }
     size_--;
+    destroy_at(elements_ + size_);
 
     return pos;
   }
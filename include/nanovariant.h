@@ -1,7 +1,14 @@
 #ifndef NANOSTL_VARIANT_H_
 #define NANOSTL_VARIANT_H_
 
+// nonstd/variant.hpp uses `nullptr` outside of namespace nanostl, where the
+// `nullptr` macro from __nullptr(__get_nullptr_t()) does not resolve. Include
+// __nullptr first so the macro isn't defined again halfway through.
+#include "__nullptr"
+#pragma push_macro("nullptr")
+#undef nullptr
 #include <nonstd/variant.hpp>
+#pragma pop_macro("nullptr")
 
 namespace nanostl {
 
@@ -11,4 +18,9 @@ using nonstd::get_if;
 
 } // nanostl
 
+// `hash_append` for variant lives in nanohash_append.h.
+#if defined(NANOSTL_HASH_APPEND_H_)
+#include "nanohash_append.h"
+#endif
+
 #endif // NANOSTL_VARIANT_H_
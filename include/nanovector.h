@@ -44,9 +44,16 @@ namespace nanostl {
 #endif
 #endif
 
-// TODO(LTE): Support allocator.
+// `Allocator` may be stateful(e.g. `arena_allocator`). Copies use the
+// allocator of the source, assignment keeps its own and swap exchanges them.
+//
+// Only [0, size()) holds constructed elements, the rest of the capacity is
+// raw storage.
 template <class T, class Allocator = nanostl::allocator<T> >
-class vector {
+class vector : private __allocator_holder<Allocator> {
+  typedef __allocator_holder<Allocator> __base;
+  typedef allocator_traits<Allocator> __traits;
+
  public:
   typedef T value_type;
   typedef T& reference;
@@ -59,18 +66,28 @@ class vector {
 
   NANOSTL_HOST_AND_DEVICE_QUAL vector() : elements_(0), capacity_(0), size_(0) {}
 
-  NANOSTL_HOST_AND_DEVICE_QUAL vector(const vector& rhs) {
+  NANOSTL_HOST_AND_DEVICE_QUAL explicit vector(const allocator_type& alloc)
+      : __base(alloc), elements_(0), capacity_(0), size_(0) {}
+
+  NANOSTL_HOST_AND_DEVICE_QUAL vector(const vector& rhs)
+      : __base(rhs.get_allocator()) {
     __initialize();
-    assign(rhs.begin(), rhs.end());
+    reserve(rhs.size());
+    uninitialized_copy(rhs.begin(), rhs.end(), elements_);
+    size_ = rhs.size();
   }
 
   NANOSTL_HOST_AND_DEVICE_QUAL ~vector() {
-    allocator_type allocator;
+    clear();
     if (elements_) {
-      allocator.deallocate(elements_, capacity_);
+      this->__alloc().deallocate(elements_, capacity_);
     }
   }
 
+  NANOSTL_HOST_AND_DEVICE_QUAL allocator_type get_allocator() const {
+    return this->__alloc();
+  }
+
   reference at(size_type pos) {
     // TODO(LTE): out-of-range check.
     return elements_[pos];
@@ -81,51 +98,43 @@ class vector {
     return elements_[pos];
   }
 
+  // New elements are value initialized.
   NANOSTL_HOST_AND_DEVICE_QUAL void resize(size_type count) {
-    if (count < 1) {
-      return;
-    }
-
-    if (count > capacity()) {
-      // TODO(LTE): Use memcpy() or realloc() like functionality to speed up
-      // resizing.
-      size_type n = (count > recommended_size()) ? count : recommended_size();
-#ifdef NANOSTL_DEBUG
-      std::cout << "vector::resize: count " << count << ", capacity "
-                << capacity() << ", recommended_size " << recommended_size()
-                << ", n " << n << std::endl;
-#endif
-      allocator_type allocator;
-
-      value_type* new_elements = allocator.allocate(n);
-      size_type new_capacity = n;
-
-      for (size_type i = 0; i < size(); i++) {
-        new_elements[i] = elements_[i];
-      }
+    __resize(count, /* value_init */ true);
+  }
 
-      // delete old buffer
-      allocator.deallocate(elements_, capacity_);
+  // Like resize(), but new elements are default initialized(left
+  // uninitialized for trivial types). For code which overwrites them anyway.
+  NANOSTL_HOST_AND_DEVICE_QUAL void __resize_default_init(size_type count) {
+    __resize(count, /* value_init */ false);
+  }
 
-      elements_ = new_elements;
-      capacity_ = new_capacity;
+  // Allocates storage for `n` elements(no construction).
+  NANOSTL_HOST_AND_DEVICE_QUAL void reserve(size_type n) {
+    if (n > capacity()) {
+      __reallocate(n);
     }
-
-    size_ = count;
   }
 
   NANOSTL_HOST_AND_DEVICE_QUAL void push_back(const value_type& val) {
-    resize(size() + 1);
-    elements_[size_ - 1] = val;
+    __emplace_back(val);
   }
 
-  // void push_back(value_type &val); // C++11
+  NANOSTL_HOST_AND_DEVICE_QUAL void push_back(value_type&& val) {
+    __emplace_back(__alloc_move(val));
+  }
 
   NANOSTL_HOST_AND_DEVICE_QUAL bool empty() const { return size_ == 0; }
 
   NANOSTL_HOST_AND_DEVICE_QUAL size_type size() const { return size_; }
 
-  NANOSTL_HOST_AND_DEVICE_QUAL void clear() { size_ = 0; }
+  NANOSTL_HOST_AND_DEVICE_QUAL void clear() {
+    allocator_type& allocator = this->__alloc();
+    for (size_type i = 0; i < size_; i++) {
+      __traits::destroy(allocator, elements_ + i);
+    }
+    size_ = 0;
+  }
 
   NANOSTL_HOST_AND_DEVICE_QUAL size_type capacity() const { return capacity_; }
 
@@ -147,14 +156,14 @@ class vector {
       // this should be undefined behavior
     }
     size_--;
+    __traits::destroy(this->__alloc(), elements_ + size_);
   }
 
   inline iterator erase(iterator pos) {
-    while ((pos + 1) != end()) {
-      (*pos) = *(pos + 1);
-      pos++;
+    for (iterator it = pos; (it + 1) != end(); it++) {
+      (*it) = __alloc_move(*(it + 1));
     }
-    size_--;
+    pop_back();
 
     return pos;
   }
@@ -168,6 +177,7 @@ class vector {
   }
 
   void swap(vector& x) {
+    __swap(this->__alloc(), x.__alloc());
     __swap(elements_, x.elements_);
     __swap(capacity_, x.capacity_);
     __swap(size_, x.size_);
@@ -187,12 +197,79 @@ class vector {
     y = c;
   }
 
+  NANOSTL_HOST_AND_DEVICE_QUAL void __resize(size_type count, bool value_init) {
+    if (count > capacity()) {
+      size_type n = (count > recommended_size()) ? count : recommended_size();
+#ifdef NANOSTL_DEBUG
+      std::cout << "vector::resize: count " << count << ", capacity "
+                << capacity() << ", recommended_size " << recommended_size()
+                << ", n " << n << std::endl;
+#endif
+      __reallocate(n);
+    }
+
+    allocator_type& allocator = this->__alloc();
+    for (size_type i = size_; i < count; i++) {
+      if (value_init) {
+        __traits::construct(allocator, elements_ + i);
+      } else {
+        new (static_cast<void*>(elements_ + i), __placement_tag()) T;
+      }
+    }
+    for (size_type i = count; i < size_; i++) {
+      __traits::destroy(allocator, elements_ + i);
+    }
+
+    size_ = count;
+  }
+
   NANOSTL_HOST_AND_DEVICE_QUAL size_type recommended_size() const {
     // Simply use twice as large.
     size_type s = 2 * capacity();
     return s;
   }
 
+  // Moves the elements to new storage of `n` elements.
+  NANOSTL_HOST_AND_DEVICE_QUAL void __reallocate(size_type n) {
+    allocator_type& allocator = this->__alloc();
+    value_type* new_elements = allocator.allocate(n);
+    __relocate(new_elements);
+    elements_ = new_elements;
+    capacity_ = n;
+  }
+
+  // Moves the elements to `new_elements` and frees the old storage.
+  NANOSTL_HOST_AND_DEVICE_QUAL void __relocate(value_type* new_elements) {
+    allocator_type& allocator = this->__alloc();
+    uninitialized_move(elements_, elements_ + size_, new_elements);
+    for (size_type i = 0; i < size_; i++) {
+      __traits::destroy(allocator, elements_ + i);
+    }
+    if (elements_) {
+      allocator.deallocate(elements_, capacity_);
+    }
+  }
+
+  template <class Arg>
+  NANOSTL_HOST_AND_DEVICE_QUAL void __emplace_back(Arg&& arg) {
+    allocator_type& allocator = this->__alloc();
+    if (size_ == capacity_) {
+      const size_type n = (size_ > 0) ? recommended_size() : 1;
+      value_type* new_elements = allocator.allocate(n);
+      // Construct the new element first: `arg` may be an element of this
+      // vector.
+      __traits::construct(allocator, new_elements + size_,
+                          __alloc_forward<Arg>(arg));
+      __relocate(new_elements);
+      elements_ = new_elements;
+      capacity_ = n;
+    } else {
+      __traits::construct(allocator, elements_ + size_,
+                          __alloc_forward<Arg>(arg));
+    }
+    size_++;
+  }
+
   T* elements_;
   size_type capacity_;
   size_type size_;
@@ -6,14 +6,15 @@
 
 //#include <utility>
 
+// Disabled for nanostl: the checks below detect the host C++ library(e.g.
+// libstdc++ pulled in by <utility>), but the names are taken from nanostl,
+// which has no integer_sequence. tao/seq's own implementation is always used.
+#if 0
 #ifndef TAO_SEQ_USE_STD_INTEGER_SEQUENCE
 #if defined( __cpp_lib_integer_sequence )
 #define TAO_SEQ_USE_STD_INTEGER_SEQUENCE
 #elif defined( _LIBCPP_VERSION ) && ( __cplusplus >= 201402L )
 #define TAO_SEQ_USE_STD_INTEGER_SEQUENCE
-#elif defined( _MSC_VER )
-// Disabled for nanostl
-//#define TAO_SEQ_USE_STD_INTEGER_SEQUENCE
 #endif
 #endif
 
@@ -22,9 +23,7 @@
 #define TAO_SEQ_USE_STD_MAKE_INTEGER_SEQUENCE
 #elif defined( _LIBCPP_VERSION ) && ( __cplusplus >= 201402L )
 #define TAO_SEQ_USE_STD_MAKE_INTEGER_SEQUENCE
-#elif defined( _MSC_VER ) && ( _MSC_FULL_VER >= 190023918 )
-// Disabled for nanostl
-//#define TAO_SEQ_USE_STD_MAKE_INTEGER_SEQUENCE
+#endif
 #endif
 #endif
 
@@ -0,0 +1,122 @@
+// Container heavy workloads on the default allocator backend(malloc/free)
+// or mimalloc. Build both and compare:
+//
+//   $ ../../scripts/fetch_mimalloc.sh
+//   $ make containers containers_mimalloc
+//   $ ./containers_bench
+//   $ ./containers_mimalloc_bench
+//
+// Each workload runs on 1 and 4 threads(4 x the work).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "nanomap.h"
+#include "nanostring.h"
+#include "nanovector.h"
+
+template <class F>
+static double measure(F f) {
+  auto s = std::chrono::high_resolution_clock::now();
+  f();
+  auto e = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double, std::milli>(e - s).count();
+}
+
+static unsigned xorshift(unsigned &y) {
+  y ^= y << 13;
+  y ^= y >> 17;
+  y ^= y << 5;
+  return y;
+}
+
+static volatile unsigned long long g_sink;
+
+// vector<string> growth with heap(non SSO) strings.
+static void strings(unsigned seed) {
+  unsigned long long sum = 0;
+  for (int r = 0; r < 100; r++) {
+    nanostl::vector<nanostl::string> v;
+    for (int i = 0; i < 2000; i++) {
+      nanostl::string s("a string which does not fit in the SSO buffer");
+      s += char('a' + xorshift(seed) % 26);
+      v.push_back(s);
+    }
+    sum += v[v.size() - 1].size();
+  }
+  g_sink = sum;
+}
+
+// map insert/lookup(node allocations).
+static void maps(unsigned seed) {
+  unsigned long long sum = 0;
+  for (int r = 0; r < 20; r++) {
+    nanostl::map<int, int> m;
+    for (int i = 0; i < 5000; i++) {
+      m[int(xorshift(seed) % 20000)] = i;
+    }
+    sum += unsigned(m[7]);
+  }
+  g_sink = sum;
+}
+
+// Many short lived small vectors.
+static void small_vectors(unsigned seed) {
+  unsigned long long sum = 0;
+  for (int r = 0; r < 200000; r++) {
+    nanostl::vector<int> v;
+    const int n = 1 + int(xorshift(seed) % 32);
+    for (int i = 0; i < n; i++) {
+      v.push_back(i);
+    }
+    sum += v.size();
+  }
+  g_sink = sum;
+}
+
+static double run(int num_threads, void (*f)(unsigned)) {
+  return measure([&]() {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+      threads.push_back(std::thread(f, 1234u + unsigned(t)));
+    }
+    for (size_t t = 0; t < threads.size(); t++) {
+      threads[t].join();
+    }
+  });
+}
+
+int main(int argc, char **argv) {
+  (void)argc;
+  (void)argv;
+
+#if defined(NANOSTL_USE_MIMALLOC)
+  printf("backend: mimalloc\n");
+#else
+  printf("backend: malloc/free\n");
+#endif
+
+  struct workload {
+    const char *name;
+    void (*f)(unsigned);
+  } workloads[] = {{"vector<string>", strings},
+                   {"map<int, int>", maps},
+                   {"small vector<int>", small_vectors}};
+
+  printf("%-20s %12s %12s\n", "ms", "1 thread", "4 threads");
+  for (size_t i = 0; i < sizeof(workloads) / sizeof(workloads[0]); i++) {
+    printf("%-20s %12.2f %12.2f\n", workloads[i].name, run(1, workloads[i].f),
+           run(4, workloads[i].f));
+  }
+
+  const nanostl::allocator_stats st = nanostl::get_allocator_stats();
+  if (st.available) {
+    printf("\npeak commit %llu KB, peak rss %llu KB, page faults %llu\n",
+           st.peak_commit / 1024, st.peak_rss / 1024, st.page_faults);
+  }
+
+  return EXIT_SUCCESS;
+}
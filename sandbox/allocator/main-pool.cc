@@ -0,0 +1,119 @@
+// Multi-threaded small allocations: nanostl::allocator(new T[n]/delete[])
+// compared with nanostl::pool_allocator.
+//
+// Each thread keeps a set of live blocks and replaces a random one at each
+// step(sizes 8 to 512 bytes), then builds and destroys small vectors and
+// maps. Throughput is reported for 1, 2, 4 and 8 threads.
+//
+//   $ make pool
+//   $ ./pool_bench [steps per thread(2000000)]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "nanomap.h"
+#include "nanopool_allocator.h"
+#include "nanovector.h"
+
+template <class F>
+static double measure(F f) {
+  auto s = std::chrono::high_resolution_clock::now();
+  f();
+  auto e = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double, std::milli>(e - s).count();
+}
+
+static unsigned xorshift(unsigned &y) {
+  y ^= y << 13;
+  y ^= y >> 17;
+  y ^= y << 5;
+  return y;
+}
+
+// Random replacement in a working set of 1024 blocks.
+template <class Alloc>
+static void churn(size_t steps, unsigned seed) {
+  const size_t kLive = 1024;
+  Alloc alloc;
+  char *live[kLive];
+  size_t sizes[kLive];
+  for (size_t i = 0; i < kLive; i++) {
+    sizes[i] = 8 + (xorshift(seed) % 505);
+    live[i] = alloc.allocate(sizes[i]);
+  }
+  for (size_t i = 0; i < steps; i++) {
+    const size_t k = xorshift(seed) % kLive;
+    alloc.deallocate(live[k], sizes[k]);
+    sizes[k] = 8 + (xorshift(seed) % 505);
+    live[k] = alloc.allocate(sizes[k]);
+    live[k][0] = char(i);
+  }
+  for (size_t i = 0; i < kLive; i++) {
+    alloc.deallocate(live[i], sizes[i]);
+  }
+}
+
+// Short lived containers.
+template <template <class> class Alloc>
+static void containers(size_t steps, unsigned seed) {
+  size_t sum = 0;
+  for (size_t i = 0; i < steps / 64; i++) {
+    nanostl::vector<int, Alloc<int> > v;
+    const int n = 1 + int(xorshift(seed) % 64);
+    for (int k = 0; k < n; k++) {
+      v.push_back(k);
+    }
+    nanostl::map<int, int, nanostl::less<int>,
+                 Alloc<nanostl::pair<const int, int> > >
+        m;
+    for (int k = 0; k < 8; k++) {
+      m[int(xorshift(seed) % 32)] = k;
+    }
+    sum += v.size() + size_t(m[3]);
+  }
+  if (sum == 1) {
+    printf("\n");
+  }
+}
+
+template <class F>
+static double run_threads(int num_threads, size_t steps, F f) {
+  return measure([&]() {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+      threads.push_back(std::thread(f, steps, 1234u + unsigned(t)));
+    }
+    for (size_t t = 0; t < threads.size(); t++) {
+      threads[t].join();
+    }
+  });
+}
+
+int main(int argc, char **argv) {
+  const size_t steps = (argc > 1) ? size_t(atol(argv[1])) : 2000000;
+
+  printf("M ops/s(all threads)    churn            containers\n");
+  printf("%8s  %10s %10s  %10s %10s\n", "threads", "new[]", "pool", "new[]",
+         "pool");
+  for (int t = 1; t <= 8; t *= 2) {
+    const double ops = double(steps) * t / 1e3;
+    const double a =
+        run_threads(t, steps, churn<nanostl::allocator<char> >);
+    const double b =
+        run_threads(t, steps, churn<nanostl::pool_allocator<char> >);
+    const double c = run_threads(t, steps, containers<nanostl::allocator>);
+    const double d =
+        run_threads(t, steps, containers<nanostl::pool_allocator>);
+    printf("%8d  %10.1f %10.1f  %10.1f %10.1f\n", t, ops / a, ops / b,
+           ops / c, ops / d);
+  }
+
+  const nanostl::pool_stats st = nanostl::get_pool_stats();
+  printf("\npool reserved %llu KB, %llu magazines in the central pool\n",
+         st.reserved_bytes / 1024, st.central_magazines);
+
+  return EXIT_SUCCESS;
+}
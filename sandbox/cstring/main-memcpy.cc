@@ -0,0 +1,107 @@
+// nanostl::memcpy/memmove/memset compared with the C library at sizes from
+// 1 byte to 64 MB. Small sizes are measured with varying offsets so that
+// each size class sees misaligned pointers.
+//
+//   $ make memcpy
+//   $ ./memcpy_bench
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+#include "nanocstring.h"
+
+typedef void *(*copy_fn)(void *, const void *, size_t);
+typedef void *(*fill_fn)(void *, int, size_t);
+
+static void *nano_memcpy(void *d, const void *s, size_t n) {
+  return nanostl::memcpy(d, s, n);
+}
+static void *nano_memmove(void *d, const void *s, size_t n) {
+  return nanostl::memmove(d, s, n);
+}
+static void *nano_memset(void *d, int c, size_t n) {
+  return nanostl::memset(d, c, n);
+}
+
+template <class F>
+static double measure(F f) {
+  auto s = std::chrono::high_resolution_clock::now();
+  f();
+  auto e = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double, std::milli>(e - s).count();
+}
+
+// Number of calls so that each measurement copies about 1 GB(at least 8
+// calls).
+static size_t iterations(size_t n) {
+  size_t it = (size_t(1) << 30) / n;
+  return (it < 8) ? 8 : it;
+}
+
+// `volatile` keeps the calls from being folded into the builtin.
+static volatile copy_fn g_libc_memcpy = memcpy;
+static volatile copy_fn g_libc_memmove = memmove;
+static volatile fill_fn g_libc_memset = memset;
+
+static double bench_copy(copy_fn fn, unsigned char *dst,
+                         const unsigned char *src, size_t n, bool overlap) {
+  const size_t it = iterations(n);
+  double ms = measure([&]() {
+    for (size_t i = 0; i < it; i++) {
+      const size_t off = (n < 4096) ? (i & 63) : 0;
+      if (overlap) {
+        fn(dst + off + 1, dst + off, n);
+      } else {
+        fn(dst + off, src + (off ^ 7), n);
+      }
+    }
+  });
+  return double(n) * double(it) / (ms * 1e6);
+}
+
+static double bench_fill(fill_fn fn, unsigned char *dst, size_t n) {
+  const size_t it = iterations(n);
+  double ms = measure([&]() {
+    for (size_t i = 0; i < it; i++) {
+      fn(dst + ((n < 4096) ? (i & 63) : 0), int(i), n);
+    }
+  });
+  return double(n) * double(it) / (ms * 1e6);
+}
+
+int main(int argc, char **argv) {
+  (void)argc;
+  (void)argv;
+
+  const size_t kMax = size_t(64) << 20;
+  unsigned char *src = static_cast<unsigned char *>(malloc(kMax + 128));
+  unsigned char *dst = static_cast<unsigned char *>(malloc(kMax + 128));
+  for (size_t i = 0; i < kMax + 128; i++) {
+    src[i] = (unsigned char)i;
+    dst[i] = 0;
+  }
+
+  printf("GB/s           memcpy          memmove(overlap)  memset\n");
+  printf("%10s  %7s %7s  %7s %7s  %7s %7s\n", "size", "libc", "nano", "libc",
+         "nano", "libc", "nano");
+  for (size_t n = 1; n <= kMax; n *= 2) {
+    for (size_t k = 0; k < ((n >= 16 && n < 4096) ? 2 : 1); k++) {
+      // Also measure a size between powers of two(odd tails).
+      const size_t size = k ? (n + n / 2 + 1) : n;
+      printf("%10zu  %7.2f %7.2f  %7.2f %7.2f  %7.2f %7.2f\n", size,
+             bench_copy(g_libc_memcpy, dst, src, size, false),
+             bench_copy(nano_memcpy, dst, src, size, false),
+             bench_copy(g_libc_memmove, dst, src, size, true),
+             bench_copy(nano_memmove, dst, src, size, true),
+             bench_fill(g_libc_memset, dst, size),
+             bench_fill(nano_memset, dst, size));
+    }
+  }
+
+  free(src);
+  free(dst);
+
+  return EXIT_SUCCESS;
+}
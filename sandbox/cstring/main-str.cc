@@ -0,0 +1,138 @@
+// nanostl strlen/strchr/strcmp/memchr/memcmp/strstr compared with the C
+// library for short(16 B), medium(256 B) and long(64 KB) strings.
+//
+//   $ make str
+//   $ ./str_bench
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+#include "nanocstring.h"
+
+template <class F>
+static double measure(F f) {
+  auto s = std::chrono::high_resolution_clock::now();
+  f();
+  auto e = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double, std::milli>(e - s).count();
+}
+
+// Function pointers keep the compiler from folding libc calls.
+static size_t (*volatile g_strlen)(const char *) = strlen;
+static int (*volatile g_strcmp)(const char *, const char *) = strcmp;
+static int (*volatile g_memcmp)(const void *, const void *, size_t) = memcmp;
+
+static volatile size_t g_sink;
+
+static void report(const char *name, double libc_ms, double nano_ms,
+                   double bytes) {
+  printf("  %-8s: libc %6.2f GB/s  nano %6.2f GB/s\n", name,
+         bytes / (libc_ms * 1e6), bytes / (nano_ms * 1e6));
+}
+
+static void run(size_t len) {
+  // 64 strings at different alignments.
+  const int kStrings = 64;
+  char *a[kStrings];
+  char *b[kStrings];
+  for (int k = 0; k < kStrings; k++) {
+    a[k] = static_cast<char *>(malloc(len + 64)) + (k % 32);
+    b[k] = static_cast<char *>(malloc(len + 64)) + ((k * 7) % 32);
+    for (size_t i = 0; i < len; i++) {
+      a[k][i] = b[k][i] = char('a' + (i % 23));
+    }
+    a[k][len] = b[k][len] = '\0';
+  }
+
+  const size_t it = (size_t(1) << 28) / (len + 1) / kStrings + 1;
+  const double bytes = double(len) * double(it) * kStrings;
+  size_t sum = 0;
+
+  printf("%zu bytes\n", len);
+
+  double l = measure([&]() {
+    for (size_t r = 0; r < it; r++)
+      for (int k = 0; k < kStrings; k++) sum += g_strlen(a[k]);
+  });
+  double n = measure([&]() {
+    for (size_t r = 0; r < it; r++)
+      for (int k = 0; k < kStrings; k++) sum += nanostl::strlen(a[k]);
+  });
+  report("strlen", l, n, bytes);
+
+  l = measure([&]() {
+    for (size_t r = 0; r < it; r++)
+      for (int k = 0; k < kStrings; k++) sum += size_t(strchr(a[k], '!'));
+  });
+  n = measure([&]() {
+    for (size_t r = 0; r < it; r++)
+      for (int k = 0; k < kStrings; k++)
+        sum += size_t(nanostl::strchr(a[k], '!'));
+  });
+  report("strchr", l, n, bytes);
+
+  l = measure([&]() {
+    for (size_t r = 0; r < it; r++)
+      for (int k = 0; k < kStrings; k++) sum += size_t(g_strcmp(a[k], b[k]));
+  });
+  n = measure([&]() {
+    for (size_t r = 0; r < it; r++)
+      for (int k = 0; k < kStrings; k++)
+        sum += size_t(nanostl::strcmp(a[k], b[k]));
+  });
+  report("strcmp", l, n, bytes);
+
+  l = measure([&]() {
+    for (size_t r = 0; r < it; r++)
+      for (int k = 0; k < kStrings; k++)
+        sum += size_t(g_memcmp(a[k], b[k], len));
+  });
+  n = measure([&]() {
+    for (size_t r = 0; r < it; r++)
+      for (int k = 0; k < kStrings; k++)
+        sum += size_t(nanostl::memcmp(a[k], b[k], len));
+  });
+  report("memcmp", l, n, bytes);
+
+  l = measure([&]() {
+    for (size_t r = 0; r < it; r++)
+      for (int k = 0; k < kStrings; k++)
+        sum += size_t(memchr(a[k], '!', len));
+  });
+  n = measure([&]() {
+    for (size_t r = 0; r < it; r++)
+      for (int k = 0; k < kStrings; k++)
+        sum += size_t(nanostl::memchr(a[k], '!', len));
+  });
+  report("memchr", l, n, bytes);
+
+  l = measure([&]() {
+    for (size_t r = 0; r < it; r++)
+      for (int k = 0; k < kStrings; k++) sum += size_t(strstr(a[k], "xyz"));
+  });
+  n = measure([&]() {
+    for (size_t r = 0; r < it; r++)
+      for (int k = 0; k < kStrings; k++)
+        sum += size_t(nanostl::strstr(a[k], "xyz"));
+  });
+  report("strstr", l, n, bytes);
+
+  g_sink = sum;
+  for (int k = 0; k < kStrings; k++) {
+    free(a[k] - (k % 32));
+    free(b[k] - ((k * 7) % 32));
+  }
+}
+
+int main(int argc, char **argv) {
+  (void)argc;
+  (void)argv;
+
+  run(16);
+  run(256);
+  run(64 * 1024);
+
+  return EXIT_SUCCESS;
+}
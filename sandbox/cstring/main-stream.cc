@@ -0,0 +1,189 @@
+// Streaming(non-temporal) copies and fills compared with normal stores on
+// buffers much larger than the cache.
+//
+// Besides bandwidth, it measures how much each variant disturbs a cache
+// resident working set(a random pointer chase):
+//
+//   - rewalk : time to walk the working set once right after the copy.
+//              Lines evicted by the copy have to come from memory again.
+//   - victim : pointer chase steps per second of a second thread while the
+//              copies run(needs a spare core to be meaningful).
+//
+//   $ make stream
+//   $ ./stream_bench [buffer MB(256)] [working set KB(4096)]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+// Never stream in `nanostl::memcpy`/`memset` so that they measure normal
+// stores, `memcpy_stream`/`memset_stream` measure non-temporal ones.
+#define NANOSTL_STREAM_THRESHOLD (~0ull)
+#include "nanocstring.h"
+
+typedef void *(*copy_fn)(void *, const void *, size_t);
+typedef void *(*fill_fn)(void *, int, size_t);
+
+static void *nano_memcpy(void *d, const void *s, size_t n) {
+  return nanostl::memcpy(d, s, n);
+}
+static void *nano_memcpy_stream(void *d, const void *s, size_t n) {
+  return nanostl::memcpy_stream(d, s, n);
+}
+static void *nano_memset(void *d, int c, size_t n) {
+  return nanostl::memset(d, c, n);
+}
+static void *nano_memset_stream(void *d, int c, size_t n) {
+  return nanostl::memset_stream(d, c, n);
+}
+
+// `volatile` keeps the calls from being folded into the builtin.
+static volatile copy_fn g_libc_memcpy = memcpy;
+static volatile fill_fn g_libc_memset = memset;
+
+template <class F>
+static double measure(F f) {
+  auto s = std::chrono::high_resolution_clock::now();
+  f();
+  auto e = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double, std::milli>(e - s).count();
+}
+
+// Working set: one index per cache line, linked in a random cycle.
+struct line {
+  size_t next;
+  char pad[64 - sizeof(size_t)];
+};
+
+static size_t g_chase_pos = 0;
+
+static size_t chase(const line *ws, size_t steps) {
+  size_t p = g_chase_pos;
+  for (size_t i = 0; i < steps; i++) {
+    p = ws[p].next;
+  }
+  g_chase_pos = p;
+  return p;
+}
+
+static std::atomic<bool> g_stop(false);
+static std::atomic<unsigned long long> g_victim_steps(0);
+
+static volatile size_t g_sink;
+
+static void victim(const line *ws) {
+  size_t p = 0;
+  while (!g_stop.load(std::memory_order_relaxed)) {
+    for (int i = 0; i < 1024; i++) {
+      p = ws[p].next;
+    }
+    g_victim_steps.fetch_add(1024, std::memory_order_relaxed);
+  }
+  g_sink = p;
+}
+
+struct result {
+  double gbps;
+  double rewalk_ms;
+};
+
+template <class F>
+static result run(F f, size_t bytes, const line *ws, size_t ws_lines) {
+  const int kRepeat = 4;
+  double total_ms = 0.0, rewalk_ms = 0.0;
+  for (int r = 0; r < kRepeat; r++) {
+    chase(ws, ws_lines);  // warm
+    total_ms += measure(f);
+    rewalk_ms += measure([&]() { chase(ws, ws_lines); });
+  }
+  result res;
+  res.gbps = double(bytes) * kRepeat / (total_ms * 1e6);
+  res.rewalk_ms = rewalk_ms / kRepeat;
+  return res;
+}
+
+template <class F>
+static double victim_rate(F f, const line *ws) {
+  g_stop = false;
+  g_victim_steps = 0;
+  std::thread th(victim, ws);
+  const double ms = measure([&]() {
+    for (int r = 0; r < 4; r++) {
+      f();
+    }
+  });
+  const unsigned long long steps = g_victim_steps.load();
+  g_stop = true;
+  th.join();
+  return double(steps) / (ms * 1e3);  // M steps/s
+}
+
+int main(int argc, char **argv) {
+  const size_t mb = (argc > 1) ? size_t(atoi(argv[1])) : 256;
+  const size_t ws_kb = (argc > 2) ? size_t(atoi(argv[2])) : 4096;
+  const size_t n = mb << 20;
+
+  unsigned char *src = static_cast<unsigned char *>(malloc(n + 64));
+  unsigned char *dst = static_cast<unsigned char *>(malloc(n + 64));
+  for (size_t i = 0; i < n + 64; i++) {
+    src[i] = (unsigned char)i;
+    dst[i] = 0;
+  }
+
+  const size_t ws_lines = (ws_kb << 10) / sizeof(line);
+  line *ws = new line[ws_lines];
+  for (size_t i = 0; i < ws_lines; i++) {
+    ws[i].next = i;
+  }
+  // Sattolo's shuffle: a single cycle through every line.
+  srand(1234);
+  for (size_t i = ws_lines - 1; i > 0; i--) {
+    const size_t j = size_t(rand()) % i;
+    const size_t t = ws[i].next;
+    ws[i].next = ws[j].next;
+    ws[j].next = t;
+  }
+
+  chase(ws, ws_lines);
+  const double warm_ms = measure([&]() { chase(ws, ws_lines); });
+  printf("buffer %zu MB, working set %zu KB(warm walk %.3f ms)\n\n", mb, ws_kb,
+         warm_ms);
+
+  struct copy_case {
+    const char *name;
+    copy_fn fn;
+  } copies[] = {{"libc memcpy", g_libc_memcpy},
+                {"nano memcpy", nano_memcpy},
+                {"nano memcpy_stream", nano_memcpy_stream}};
+  struct fill_case {
+    const char *name;
+    fill_fn fn;
+  } fills[] = {{"libc memset", g_libc_memset},
+               {"nano memset", nano_memset},
+               {"nano memset_stream", nano_memset_stream}};
+
+  printf("%-20s %8s %12s %16s\n", "", "GB/s", "rewalk ms", "victim Msteps/s");
+  for (size_t i = 0; i < sizeof(copies) / sizeof(copies[0]); i++) {
+    const copy_fn fn = copies[i].fn;
+    auto f = [&]() { fn(dst, src, n); };
+    const result r = run(f, n, ws, ws_lines);
+    printf("%-20s %8.2f %12.3f %16.1f\n", copies[i].name, r.gbps, r.rewalk_ms,
+           victim_rate(f, ws));
+  }
+  for (size_t i = 0; i < sizeof(fills) / sizeof(fills[0]); i++) {
+    const fill_fn fn = fills[i].fn;
+    auto f = [&]() { fn(dst, int(i), n); };
+    const result r = run(f, n, ws, ws_lines);
+    printf("%-20s %8.2f %12.3f %16.1f\n", fills[i].name, r.gbps, r.rewalk_ms,
+           victim_rate(f, ws));
+  }
+
+  delete[] ws;
+  free(src);
+  free(dst);
+
+  return EXIT_SUCCESS;
+}
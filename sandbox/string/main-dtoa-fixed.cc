@@ -0,0 +1,90 @@
+// Fixed/scientific double to text with precision: to_chars compared with
+// snprintf("%.*f")/("%.*e").
+//
+//   $ make dtoa-fixed
+//   $ ./dtoa_fixed_bench
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+#include "nanocharconv.h"
+#include "nanovector.h"
+
+template <class F>
+static double measure(F f) {
+  auto s = std::chrono::high_resolution_clock::now();
+  f();
+  auto e = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double, std::milli>(e - s).count();
+}
+
+static void report(const char *name, double ms, int n) {
+  printf("  %-22s: %8.2f ms %7.1f M/s\n", name, ms, n / ms / 1000.0);
+}
+
+int main(int argc, char **argv) {
+  (void)argc;
+  (void)argv;
+
+  const int kN = 2000000;
+
+  nanostl::vector<double> values;
+  unsigned long long rng = 0x9E3779B97F4A7C15ull;
+  for (int i = 0; i < kN; i++) {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    values.push_back(double(rng >> 11) / double(1ull << 53) * 2000.0 - 1000.0);
+  }
+
+  const int kPrecisions[] = {2, 6, 17};
+  char buf[128];
+  unsigned long long sum = 0;
+
+  for (int pi = 0; pi < 3; pi++) {
+    const int precision = kPrecisions[pi];
+    printf("%d doubles in [-1000, 1000), precision %d\n", kN, precision);
+
+    double ms = measure([&]() {
+      for (int i = 0; i < kN; i++) {
+        sum += unsigned(snprintf(buf, sizeof(buf), "%.*f", precision,
+                                 values[i]));
+      }
+    });
+    report("snprintf %.*f", ms, kN);
+
+    ms = measure([&]() {
+      for (int i = 0; i < kN; i++) {
+        nanostl::to_chars_result r =
+            nanostl::to_chars(buf, buf + sizeof(buf), values[i],
+                              nanostl::chars_format::fixed, precision);
+        sum += unsigned(r.ptr - buf);
+      }
+    });
+    report("to_chars fixed", ms, kN);
+
+    ms = measure([&]() {
+      for (int i = 0; i < kN; i++) {
+        sum += unsigned(snprintf(buf, sizeof(buf), "%.*e", precision,
+                                 values[i]));
+      }
+    });
+    report("snprintf %.*e", ms, kN);
+
+    ms = measure([&]() {
+      for (int i = 0; i < kN; i++) {
+        nanostl::to_chars_result r =
+            nanostl::to_chars(buf, buf + sizeof(buf), values[i],
+                              nanostl::chars_format::scientific, precision);
+        sum += unsigned(r.ptr - buf);
+      }
+    });
+    report("to_chars scientific", ms, kN);
+  }
+
+  printf("(%llu)\n", sum);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,75 @@
+// Bulk float/double to text: format_numbers(serial and multithreaded)
+// compared with appending to_string() per value.
+//
+//   $ make format-bulk
+//   $ ./format_bulk_bench
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+#define NANOSTL_STRING_IMPLEMENTATION
+#include "nanostring.h"
+#include "nanoformat_numbers.h"
+
+template <class F>
+static double measure(F f) {
+  auto s = std::chrono::high_resolution_clock::now();
+  f();
+  auto e = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double, std::milli>(e - s).count();
+}
+
+static void report(const char *name, double ms, unsigned long long bytes,
+                   unsigned long long n) {
+  printf("  %-18s: %8.2f ms %6.2f GB/s %7.1f M/s\n", name, ms,
+         double(bytes) / (ms * 1e6), double(n) / ms / 1000.0);
+}
+
+int main(int argc, char **argv) {
+  (void)argc;
+  (void)argv;
+
+  const int kN = 4000000;
+
+  nanostl::vector<double> values;
+  unsigned long long rng = 0x9E3779B97F4A7C15ull;
+  for (int i = 0; i < kN; i++) {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    values.push_back(double(rng >> 11) / double(1ull << 53) * 2000.0 - 1000.0);
+  }
+
+  unsigned long long bytes = 0;
+
+  printf("%d doubles\n", kN);
+
+  double ts_ms = measure([&]() {
+    nanostl::string out;
+    for (int i = 0; i < kN; i++) {
+      out += nanostl::to_string(values[i]);
+      out += "\n";
+    }
+    bytes = out.size();
+  });
+  report("to_string", ts_ms, bytes, kN);
+
+  double serial_ms = measure([&]() {
+    nanostl::string out;
+    nanostl::format_numbers(out, values.data(), values.size());
+    bytes = out.size();
+  });
+  report("format_numbers", serial_ms, bytes, kN);
+
+  nanostl::format_numbers_options options;
+  options.num_threads = 0;
+  double parallel_ms = measure([&]() {
+    nanostl::string out;
+    nanostl::format_numbers(out, values.data(), values.size(), options);
+    bytes = out.size();
+  });
+  report("format_numbers(mt)", parallel_ms, bytes, kN);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,121 @@
+// Integer to decimal text: to_chars/to_string compared with the previous
+// digit-at-a-time + reverse implementation.
+//
+//   $ make itoa
+//   $ ./itoa_bench
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+#include "nanostring.h"
+#include "nanocharconv.h"
+
+template <class F>
+static double measure(F f) {
+  auto s = std::chrono::high_resolution_clock::now();
+  f();
+  auto e = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double, std::milli>(e - s).count();
+}
+
+// Previous implementation of `to_string(int64_t)`(without the truncation to
+// int), writing to a buffer.
+static int legacy_itoa(long long value, char *buffer) {
+  unsigned long long n = (value < 0) ? 0 - (unsigned long long)value
+                                     : (unsigned long long)value;
+  int i = 0;
+  while (n) {
+    buffer[i++] = char('0' + (n % 10));
+    n = n / 10;
+  }
+  if (i == 0) {
+    buffer[i++] = '0';
+  }
+  if (value < 0) {
+    buffer[i++] = '-';
+  }
+  for (int a = 0, b = i - 1; a < b; a++, b--) {
+    char tmp = buffer[a];
+    buffer[a] = buffer[b];
+    buffer[b] = tmp;
+  }
+  return i;
+}
+
+static void run(const char *name, const long long *values, int n) {
+  char buf[32];
+  unsigned long long bytes = 0;
+
+  double legacy_ms = measure([&]() {
+    for (int i = 0; i < n; i++) {
+      bytes += (unsigned long long)legacy_itoa(values[i], buf);
+    }
+  });
+
+  double to_chars_ms = measure([&]() {
+    for (int i = 0; i < n; i++) {
+      nanostl::to_chars_result r =
+          nanostl::to_chars(buf, buf + sizeof(buf), values[i]);
+      bytes += (unsigned long long)(r.ptr - buf);
+    }
+  });
+
+  double snprintf_ms = measure([&]() {
+    for (int i = 0; i < n; i++) {
+      bytes +=
+          (unsigned long long)snprintf(buf, sizeof(buf), "%lld", values[i]);
+    }
+  });
+
+  double to_string_ms = measure([&]() {
+    for (int i = 0; i < n; i++) {
+      bytes += nanostl::to_string(values[i]).size();
+    }
+  });
+
+  printf("%s(%d numbers)\n", name, n);
+  printf("  legacy loop : %8.2f ms (%6.1f M/s)\n", legacy_ms,
+         n / legacy_ms / 1000.0);
+  printf("  snprintf    : %8.2f ms (%6.1f M/s)\n", snprintf_ms,
+         n / snprintf_ms / 1000.0);
+  printf("  to_chars    : %8.2f ms (%6.1f M/s)\n", to_chars_ms,
+         n / to_chars_ms / 1000.0);
+  printf("  to_string   : %8.2f ms (%6.1f M/s)\n", to_string_ms,
+         n / to_string_ms / 1000.0);
+  printf("  %llu\n", bytes);
+}
+
+int main(int argc, char **argv) {
+  (void)argc;
+  (void)argv;
+
+  const int kN = 10000000;
+  long long *values = new long long[kN];
+  unsigned long long rng = 0x9E3779B97F4A7C15ull;
+  for (int i = 0; i < kN; i++) {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    values[i] = (long long)(rng >> 1);
+  }
+  run("int64, 19 digits", values, kN);
+
+  for (int i = 0; i < kN; i++) {
+    values[i] = (long long)(unsigned(values[i]) >> 8);
+  }
+  run("int32, 7-8 digits", values, kN);
+
+  for (int i = 0; i < kN; i++) {
+    // Mixed lengths(branch unfriendly)
+    values[i] = values[i] >> (values[i] % 24);
+    if (i & 1) {
+      values[i] = -values[i];
+    }
+  }
+  run("mixed lengths", values, kN);
+
+  delete[] values;
+
+  return 0;
+}
@@ -0,0 +1,92 @@
+// Bulk parsing of a text buffer into vector<double>: parse_numbers(serial and
+// multithreaded) compared with tokenizing + stod per token.
+//
+//   $ make parse-bulk
+//   $ ./parse_bulk_bench
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+#define NANOSTL_STRING_IMPLEMENTATION
+#include "nanostring.h"
+#include "nanoparse_numbers.h"
+
+template <class F>
+static double measure(F f) {
+  auto s = std::chrono::high_resolution_clock::now();
+  f();
+  auto e = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double, std::milli>(e - s).count();
+}
+
+static void report(const char *name, double ms, unsigned long long bytes,
+                   unsigned long long n) {
+  printf("  %-18s: %8.2f ms %6.2f GB/s %7.1f M/s\n", name, ms,
+         double(bytes) / (ms * 1e6), double(n) / ms / 1000.0);
+}
+
+int main(int argc, char **argv) {
+  (void)argc;
+  (void)argv;
+
+  const int kN = 4000000;
+
+  // OBJ/CSV like text: 3 numbers per line.
+  nanostl::string text;
+  unsigned long long rng = 0x9E3779B97F4A7C15ull;
+  char buf[64];
+  for (int i = 0; i < kN; i++) {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    double d = double(rng >> 11) / double(1ull << 53) * 2000.0 - 1000.0;
+    int len = snprintf(buf, sizeof(buf), (i % 3 == 2) ? "%.9g\n" : "%.9g, ", d);
+    text.append(buf, nanostl::string::size_type(len));
+  }
+
+  const char *first = text.data();
+  const char *last = first + text.size();
+  double sum = 0.0;
+
+  printf("%d numbers, %llu bytes\n", kN, text.size());
+
+  double stod_ms = measure([&]() {
+    nanostl::vector<double> out;
+    nanostl::string::size_type pos = 0;
+    for (;;) {
+      pos = text.find_first_not_of(" \t\r\n,", pos);
+      if (pos == nanostl::string::npos) {
+        break;
+      }
+      nanostl::string::size_type end = text.find_first_of(" \t\r\n,", pos);
+      if (end == nanostl::string::npos) {
+        end = text.size();
+      }
+      out.push_back(nanostl::stod(nanostl::string(first + pos, end - pos)));
+      pos = end;
+    }
+    sum += out[out.size() - 1];
+  });
+  report("token + stod", stod_ms, text.size(), kN);
+
+  double serial_ms = measure([&]() {
+    nanostl::vector<double> out;
+    nanostl::parse_numbers(first, last, out);
+    sum += out[out.size() - 1];
+  });
+  report("parse_numbers", serial_ms, text.size(), kN);
+
+  nanostl::parse_numbers_options options;
+  options.num_threads = 0;
+  double parallel_ms = measure([&]() {
+    nanostl::vector<double> out;
+    nanostl::parse_numbers(first, last, out, options);
+    sum += out[out.size() - 1];
+  });
+  report("parse_numbers(mt)", parallel_ms, text.size(), kN);
+
+  printf("(sum %g)\n", sum);
+
+  return EXIT_SUCCESS;
+}
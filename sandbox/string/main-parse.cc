@@ -0,0 +1,124 @@
+// Decimal text to double/int: from_chars(fast_float) compared with the
+// previous ryu s2d_n path and strtod.
+//
+//   $ make parse
+//   $ ./parse_bench
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+#include "nanostring.h"
+#include "nanocharconv.h"
+
+template <class F>
+static double measure(F f) {
+  auto s = std::chrono::high_resolution_clock::now();
+  f();
+  auto e = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double, std::milli>(e - s).count();
+}
+
+static void report(const char *name, double ms, unsigned long long bytes,
+                   int n) {
+  printf("  %-10s: %8.2f ms %6.2f GB/s %7.1f M/s\n", name, ms,
+         double(bytes) / (ms * 1e6), n / ms / 1000.0);
+}
+
+int main(int argc, char **argv) {
+  (void)argc;
+  (void)argv;
+
+  const int kN = 2000000;
+
+  // Newline separated numbers.
+  nanostl::string text;
+  nanostl::vector<unsigned long long> offsets;
+  unsigned long long rng = 0x9E3779B97F4A7C15ull;
+  char buf[64];
+  for (int i = 0; i < kN; i++) {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    double d = double(rng >> 11) / double(1ull << 53) * 2000.0 - 1000.0;
+    int len = snprintf(buf, sizeof(buf), "%.17g\n", d);
+    offsets.push_back(text.size());
+    text.append(buf, nanostl::string::size_type(len));
+  }
+  offsets.push_back(text.size());
+
+  const char *base = text.data();
+  double sum = 0.0;
+
+  printf("double(%d numbers, %llu bytes)\n", kN, text.size());
+
+  double ryu_ms = measure([&]() {
+    for (int i = 0; i < kN; i++) {
+      double v;
+      nanostl::ryu::s2d_n(base + offsets[i],
+                          int(offsets[i + 1] - offsets[i] - 1), &v);
+      sum += v;
+    }
+  });
+  report("ryu s2d_n", ryu_ms, text.size(), kN);
+
+  double strtod_ms = measure([&]() {
+    for (int i = 0; i < kN; i++) {
+      sum += strtod(base + offsets[i], 0);
+    }
+  });
+  report("strtod", strtod_ms, text.size(), kN);
+
+  double fc_ms = measure([&]() {
+    const char *p = base;
+    const char *end = base + text.size();
+    while (p < end) {
+      double v;
+      nanostl::from_chars_result r = nanostl::from_chars(p, end, v);
+      sum += v;
+      p = r.ptr + 1;
+    }
+  });
+  report("from_chars", fc_ms, text.size(), kN);
+
+  // Integers
+  nanostl::string itext;
+  for (int i = 0; i < kN; i++) {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    nanostl::to_chars_result r =
+        nanostl::to_chars(buf, buf + sizeof(buf), (long long)(rng >> 20));
+    *r.ptr++ = '\n';
+    itext.append(buf, nanostl::string::size_type(r.ptr - buf));
+  }
+
+  printf("int64(%d numbers, %llu bytes)\n", kN, itext.size());
+
+  unsigned long long isum = 0;
+  double strtoll_ms = measure([&]() {
+    char *p = const_cast<char *>(itext.data());
+    char *end = p + itext.size();
+    while (p < end) {
+      isum += (unsigned long long)strtoll(p, &p, 10);
+      p++;
+    }
+  });
+  report("strtoll", strtoll_ms, itext.size(), kN);
+
+  double ifc_ms = measure([&]() {
+    const char *p = itext.data();
+    const char *end = p + itext.size();
+    while (p < end) {
+      long long v;
+      nanostl::from_chars_result r = nanostl::from_chars(p, end, v);
+      isum += (unsigned long long)v;
+      p = r.ptr + 1;
+    }
+  });
+  report("from_chars", ifc_ms, itext.size(), kN);
+
+  printf("%f %llu\n", sum, isum);
+
+  return 0;
+}
@@ -0,0 +1,91 @@
+// rope compared with basic_string for building a multi MB text by inserting
+// short pieces at random positions, and by appending.
+//
+//   $ make rope
+//   $ ./rope_bench
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+#include "nanorope.h"
+
+template <class F>
+static double measure(F f) {
+  auto s = std::chrono::high_resolution_clock::now();
+  f();
+  auto e = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double, std::milli>(e - s).count();
+}
+
+static unsigned long long g_rng = 0x9E3779B97F4A7C15ull;
+
+static unsigned long long next_random() {
+  g_rng ^= g_rng << 13;
+  g_rng ^= g_rng >> 7;
+  g_rng ^= g_rng << 17;
+  return g_rng;
+}
+
+int main(int argc, char **argv) {
+  (void)argc;
+  (void)argv;
+
+  const int kInserts = 40000;
+  const nanostl::string_view piece("0123456789abcdefghijklmnopqrstu\n");
+
+  unsigned long long sum = 0;
+
+  {
+    g_rng = 0x9E3779B97F4A7C15ull;
+    nanostl::string s;
+    double ms = measure([&]() {
+      for (int i = 0; i < kInserts; i++) {
+        s.insert(next_random() % (s.size() + 1), piece);
+      }
+    });
+    sum += s.size();
+    printf("string insert : %10.2f ms (%llu bytes)\n", ms, s.size());
+  }
+
+  {
+    g_rng = 0x9E3779B97F4A7C15ull;
+    nanostl::rope r;
+    nanostl::string flat;
+    double ms = measure([&]() {
+      for (int i = 0; i < kInserts; i++) {
+        r.insert(next_random() % (r.size() + 1), piece);
+      }
+    });
+    double flat_ms = measure([&]() { flat = r.str(); });
+    sum += flat.size();
+    printf("rope insert   : %10.2f ms (depth %d), str() %.2f ms\n", ms,
+           r.depth(), flat_ms);
+  }
+
+  {
+    nanostl::string s;
+    double ms = measure([&]() {
+      for (int i = 0; i < kInserts * 10; i++) {
+        s += piece;
+      }
+    });
+    sum += s.size();
+    printf("string append : %10.2f ms\n", ms);
+  }
+
+  {
+    nanostl::rope r;
+    double ms = measure([&]() {
+      for (int i = 0; i < kInserts * 10; i++) {
+        r += piece;
+      }
+    });
+    sum += r.size();
+    printf("rope append   : %10.2f ms\n", ms);
+  }
+
+  printf("%llu\n", sum);
+
+  return 0;
+}
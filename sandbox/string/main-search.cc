@@ -0,0 +1,150 @@
+// basic_string::find* (SIMD kernels) compared with naive byte loops on a
+// multi MB input.
+//
+//   $ make search
+//   $ ./search_bench
+//
+// Build with -mavx2 or -mssse3 to enable the wider/nibble table kernels.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+#include "nanostring.h"
+
+template <class F>
+static double measure(F f) {
+  auto s = std::chrono::high_resolution_clock::now();
+  f();
+  auto e = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double, std::milli>(e - s).count();
+}
+
+typedef nanostl::string::size_type size_type;
+
+static size_type naive_find_char(const nanostl::string &s, char c,
+                                 size_type pos) {
+  for (size_type i = pos; i < s.size(); i++) {
+    if (s[i] == c) {
+      return i;
+    }
+  }
+  return nanostl::string::npos;
+}
+
+static size_type naive_find(const nanostl::string &s, const char *needle,
+                            size_type m, size_type pos) {
+  for (size_type i = pos; i + m <= s.size(); i++) {
+    size_type k = 0;
+    while ((k < m) && (s[i + k] == needle[k])) {
+      k++;
+    }
+    if (k == m) {
+      return i;
+    }
+  }
+  return nanostl::string::npos;
+}
+
+static size_type naive_find_first_of(const nanostl::string &s,
+                                     const char *set, size_type k,
+                                     size_type pos) {
+  for (size_type i = pos; i < s.size(); i++) {
+    for (size_type j = 0; j < k; j++) {
+      if (s[i] == set[j]) {
+        return i;
+      }
+    }
+  }
+  return nanostl::string::npos;
+}
+
+// Count all occurrences.
+template <class F>
+static size_type count_all(F find_next) {
+  size_type count = 0;
+  size_type pos = 0;
+  for (;;) {
+    size_type r = find_next(pos);
+    if (r == nanostl::string::npos) {
+      break;
+    }
+    count++;
+    pos = r + 1;
+  }
+  return count;
+}
+
+int main(int argc, char **argv) {
+  size_type n = 16 * 1024 * 1024;
+  if (argc > 1) {
+    n = size_type(atoll(argv[1]));
+  }
+
+  // Lower case words separated by a space, rare newline and ';'.
+  nanostl::string text;
+  {
+    char *buf = new char[n];
+    unsigned int seed = 12345;
+    for (size_type i = 0; i < n; i++) {
+      seed = seed * 1103515245u + 12345u;
+      unsigned int r = (seed >> 16) & 0x7fff;
+      if ((r % 4096) == 0) {
+        buf[i] = '\n';
+      } else if ((r % 8192) == 1) {
+        buf[i] = ';';
+      } else if ((r % 7) == 0) {
+        buf[i] = ' ';
+      } else {
+        buf[i] = char('a' + (r % 26));
+      }
+    }
+    text = nanostl::string(buf, n);
+    delete[] buf;
+  }
+
+  printf("input: %llu bytes\n", n);
+
+  const char *needle = "needle";
+  const size_type m = 6;
+  const char *set = "\n;#";
+  const size_type k = 3;
+
+  size_type c0 = 0, c1 = 0;
+  double t0, t1;
+
+  t0 = measure([&]() {
+    c0 = count_all([&](size_type p) { return text.find('\n', p); });
+  });
+  t1 = measure([&]() {
+    c1 = count_all([&](size_type p) { return naive_find_char(text, '\n', p); });
+  });
+  printf("find(char)      : %8.2f ms, naive %8.2f ms(%llu, %llu)\n", t0, t1,
+         c0, c1);
+
+  t0 = measure([&]() {
+    c0 = count_all([&](size_type p) { return text.find(needle, p, m); });
+  });
+  t1 = measure([&]() {
+    c1 = count_all([&](size_type p) { return naive_find(text, needle, m, p); });
+  });
+  printf("find(substr)    : %8.2f ms, naive %8.2f ms(%llu, %llu)\n", t0, t1,
+         c0, c1);
+
+  t0 = measure([&]() {
+    c0 = count_all([&](size_type p) {
+      return text.find_first_of(nanostl::string_view(set, k), p);
+    });
+  });
+  t1 = measure([&]() {
+    c1 = count_all(
+        [&](size_type p) { return naive_find_first_of(text, set, k, p); });
+  });
+  printf("find_first_of   : %8.2f ms, naive %8.2f ms(%llu, %llu)\n", t0, t1,
+         c0, c1);
+
+  t0 = measure([&]() { c0 = text.rfind("zzzzzzzz"); });
+  printf("rfind(miss)     : %8.2f ms(%lld)\n", t0, (long long)c0);
+
+  return EXIT_SUCCESS;
+}
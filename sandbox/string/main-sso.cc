@@ -0,0 +1,119 @@
+// Allocation count and copy speed of short strings(SSO) compared with a
+// `vector<char>` backed string(the layout before SSO).
+//
+// Allocations are counted by the allocation profiler(NANOSTL_ALLOC_PROFILE,
+// see the Makefile), so timings include its small per-allocation cost.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+#include "nanoalloc_profile.h"
+#include "nanostring.h"
+#include "nanovector.h"
+
+static unsigned long long num_allocs() {
+  static nanostl::alloc_profile_site sites[nanostl::kAllocProfileMaxSites];
+  const unsigned long long n = nanostl::alloc_profile_snapshot(
+      sites, nanostl::kAllocProfileMaxSites);
+  unsigned long long count = 0;
+  for (unsigned long long i = 0; i < n && i < nanostl::kAllocProfileMaxSites;
+       i++) {
+    count += sites[i].alloc_count;
+  }
+  return count;
+}
+
+// Old layout: characters and '\0' in a vector<char>
+struct vector_string {
+  nanostl::vector<char> data_;
+
+  vector_string() {
+    data_.resize(1);
+    data_[0] = '\0';
+  }
+
+  explicit vector_string(const char *s) {
+    while (*s) {
+      data_.push_back(*s);
+      s++;
+    }
+    data_.push_back('\0');
+  }
+
+  vector_string(const vector_string &rhs) { data_ = rhs.data_; }
+};
+
+template <class F>
+static double measure(F f) {
+  auto s = std::chrono::high_resolution_clock::now();
+  f();
+  auto e = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double, std::milli>(e - s).count();
+}
+
+static const char *kKeys[] = {"position", "normal",    "texcoord0",
+                              "texcoord1", "tangent",  "joints_0",
+                              "weights_0", "color_0", "material_name"};
+static const int kNumKeys = sizeof(kKeys) / sizeof(kKeys[0]);
+
+int main(int argc, char **argv) {
+  (void)argv;
+  const int N = 1000000 * argc;
+
+  printf("sizeof(nanostl::string) = %d\n", int(sizeof(nanostl::string)));
+
+  {
+    unsigned long long n0 = num_allocs();
+    size_t total = 0;
+    double ms = measure([&]() {
+      for (int i = 0; i < N; i++) {
+        nanostl::string s(kKeys[i % kNumKeys]);
+        nanostl::string t(s);
+        total += t.size();
+      }
+    });
+    printf("sso    : construct + copy %8.2f ms, %llu allocs(%zu)\n", ms,
+           num_allocs() - n0, total);
+  }
+
+  {
+    unsigned long long n0 = num_allocs();
+    size_t total = 0;
+    double ms = measure([&]() {
+      for (int i = 0; i < N; i++) {
+        vector_string s(kKeys[i % kNumKeys]);
+        vector_string t(s);
+        total += t.data_.size() - 1;
+      }
+    });
+    printf("vector : construct + copy %8.2f ms, %llu allocs(%zu)\n", ms,
+           num_allocs() - n0, total);
+  }
+
+  {
+    unsigned long long n0 = num_allocs();
+    double ms = measure([&]() {
+      for (int i = 0; i < N; i++) {
+        nanostl::string s;
+        (void)s;
+      }
+    });
+    printf("sso    : default ctor     %8.2f ms, %llu allocs\n", ms,
+           num_allocs() - n0);
+  }
+
+  {
+    unsigned long long n0 = num_allocs();
+    double ms = measure([&]() {
+      for (int i = 0; i < N; i++) {
+        vector_string s;
+        (void)s;
+      }
+    });
+    printf("vector : default ctor     %8.2f ms, %llu allocs\n", ms,
+           num_allocs() - n0);
+  }
+
+  return EXIT_SUCCESS;
+}
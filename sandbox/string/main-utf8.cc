@@ -0,0 +1,168 @@
+// UTF-8 validation and transcoding throughput compared with a naive
+// byte-at-a-time decoder. Inputs: ASCII text, mixed Latin/CJK text and
+// emoji heavy text.
+//
+//   $ make utf8        # or utf8-avx2
+//   $ ./utf8_bench
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+#include "nanostring.h"
+#include "nanounicode.h"
+
+template <class F>
+static double measure(F f) {
+  auto s = std::chrono::high_resolution_clock::now();
+  f();
+  auto e = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double, std::milli>(e - s).count();
+}
+
+static void report(const char *name, double ms, unsigned long long bytes) {
+  printf("  %-22s: %8.2f ms %6.2f GB/s\n", name, ms,
+         double(bytes) / (ms * 1e6));
+}
+
+// Decodes one code point at a time, the usual hand written loop.
+static bool naive_utf8_to_utf32(const unsigned char *s, unsigned long long n,
+                                char32_t *out, unsigned long long *count) {
+  unsigned long long i = 0;
+  unsigned long long k = 0;
+  while (i < n) {
+    unsigned int c = s[i];
+    int len;
+    unsigned int min;
+    if (c < 0x80) {
+      out[k++] = c;
+      i++;
+      continue;
+    } else if ((c & 0xe0) == 0xc0) {
+      len = 2, c &= 0x1f, min = 0x80;
+    } else if ((c & 0xf0) == 0xe0) {
+      len = 3, c &= 0x0f, min = 0x800;
+    } else if ((c & 0xf8) == 0xf0) {
+      len = 4, c &= 0x07, min = 0x10000;
+    } else {
+      return false;
+    }
+    if (i + (unsigned long long)len > n) {
+      return false;
+    }
+    for (int j = 1; j < len; j++) {
+      if ((s[i + j] & 0xc0) != 0x80) {
+        return false;
+      }
+      c = (c << 6) | (s[i + j] & 0x3f);
+    }
+    if ((c < min) || (c > 0x10ffff) || ((c >= 0xd800) && (c <= 0xdfff))) {
+      return false;
+    }
+    out[k++] = c;
+    i += (unsigned long long)len;
+  }
+  *count = k;
+  return true;
+}
+
+static void run(const char *title, const nanostl::string &text) {
+  const unsigned long long n = text.size();
+  const unsigned char *p =
+      reinterpret_cast<const unsigned char *>(text.data());
+  const int kRepeat = 10;
+
+  printf("%s: %llu bytes\n", title, n);
+
+  nanostl::u32string u32;
+  u32.resize(n);
+  unsigned long long count = 0;
+  bool ok = true;
+
+  double ms = measure([&]() {
+    for (int r = 0; r < kRepeat; r++) {
+      ok &= naive_utf8_to_utf32(p, n, &u32[0], &count);
+    }
+  });
+  report("naive validate+decode", ms, n * kRepeat);
+
+  ms = measure([&]() {
+    for (int r = 0; r < kRepeat; r++) {
+      ok &= nanostl::validate_utf8(text.data(), n);
+    }
+  });
+  report("validate_utf8", ms, n * kRepeat);
+
+  ms = measure([&]() {
+    for (int r = 0; r < kRepeat; r++) {
+      ok &= nanostl::convert_utf8_to_utf32(text.data(), n, &u32[0]).ec ==
+            nanostl::errc();
+    }
+  });
+  report("utf8 -> utf32", ms, n * kRepeat);
+
+  nanostl::u16string u16;
+  u16.resize(n);
+  ms = measure([&]() {
+    for (int r = 0; r < kRepeat; r++) {
+      ok &= nanostl::convert_utf8_to_utf16(text.data(), n, &u16[0]).ec ==
+            nanostl::errc();
+    }
+  });
+  report("utf8 -> utf16", ms, n * kRepeat);
+
+  const unsigned long long n16 =
+      nanostl::utf16_length_from_utf8(text.data(), n);
+  nanostl::string back;
+  back.resize(n);
+  ms = measure([&]() {
+    for (int r = 0; r < kRepeat; r++) {
+      ok &= nanostl::convert_utf16_to_utf8(u16.data(), n16, &back[0]).ec ==
+            nanostl::errc();
+    }
+  });
+  report("utf16 -> utf8", ms, n * kRepeat);
+
+  if (!ok || (back != text)) {
+    printf("  conversion failed\n");
+  }
+}
+
+int main(int argc, char **argv) {
+  (void)argc;
+  (void)argv;
+
+  const unsigned long long kBytes = 16 * 1024 * 1024;
+
+  // Mostly ASCII with some accented Latin.
+  const char *latin[] = {"The quick brown fox ", "jumps over ", "the lazy dog. ",
+                         "Caf\xc3\xa9 cr\xc3\xa8me br\xc3\xbbl\xc3\xa9\x65. "};
+  // Japanese/Chinese mixed with ASCII punctuation.
+  const char *cjk[] = {"\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e", ", ",
+                       "\xe4\xb8\xad\xe6\x96\x87\xe6\x96\x87\xe6\x9c\xac",
+                       "\xe3\x81\x82\xe3\x81\x84\xe3\x81\x86 "};
+  // Emoji(4 byte sequences).
+  const char *emoji[] = {"\xf0\x9f\x98\x80", "\xf0\x9f\x9a\x80 ",
+                         "\xf0\x9f\x8c\x8d\xf0\x9f\x8e\x89", "ok "};
+
+  const char **sets[] = {0, latin, cjk, emoji};
+  const char *titles[] = {"ascii", "latin", "cjk", "emoji"};
+
+  for (int t = 0; t < 4; t++) {
+    nanostl::string text;
+    unsigned long long rng = 0x9E3779B97F4A7C15ull;
+    while (text.size() < kBytes) {
+      rng ^= rng << 13;
+      rng ^= rng >> 7;
+      rng ^= rng << 17;
+      if (sets[t]) {
+        text += sets[t][rng % 4];
+      } else {
+        text.push_back(char(' ' + (rng % 95)));
+      }
+    }
+    run(titles[t], text);
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,27 @@
+#!/bin/sh
+#
+# Fetches mimalloc into third_party/mimalloc(used by NANOSTL_USE_MIMALLOC).
+#
+# The release is pinned by MIMALLOC_TAG. Set MIMALLOC_URL to fetch from a
+# mirror.
+#
+
+set -e
+
+MIMALLOC_TAG=${MIMALLOC_TAG:-v2.1.2}
+MIMALLOC_URL=${MIMALLOC_URL:-https://github.com/microsoft/mimalloc}
+
+cd "$(dirname "$0")/.."
+
+if [ -f third_party/mimalloc/CMakeLists.txt ]; then
+  echo "third_party/mimalloc already exists"
+  exit 0
+fi
+
+# An empty directory(e.g. from an old submodule checkout) is replaced.
+if [ -d third_party/mimalloc ]; then
+  rmdir third_party/mimalloc
+fi
+mkdir -p third_party
+git clone --depth 1 --branch "${MIMALLOC_TAG}" "${MIMALLOC_URL}" \
+  third_party/mimalloc
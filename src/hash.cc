@@ -161,4 +161,96 @@ int siphash(const uint8_t *in, const size_t inlen, const uint8_t *k,
     return 0;
 }
 
+//
+// Streaming SipHash-2-4. Produces the same value as `siphash()` with 8 bytes
+// output.
+//
+
+static const uint8_t kSipHashZeroKey[16] = {0};
+
+siphash_hasher::siphash_hasher() { init(kSipHashZeroKey); }
+
+siphash_hasher::siphash_hasher(const uint8_t key[16]) { init(key); }
+
+void siphash_hasher::init(const uint8_t key[16]) {
+    const uint64_t k0 = U8TO64_LE(key);
+    const uint64_t k1 = U8TO64_LE(key + 8);
+    v_[0] = 0x736f6d6570736575 ^ k0;
+    v_[1] = 0x646f72616e646f6d ^ k1;
+    v_[2] = 0x6c7967656e657261 ^ k0;
+    v_[3] = 0x7465646279746573 ^ k1;
+    total_len_ = 0;
+    buf_len_ = 0;
+}
+
+void siphash_hasher::operator()(const void *key, size_t len) {
+    const uint8_t *in = static_cast<const uint8_t *>(key);
+    const uint8_t *end = in + len;
+    uint64_t v0 = v_[0];
+    uint64_t v1 = v_[1];
+    uint64_t v2 = v_[2];
+    uint64_t v3 = v_[3];
+    uint64_t m;
+    int i;
+
+    total_len_ += len;
+
+    if (buf_len_) {
+        while ((buf_len_ < 8) && (in != end)) {
+            buf_[buf_len_++] = *in++;
+        }
+        if (buf_len_ < 8) {
+            return;
+        }
+
+        m = U8TO64_LE(buf_);
+        v3 ^= m;
+        for (i = 0; i < cROUNDS; ++i)
+            SIPROUND;
+        v0 ^= m;
+        buf_len_ = 0;
+    }
+
+    for (; (end - in) >= 8; in += 8) {
+        m = U8TO64_LE(in);
+        v3 ^= m;
+        for (i = 0; i < cROUNDS; ++i)
+            SIPROUND;
+        v0 ^= m;
+    }
+
+    while (in != end) {
+        buf_[buf_len_++] = *in++;
+    }
+
+    v_[0] = v0;
+    v_[1] = v1;
+    v_[2] = v2;
+    v_[3] = v3;
+}
+
+siphash_hasher::operator result_type() const {
+    uint64_t v0 = v_[0];
+    uint64_t v1 = v_[1];
+    uint64_t v2 = v_[2];
+    uint64_t v3 = v_[3];
+    uint64_t b = ((uint64_t)total_len_) << 56;
+    int i;
+
+    for (uint32_t k = 0; k < buf_len_; k++) {
+        b |= ((uint64_t)buf_[k]) << (8 * k);
+    }
+
+    v3 ^= b;
+    for (i = 0; i < cROUNDS; ++i)
+        SIPROUND;
+    v0 ^= b;
+
+    v2 ^= 0xff;
+    for (i = 0; i < dROUNDS; ++i)
+        SIPROUND;
+
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
 } // namespace nanostl
@@ -0,0 +1,512 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 Light Transport Entertainment, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+#include "nanoalloc_profile.h"
+#include "nanomutex.h"
+
+#if defined(NANOSTL_ALLOC_PROFILE)
+
+namespace nanostl {
+
+#if defined(NANOSTL_NO_THREAD)
+#define NANOSTL_PROFILE_TLS
+#define NANOSTL_PROFILE_LOCK(r)
+#else
+#define NANOSTL_PROFILE_TLS thread_local
+#define NANOSTL_PROFILE_LOCK(r) lock_guard<mutex> __profile_guard((r).lock)
+#endif
+
+namespace {
+
+// Counters written by one thread and read by snapshots of other threads.
+#if defined(__GNUC__) || defined(__clang__)
+inline size_type load_relaxed(const size_type *p) {
+  return __atomic_load_n(p, __ATOMIC_RELAXED);
+}
+inline void store_relaxed(size_type *p, size_type v) {
+  __atomic_store_n(p, v, __ATOMIC_RELAXED);
+}
+inline size_type add_relaxed(size_type *p, size_type v) {
+  return __atomic_add_fetch(p, v, __ATOMIC_RELAXED);
+}
+inline void max_relaxed(size_type *p, size_type v) {
+  size_type cur = __atomic_load_n(p, __ATOMIC_RELAXED);
+  while ((v > cur) && !__atomic_compare_exchange_n(p, &cur, v, true,
+                                                   __ATOMIC_RELAXED,
+                                                   __ATOMIC_RELAXED)) {
+  }
+}
+#elif defined(_MSC_VER)
+inline volatile __int64 *interlocked_ptr(const size_type *p) {
+  return reinterpret_cast<volatile __int64 *>(const_cast<size_type *>(p));
+}
+inline size_type load_relaxed(const size_type *p) {
+  return size_type(_InterlockedCompareExchange64(interlocked_ptr(p), 0, 0));
+}
+inline void store_relaxed(size_type *p, size_type v) {
+  __int64 cur = __int64(load_relaxed(p));
+  __int64 prev;
+  while ((prev = _InterlockedCompareExchange64(interlocked_ptr(p), __int64(v),
+                                               cur)) != cur) {
+    cur = prev;
+  }
+}
+inline size_type add_relaxed(size_type *p, size_type v) {
+  return size_type(_InterlockedExchangeAdd64(interlocked_ptr(p), __int64(v))) +
+         v;
+}
+inline void max_relaxed(size_type *p, size_type v) {
+  __int64 cur = __int64(load_relaxed(p));
+  while (v > size_type(cur)) {
+    const __int64 prev =
+        _InterlockedCompareExchange64(interlocked_ptr(p), __int64(v), cur);
+    if (prev == cur) {
+      break;
+    }
+    cur = prev;
+  }
+}
+#else
+// No atomics: the counters are guarded by one mutex.
+#if defined(NANOSTL_NO_THREAD)
+#define NANOSTL_PROFILE_COUNTER_LOCK()
+#else
+// Never destroyed, like the registry: frees at exit still count.
+mutex &counter_lock() {
+  static union {
+    char bytes[sizeof(mutex)];
+    void *align;
+  } storage;
+  static mutex *m = new (&storage, __placement_tag()) mutex();
+  return *m;
+}
+#define NANOSTL_PROFILE_COUNTER_LOCK() \
+  lock_guard<mutex> __counter_guard(counter_lock())
+#endif
+inline size_type load_relaxed(const size_type *p) {
+  NANOSTL_PROFILE_COUNTER_LOCK();
+  return *p;
+}
+inline void store_relaxed(size_type *p, size_type v) {
+  NANOSTL_PROFILE_COUNTER_LOCK();
+  *p = v;
+}
+inline size_type add_relaxed(size_type *p, size_type v) {
+  NANOSTL_PROFILE_COUNTER_LOCK();
+  return *p += v;
+}
+inline void max_relaxed(size_type *p, size_type v) {
+  NANOSTL_PROFILE_COUNTER_LOCK();
+  if (v > *p) {
+    *p = v;
+  }
+}
+#endif
+
+// Single writer increment.
+inline void bump(size_type *p, size_type v) {
+  store_relaxed(p, load_relaxed(p) + v);
+}
+
+const unsigned kMaxTypes = 256;
+const unsigned kTypeNameSize = 128;
+
+struct site_entry {
+  unsigned type_id;
+  const char *tag;
+  size_type live_bytes;  // atomic
+  size_type peak_bytes;  // atomic
+};
+
+struct site_counters {
+  size_type alloc_count;
+  size_type free_count;
+  size_type alloc_bytes;
+  size_type histogram[kAllocProfileBuckets];
+};
+
+struct thread_block {
+  site_counters sites[kAllocProfileMaxSites];
+  thread_block *next;       // all blocks
+  thread_block *next_free;  // blocks of exited threads
+};
+
+struct registry {
+  char type_names[kMaxTypes][kTypeNameSize];
+  unsigned num_types;
+  site_entry sites[kAllocProfileMaxSites];
+  unsigned num_sites;
+
+  thread_block *blocks;
+  thread_block *free_blocks;
+  // Counters of exited threads(and of allocations after a thread's exit).
+  thread_block retired;
+
+  bool leak_report;
+#if !defined(NANOSTL_NO_THREAD)
+  mutex lock;
+#endif
+};
+
+void report_at_exit();
+
+// Constructed on first use and never destroyed, so blocks freed by objects
+// with static storage duration are still accounted.
+registry &get_registry() {
+  static union {
+    char bytes[sizeof(registry)];
+    void *align;
+  } storage;
+  static registry *r = []() {
+    registry *reg =
+        new (&storage, __placement_tag()) registry();  // zero initialized
+    strcpy(reg->type_names[0], "(overflow)");
+    reg->num_types = 1;
+    reg->num_sites = 1;  // site 0: type 0, no tag
+    reg->leak_report = true;
+    atexit(report_at_exit);
+    return reg;
+  }();
+  return *r;
+}
+
+// Extracts `T` from the signature of `__alloc_profile_type<T>::id()`.
+void type_name_from_signature(const char *sig, char *name) {
+  const char *b = strstr(sig, "T = ");  // GCC, Clang
+  const char *e = 0;
+  if (b) {
+    b += 4;
+    e = b + strcspn(b, ";]");
+  } else if ((b = strstr(sig, "__alloc_profile_type<")) != 0) {  // MSVC
+    b += strlen("__alloc_profile_type<");
+    e = strstr(b, ">::id");
+  }
+  if (!b || !e) {
+    b = sig;
+    e = sig + strlen(sig);
+  }
+  size_t n = size_t(e - b);
+  if (n >= kTypeNameSize) {
+    n = kTypeNameSize - 1;
+  }
+  memcpy(name, b, n);
+  name[n] = '\0';
+}
+
+// Finds or adds the site. Called with the registry locked.
+unsigned find_site(registry &r, unsigned type_id, const char *tag) {
+  for (unsigned i = 1; i < r.num_sites; i++) {
+    if ((r.sites[i].type_id == type_id) && (r.sites[i].tag == tag)) {
+      return i;
+    }
+  }
+  if (r.num_sites == kAllocProfileMaxSites) {
+    return 0;
+  }
+  site_entry &s = r.sites[r.num_sites];
+  s.type_id = type_id;
+  s.tag = tag;
+  return r.num_sites++;
+}
+
+struct site_cache_entry {
+  unsigned type_id_plus_one;  // 0: empty
+  unsigned site;
+  const char *tag;
+};
+
+const unsigned kSiteCacheSize = 64;
+
+NANOSTL_PROFILE_TLS const char *t_tag;
+NANOSTL_PROFILE_TLS site_cache_entry t_site_cache[kSiteCacheSize];
+NANOSTL_PROFILE_TLS thread_block *t_block;
+NANOSTL_PROFILE_TLS bool t_block_dead;
+
+unsigned lookup_site(unsigned type_id, const char *tag) {
+  const unsigned h =
+      (type_id * 31u + unsigned(reinterpret_cast<size_type>(tag) >> 3)) &
+      (kSiteCacheSize - 1);
+  site_cache_entry &c = t_site_cache[h];
+  if ((c.type_id_plus_one == type_id + 1) && (c.tag == tag)) {
+    return c.site;
+  }
+  registry &r = get_registry();
+  unsigned site;
+  {
+    NANOSTL_PROFILE_LOCK(r);
+    site = find_site(r, type_id, tag);
+  }
+  c.type_id_plus_one = type_id + 1;
+  c.tag = tag;
+  c.site = site;
+  return site;
+}
+
+void add_counters(site_counters &d, const site_counters &s) {
+  d.alloc_count += load_relaxed(&s.alloc_count);
+  d.free_count += load_relaxed(&s.free_count);
+  d.alloc_bytes += load_relaxed(&s.alloc_bytes);
+  for (unsigned k = 0; k < kAllocProfileBuckets; k++) {
+    d.histogram[k] += load_relaxed(&s.histogram[k]);
+  }
+}
+
+void add_counters(thread_block &dst, const thread_block &src) {
+  for (unsigned i = 0; i < kAllocProfileMaxSites; i++) {
+    add_counters(dst.sites[i], src.sites[i]);
+  }
+}
+
+// Folds the counters of an exiting thread into `retired`.
+struct thread_block_owner {
+  thread_block *block;
+
+  ~thread_block_owner() {
+    t_block_dead = true;
+    t_block = 0;
+    if (!block) {
+      return;
+    }
+    registry &r = get_registry();
+    NANOSTL_PROFILE_LOCK(r);
+    add_counters(r.retired, *block);
+    memset(block->sites, 0, sizeof(block->sites));
+    block->next_free = r.free_blocks;
+    r.free_blocks = block;
+  }
+};
+
+NANOSTL_PROFILE_TLS thread_block_owner t_block_owner;
+
+// Counters of the calling thread. Null after the thread's exit.
+thread_block *my_block() {
+  if (t_block || t_block_dead) {
+    return t_block;
+  }
+  registry &r = get_registry();
+  thread_block *b;
+  {
+    NANOSTL_PROFILE_LOCK(r);
+    b = r.free_blocks;
+    if (b) {
+      r.free_blocks = b->next_free;
+    } else {
+      // Not through `allocator`(it would be profiled).
+      void *p = __raw_allocate(sizeof(thread_block), alignof(thread_block));
+      if (!p) {
+        return 0;  // counted in `retired` for now
+      }
+      b = new (p, __placement_tag()) thread_block();
+      b->next = r.blocks;
+      r.blocks = b;
+    }
+  }
+  t_block_owner.block = b;
+  t_block = b;
+  return b;
+}
+
+void count(unsigned site, size_type bytes, bool alloc) {
+  thread_block *b = my_block();
+  if (b) {
+    site_counters &c = b->sites[site];
+    if (alloc) {
+      bump(&c.alloc_count, 1);
+      bump(&c.alloc_bytes, bytes);
+      bump(&c.histogram[alloc_profile_bucket(bytes)], 1);
+    } else {
+      bump(&c.free_count, 1);
+    }
+    return;
+  }
+  registry &r = get_registry();
+  NANOSTL_PROFILE_LOCK(r);
+  site_counters &c = r.retired.sites[site];
+  if (alloc) {
+    c.alloc_count++;
+    c.alloc_bytes += bytes;
+    c.histogram[alloc_profile_bucket(bytes)]++;
+  } else {
+    c.free_count++;
+  }
+}
+
+void write_stderr(const char *line, void *arg) {
+  (void)arg;
+  fputs(line, stderr);
+}
+
+void report_at_exit() {
+  if (get_registry().leak_report) {
+    alloc_profile_report(/* leaks_only */ true, 0, 0);
+  }
+}
+
+}  // namespace
+
+unsigned __alloc_profile_type_id(const char *signature) {
+  char name[kTypeNameSize];
+  type_name_from_signature(signature, name);
+
+  registry &r = get_registry();
+  NANOSTL_PROFILE_LOCK(r);
+  for (unsigned i = 1; i < r.num_types; i++) {
+    if (strcmp(r.type_names[i], name) == 0) {
+      return i;
+    }
+  }
+  if (r.num_types == kMaxTypes) {
+    return 0;
+  }
+  memcpy(r.type_names[r.num_types], name, kTypeNameSize);
+  return r.num_types++;
+}
+
+unsigned __alloc_profile_allocate(unsigned type_id, size_type bytes) {
+  const unsigned site = lookup_site(type_id, t_tag);
+  count(site, bytes, /* alloc */ true);
+  site_entry &s = get_registry().sites[site];
+  max_relaxed(&s.peak_bytes, add_relaxed(&s.live_bytes, bytes));
+  return site;
+}
+
+void __alloc_profile_deallocate(unsigned site, size_type bytes) {
+  count(site, bytes, /* alloc */ false);
+  add_relaxed(&get_registry().sites[site].live_bytes, size_type(0) - bytes);
+}
+
+const char *alloc_profile_set_tag(const char *tag) {
+  const char *prev = t_tag;
+  t_tag = tag;
+  return prev;
+}
+
+void alloc_profile_set_leak_report(bool enable) {
+  get_registry().leak_report = enable;
+}
+
+size_type alloc_profile_snapshot(alloc_profile_site *sites,
+                                 size_type max_sites) {
+  registry &r = get_registry();
+
+  size_type n = 0;
+  {
+    NANOSTL_PROFILE_LOCK(r);
+    for (unsigned i = 0; i < r.num_sites; i++) {
+      // Sum of all threads.
+      site_counters c = r.retired.sites[i];
+      for (thread_block *b = r.blocks; b; b = b->next) {
+        add_counters(c, b->sites[i]);
+      }
+      if (c.alloc_count == 0) {
+        continue;
+      }
+      if (n < max_sites) {
+        alloc_profile_site &s = sites[n];
+        s.type_name = r.type_names[r.sites[i].type_id];
+        s.tag = r.sites[i].tag;
+        s.live_bytes = load_relaxed(&r.sites[i].live_bytes);
+        s.peak_bytes = load_relaxed(&r.sites[i].peak_bytes);
+        s.live_count = c.alloc_count - c.free_count;
+        s.alloc_count = c.alloc_count;
+        s.alloc_bytes = c.alloc_bytes;
+        for (unsigned k = 0; k < kAllocProfileBuckets; k++) {
+          s.histogram[k] = c.histogram[k];
+        }
+      }
+      n++;
+    }
+  }
+  return n;
+}
+
+void alloc_profile_report(bool leaks_only,
+                          void (*out)(const char *line, void *arg),
+                          void *arg) {
+  if (!out) {
+    out = write_stderr;
+  }
+
+  const size_type max_sites = kAllocProfileMaxSites;
+  alloc_profile_site *sites = static_cast<alloc_profile_site *>(__raw_allocate(
+      sizeof(alloc_profile_site) * max_sites, alignof(alloc_profile_site)));
+  if (!sites) {
+    out("nanostl: allocation profile: out of memory\n", arg);
+    return;
+  }
+  size_type n = alloc_profile_snapshot(sites, max_sites);
+  if (n > max_sites) {
+    n = max_sites;
+  }
+
+  // Largest live bytes first.
+  for (size_type i = 0; i < n; i++) {
+    for (size_type j = i + 1; j < n; j++) {
+      if (sites[j].live_bytes > sites[i].live_bytes) {
+        const alloc_profile_site t = sites[i];
+        sites[i] = sites[j];
+        sites[j] = t;
+      }
+    }
+  }
+
+  char line[256];
+  bool header = false;
+  for (size_type i = 0; i < n; i++) {
+    const alloc_profile_site &s = sites[i];
+    if (leaks_only && (s.live_count == 0)) {
+      continue;
+    }
+    if (!header) {
+      out(leaks_only ? "nanostl: live allocations at exit\n"
+                     : "nanostl: allocation profile\n",
+          arg);
+      snprintf(line, sizeof(line), "%14s %14s %10s %12s %14s  %s\n",
+               "live bytes", "peak bytes", "live", "allocs", "total bytes",
+               "type [tag]");
+      out(line, arg);
+      header = true;
+    }
+    snprintf(line, sizeof(line), "%14llu %14llu %10llu %12llu %14llu  %s%s%s%s\n",
+             s.live_bytes, s.peak_bytes, s.live_count, s.alloc_count,
+             s.alloc_bytes, s.type_name, s.tag ? " [" : "",
+             s.tag ? s.tag : "", s.tag ? "]" : "");
+    out(line, arg);
+  }
+
+  __raw_deallocate(sites, alignof(alloc_profile_site));
+}
+
+}  // namespace nanostl
+
+#endif  // NANOSTL_ALLOC_PROFILE
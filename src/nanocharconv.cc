@@ -0,0 +1,597 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 Light Transport Entertainment, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "nanocharconv.h"
+
+#include "fast_float/fast_float.h"
+
+namespace nanostl {
+
+namespace {
+
+template <class T>
+from_chars_result __from_chars_float(const char *first, const char *last,
+                                     T &value, chars_format fmt) {
+  from_chars_result r = {first, errc::invalid_argument};
+  if ((int(fmt) & int(chars_format::hex)) || (first == last)) {
+    return r;
+  }
+
+  T v;
+  fast_float::from_chars_result ret = fast_float::from_chars(
+      first, last, v, fast_float::chars_format(int(fmt)));
+  r.ptr = ret.ptr;
+  r.ec = ret.ec;
+  if (r.ec != errc()) {
+    return r;
+  }
+
+  // fast_float rounds too large values to inf. Report them as out of range
+  // unless "inf"/"infinity" was given.
+  IEEE754Double d;
+  d.f = double(v);
+  if (d.bits.exponent == 0x7ff && d.bits.mantissa == 0) {
+    const char *p = (*first == '-') ? first + 1 : first;
+    if ((*p != 'i') && (*p != 'I')) {
+      r.ec = errc::result_out_of_range;
+      return r;
+    }
+  }
+
+  value = v;
+  return r;
+}
+
+//
+// Exact decimal digits of m * 2^e(m > 0) for fixed/scientific output.
+//
+// The integer part(up to 309 digits) is converted up front by dividing a
+// bignum by 10^9. The fraction F / 2^k is kept as a bignum and multiplied by
+// 10^9 per 9 digit block; the bits shifted above 2^k are the next block.
+// Limbs that became zero at the low end are skipped, so typical values only
+// touch one or two limbs. Everything is on the stack.
+//
+class __exact_digits {
+ public:
+  __exact_digits(uint64_t m, int e) {
+    n_int_ = 0;
+    int_pos_ = 0;
+    block_left_ = 0;
+    frac_lo_ = 0;
+    frac_kw_ = 0;
+    frac_s_ = 0;
+    frac_zero_ = true;
+
+    if (e >= 0) {
+      if (e <= 11) {
+        __set_int_u64(m << e);
+      } else {
+        __set_int_big(m, e);
+      }
+      return;
+    }
+
+    const int k = -e;
+    const uint64_t ip = (k >= 64) ? 0 : (m >> k);
+    const uint64_t fp = (k >= 64) ? m : (m & ((1ull << k) - 1));
+    if (ip) {
+      __set_int_u64(ip);
+    }
+    if (fp) {
+      frac_kw_ = k / 32;
+      frac_s_ = k % 32;
+      for (int i = 0; i <= frac_kw_; i++) {
+        frac_[i] = 0;
+      }
+      frac_[0] = uint32_t(fp);
+      if (frac_kw_ >= 1) {
+        frac_[1] = uint32_t(fp >> 32);
+      }
+      frac_zero_ = false;
+    }
+  }
+
+  // Number of integer digits(0 if the integer part is 0).
+  int num_int_digits() const { return n_int_; }
+
+  // Next digit: integer digits first, then fraction digits('0' once the
+  // exact value is exhausted).
+  char next() {
+    if (int_pos_ < n_int_) {
+      return int_[int_pos_++];
+    }
+    if (block_left_ == 0) {
+      if (frac_zero_) {
+        return '0';
+      }
+      __next_block();
+    }
+    return block_[9 - block_left_--];
+  }
+
+  // True if any digit after the ones returned by next() is nonzero.
+  bool sticky() const {
+    for (int i = int_pos_; i < n_int_; i++) {
+      if (int_[i] != '0') {
+        return true;
+      }
+    }
+    for (int i = 9 - block_left_; i < 9; i++) {
+      if (block_[i] != '0') {
+        return true;
+      }
+    }
+    return !frac_zero_;
+  }
+
+ private:
+  // 2^1024 has 309 digits. Rounded up to 9 digit groups.
+  static const int kIntChars = 324;
+  // 2^-1074 needs 1074 fraction bits, plus the 10^9 overflow limb.
+  static const int kFracLimbs = 35;
+
+  void __set_int_u64(uint64_t v) {
+    const int n = int(__charconv::count_digits10(v));
+    __charconv::write10_u64(int_buf_ + n, v);
+    int_ = int_buf_;
+    n_int_ = n;
+  }
+
+  void __set_int_big(uint64_t m, int e) {
+    uint32_t limbs[kFracLimbs];
+    const int word = e / 32;
+    const int bit = e % 32;
+    for (int i = 0; i < word; i++) {
+      limbs[i] = 0;
+    }
+    // m < 2^53, so m << bit fits in 3 limbs.
+    const uint64_t lo = m << bit;
+    const uint64_t hi = bit ? (m >> (64 - bit)) : 0;
+    limbs[word] = uint32_t(lo);
+    limbs[word + 1] = uint32_t(lo >> 32);
+    limbs[word + 2] = uint32_t(hi);
+    int n = word + 3;
+    while (limbs[n - 1] == 0) {
+      n--;
+    }
+
+    char *end = int_buf_ + kIntChars;
+    char *p = end;
+    while (n > 0) {
+      uint64_t rem = 0;
+      for (int i = n - 1; i >= 0; i--) {
+        const uint64_t cur = (rem << 32) | limbs[i];
+        limbs[i] = uint32_t(cur / 1000000000ull);
+        rem = cur % 1000000000ull;
+      }
+      while ((n > 0) && (limbs[n - 1] == 0)) {
+        n--;
+      }
+      __charconv::write10_8digits(p, uint32_t(rem % 100000000ull));
+      p -= 9;
+      p[0] = char('0' + rem / 100000000ull);
+    }
+    while (*p == '0') {
+      p++;
+    }
+    int_ = p;
+    n_int_ = int(end - p);
+  }
+
+  void __next_block() {
+    uint64_t carry = 0;
+    for (int i = frac_lo_; i <= frac_kw_; i++) {
+      const uint64_t t = uint64_t(frac_[i]) * 1000000000ull + carry;
+      frac_[i] = uint32_t(t);
+      carry = t >> 32;
+    }
+    const uint32_t v =
+        uint32_t(((carry << 32) | frac_[frac_kw_]) >> frac_s_);
+    frac_[frac_kw_] &= frac_s_ ? ((1u << frac_s_) - 1) : 0u;
+    while ((frac_lo_ <= frac_kw_) && (frac_[frac_lo_] == 0)) {
+      frac_lo_++;
+    }
+    frac_zero_ = (frac_lo_ > frac_kw_);
+
+    block_[0] = char('0' + v / 100000000u);
+    __charconv::write10_8digits(block_ + 9, v % 100000000u);
+    block_left_ = 9;
+  }
+
+  char int_buf_[kIntChars];
+  const char *int_;
+  int n_int_;
+  int int_pos_;
+
+  uint32_t frac_[kFracLimbs];
+  int frac_lo_;  // lowest nonzero limb
+  int frac_kw_;  // limb holding bit k
+  int frac_s_;   // k % 32
+  bool frac_zero_;
+
+  char block_[9];
+  int block_left_;
+};
+
+// Rounds the digits in [begin, end) up by one ulp('.' is skipped). Returns
+// false if the carry went past `begin`(all nines, now all zeros).
+inline bool __round_up(char *begin, char *end) {
+  char *p = end;
+  while (p != begin) {
+    --p;
+    if (*p == '.') {
+      continue;
+    }
+    if (*p != '9') {
+      (*p)++;
+      return true;
+    }
+    *p = '0';
+  }
+  return false;
+}
+
+// Round half to even on the exact value.
+inline bool __need_round_up(__exact_digits &g, char last_digit) {
+  const char r = g.next();
+  if (r != '5') {
+    return r > '5';
+  }
+  return g.sticky() || ((last_digit - '0') & 1);
+}
+
+inline to_chars_result __too_large(char *last) {
+  to_chars_result r = {last, errc::value_too_large};
+  return r;
+}
+
+// Decoded |value| = m * 2^e.
+struct __decoded {
+  bool neg;
+  bool finite;
+  bool nan;
+  uint64_t m;
+  int e;
+};
+
+inline __decoded __decode(double value) {
+  IEEE754Double d;
+  d.f = value;
+  __decoded r;
+  r.neg = d.bits.sign != 0;
+  r.finite = d.bits.exponent != 0x7ff;
+  r.nan = !r.finite && (d.bits.mantissa != 0);
+  if (d.bits.exponent == 0) {
+    r.m = d.bits.mantissa;
+    r.e = 1 - 1075;
+  } else {
+    r.m = d.bits.mantissa | (1ull << 52);
+    r.e = int(d.bits.exponent) - 1075;
+  }
+  return r;
+}
+
+inline to_chars_result __to_chars_special(char *first, char *last,
+                                          const __decoded &v) {
+  const char *s = v.nan ? "nan" : "inf";
+  const long long n = 3 + (v.neg ? 1 : 0);
+  if (last - first < n) {
+    return __too_large(last);
+  }
+  char *p = first;
+  if (v.neg) {
+    *p++ = '-';
+  }
+  for (int i = 0; i < 3; i++) {
+    *p++ = s[i];
+  }
+  to_chars_result r = {p, errc()};
+  return r;
+}
+
+// printf("%.*f")
+to_chars_result __to_chars_fixed(char *first, char *last, const __decoded &v,
+                                 int precision) {
+  char *p = first;
+  if (v.neg) {
+    if (p == last) {
+      return __too_large(last);
+    }
+    *p++ = '-';
+  }
+
+  if (v.m == 0) {
+    const long long n = 1 + (precision ? precision + 1 : 0);
+    if (last - p < n) {
+      return __too_large(last);
+    }
+    *p++ = '0';
+    if (precision) {
+      *p++ = '.';
+      for (int i = 0; i < precision; i++) {
+        *p++ = '0';
+      }
+    }
+    to_chars_result r = {p, errc()};
+    return r;
+  }
+
+  __exact_digits g(v.m, v.e);
+  const int n_int = g.num_int_digits();
+  const long long n =
+      (n_int ? n_int : 1) + (precision ? (long long)precision + 1 : 0);
+  if (last - p < n) {
+    return __too_large(last);
+  }
+
+  char *digits = p;
+  if (n_int == 0) {
+    *p++ = '0';
+  }
+  for (int i = 0; i < n_int; i++) {
+    *p++ = g.next();
+  }
+  if (precision) {
+    *p++ = '.';
+    for (int i = 0; i < precision; i++) {
+      *p++ = g.next();
+    }
+  }
+
+  if (__need_round_up(g, p[-1])) {
+    if (!__round_up(digits, p)) {
+      // 99.9 -> 100.0
+      if (p == last) {
+        return __too_large(last);
+      }
+      for (char *q = p; q != digits; --q) {
+        q[0] = q[-1];
+      }
+      digits[0] = '1';
+      p++;
+    }
+  }
+
+  to_chars_result r = {p, errc()};
+  return r;
+}
+
+// Decimal exponent of `v` rounded to `precision + 1` significant digits.
+int __scientific_exponent(const __decoded &v, int precision) {
+  if (v.m == 0) {
+    return 0;
+  }
+  __exact_digits g(v.m, v.e);
+  int x = g.num_int_digits() - 1;
+  char d = g.next();
+  if (x < 0) {
+    while (d == '0') {
+      x--;
+      d = g.next();
+    }
+  }
+  bool all_nines = (d == '9');
+  char last_digit = d;
+  for (int i = 0; i < precision; i++) {
+    last_digit = g.next();
+    all_nines = all_nines && (last_digit == '9');
+  }
+  if (all_nines && __need_round_up(g, last_digit)) {
+    x++;
+  }
+  return x;
+}
+
+// printf("%.*e")
+to_chars_result __to_chars_scientific(char *first, char *last,
+                                      const __decoded &v, int precision) {
+  char *p = first;
+  if (v.neg) {
+    if (p == last) {
+      return __too_large(last);
+    }
+    *p++ = '-';
+  }
+
+  // digits + "e+dd"
+  const long long n = 1 + (precision ? (long long)precision + 1 : 0) + 4;
+  if (last - p < n) {
+    return __too_large(last);
+  }
+
+  int x = 0;
+  char *digits = p;
+  if (v.m == 0) {
+    *p++ = '0';
+    if (precision) {
+      *p++ = '.';
+      for (int i = 0; i < precision; i++) {
+        *p++ = '0';
+      }
+    }
+  } else {
+    __exact_digits g(v.m, v.e);
+    x = g.num_int_digits() - 1;
+    char d = g.next();
+    if (x < 0) {
+      while (d == '0') {
+        x--;
+        d = g.next();
+      }
+    }
+    *p++ = d;
+    if (precision) {
+      *p++ = '.';
+      for (int i = 0; i < precision; i++) {
+        *p++ = g.next();
+      }
+    }
+    if (__need_round_up(g, p[-1])) {
+      if (!__round_up(digits, p)) {
+        // 9.99e1 -> 1.00e2
+        digits[0] = '1';
+        x++;
+      }
+    }
+  }
+
+  const int ax = (x < 0) ? -x : x;
+  if ((ax >= 100) && (last - p < 5)) {
+    return __too_large(last);
+  }
+  *p++ = 'e';
+  *p++ = (x < 0) ? '-' : '+';
+  if (ax >= 100) {
+    *p++ = char('0' + ax / 100);
+  }
+  *p++ = char('0' + (ax / 10) % 10);
+  *p++ = char('0' + ax % 10);
+
+  to_chars_result r = {p, errc()};
+  return r;
+}
+
+// Removes trailing zeros(and '.') of the fraction in [digits, end).
+inline char *__strip_trailing_zeros(char *digits, char *end) {
+  char *dot = digits;
+  while ((dot != end) && (*dot != '.')) {
+    dot++;
+  }
+  if (dot == end) {
+    return end;
+  }
+  while (end[-1] == '0') {
+    end--;
+  }
+  if (end[-1] == '.') {
+    end--;
+  }
+  return end;
+}
+
+to_chars_result __to_chars_general_impl(char *first, char *last,
+                                        const __decoded &v, int precision) {
+  if (precision == 0) {
+    precision = 1;
+  }
+  const int x = __scientific_exponent(v, precision - 1);
+
+  if ((precision > x) && (x >= -4)) {
+    to_chars_result r = __to_chars_fixed(first, last, v, precision - 1 - x);
+    if (r.ec == errc()) {
+      r.ptr = __strip_trailing_zeros(first, r.ptr);
+    }
+    return r;
+  }
+
+  to_chars_result r = __to_chars_scientific(first, last, v, precision - 1);
+  if (r.ec == errc()) {
+    char *e = r.ptr - 1;
+    while (*e != 'e') {
+      e--;
+    }
+    char *mantissa_end = __strip_trailing_zeros(first, e);
+    char *q = mantissa_end;
+    for (char *s = e; s != r.ptr; s++) {
+      *q++ = *s;
+    }
+    r.ptr = q;
+  }
+  return r;
+}
+
+// printf("%.*g"). Trailing zeros are removed after formatting, so retry in a
+// local buffer if the unstripped text did not fit.
+to_chars_result __to_chars_general(char *first, char *last,
+                                   const __decoded &v, int precision) {
+  // A double has at most 767 significant digits, so more precision only adds
+  // zeros which are stripped anyway.
+  if (precision > 800) {
+    precision = 800;
+  }
+  to_chars_result r = __to_chars_general_impl(first, last, v, precision);
+  if (r.ec == errc()) {
+    return r;
+  }
+  char buf[832];
+  to_chars_result t = __to_chars_general_impl(buf, buf + sizeof(buf), v,
+                                              precision);
+  if ((t.ec != errc()) || (t.ptr - buf > last - first)) {
+    return __too_large(last);
+  }
+  for (char *s = buf; s != t.ptr; s++) {
+    *first++ = *s;
+  }
+  r.ptr = first;
+  r.ec = errc();
+  return r;
+}
+
+to_chars_result __to_chars_double(char *first, char *last, double value,
+                                  chars_format fmt, int precision) {
+  if (precision < 0) {
+    precision = 6;
+  }
+  const __decoded v = __decode(value);
+  if (!v.finite) {
+    return __to_chars_special(first, last, v);
+  }
+  switch (fmt) {
+    case chars_format::fixed:
+      return __to_chars_fixed(first, last, v, precision);
+    case chars_format::scientific:
+      return __to_chars_scientific(first, last, v, precision);
+    case chars_format::general:
+      return __to_chars_general(first, last, v, precision);
+    default:
+      break;
+  }
+  to_chars_result r = {last, errc::invalid_argument};
+  return r;
+}
+
+}  // namespace
+
+to_chars_result to_chars(char *first, char *last, float value,
+                         chars_format fmt, int precision) {
+  // float -> double is exact.
+  return __to_chars_double(first, last, double(value), fmt, precision);
+}
+
+to_chars_result to_chars(char *first, char *last, double value,
+                         chars_format fmt, int precision) {
+  return __to_chars_double(first, last, value, fmt, precision);
+}
+
+from_chars_result from_chars(const char *first, const char *last,
+                             float &value, chars_format fmt) {
+  return __from_chars_float(first, last, value, fmt);
+}
+
+from_chars_result from_chars(const char *first, const char *last,
+                             double &value, chars_format fmt) {
+  return __from_chars_float(first, last, value, fmt);
+}
+
+}  // namespace nanostl
@@ -0,0 +1,278 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 Light Transport Entertainment, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "nanoformat_numbers.h"
+#include "nanoallocator.h"
+#include "nanocstring.h"
+#include "__nanoparallel.h"
+#include "__nanostrutil.h"
+
+namespace nanostl {
+
+namespace {
+
+inline int __format_value(float v, char *dst) {
+  return ryu::f2s_buffered_n(v, dst);
+}
+
+inline int __format_value(double v, char *dst) {
+  return ryu::d2s_buffered_n(v, dst);
+}
+
+template <typename T>
+struct __format_traits;
+
+template <>
+struct __format_traits<float> {
+  static const int kMaxChars = kFormatFloatMaxChars;
+};
+
+template <>
+struct __format_traits<double> {
+  static const int kMaxChars = kFormatDoubleMaxChars;
+};
+
+struct __separator {
+  const char *s;
+  unsigned long long len;
+
+  explicit __separator(const char *sep) : s(sep ? sep : ""), len(0) {
+    while (s[len]) {
+      len++;
+    }
+  }
+};
+
+inline char *__write_separator(char *p, const __separator &sep) {
+  for (unsigned long long i = 0; i < sep.len; i++) {
+    p[i] = sep.s[i];
+  }
+  return p + sep.len;
+}
+
+// Formats values[0, n) into [first, last). `leading` writes a separator
+// before the first value(used for chunks other than the first).
+template <typename T>
+format_numbers_result __format_serial(char *first, char *last,
+                                      const T *values, unsigned long long n,
+                                      const __separator &sep, bool leading) {
+  const unsigned long long kMax = __format_traits<T>::kMaxChars;
+
+  format_numbers_result ret;
+  ret.ptr = first;
+  ret.ec = errc();
+  ret.count = 0;
+
+  char *p = first;
+  for (unsigned long long i = 0; i < n; i++) {
+    const unsigned long long sep_len = (leading || i) ? sep.len : 0;
+    const unsigned long long avail = (unsigned long long)(last - p);
+    if (avail >= sep_len + kMax) {
+      if (sep_len) {
+        p = __write_separator(p, sep);
+      }
+      p += __format_value(values[i], p);
+    } else {
+      // Near the end of the buffer: format into a temporary to check fit.
+      char tmp[__format_traits<T>::kMaxChars];
+      const int k = __format_value(values[i], tmp);
+      if (avail < sep_len + (unsigned long long)k) {
+        ret.ec = errc::value_too_large;
+        break;
+      }
+      if (sep_len) {
+        p = __write_separator(p, sep);
+      }
+      memcpy(p, tmp, (unsigned long long)k);
+      p += k;
+    }
+    ret.count++;
+    ret.ptr = p;
+  }
+  return ret;
+}
+
+template <typename T>
+struct __format_chunk {
+  const T *values;
+  unsigned long long n;
+  char *first;  // slot of worst case size
+  char *last;
+  format_numbers_result ret;
+};
+
+template <typename T>
+struct __format_ctx {
+  __format_chunk<T> *chunks;
+  const __separator *sep;
+};
+
+template <typename T>
+void __format_chunk_proc(void *p, unsigned index) {
+  __format_ctx<T> *ctx = static_cast<__format_ctx<T> *>(p);
+  __format_chunk<T> &c = ctx->chunks[index];
+  c.ret = __format_serial(c.first, c.last, c.values, c.n, *ctx->sep,
+                          /* leading */ index > 0);
+}
+
+template <typename T>
+format_numbers_result __format_numbers(char *first, char *last,
+                                       const T *values, unsigned long long n,
+                                       const format_numbers_options &options) {
+  const __separator sep(options.separator);
+
+  unsigned num_threads = 1;
+  if (options.num_threads != 1) {
+    num_threads =
+        __parallel_num_threads(options.num_threads, n, options.min_chunk_values);
+  }
+  if (num_threads == 1) {
+    return __format_serial(first, last, values, n, sep, false);
+  }
+
+  // Each chunk is formatted into its own worst case slot, then the slots are
+  // packed in order. Slots live in the output when it is large enough,
+  // otherwise in a scratch buffer. Without memory for the scratch buffer or
+  // the chunks, the values are formatted serially.
+  const unsigned long long slot_stride =
+      (unsigned long long)__format_traits<T>::kMaxChars + sep.len;
+  const unsigned long long worst = n * slot_stride;
+  const unsigned long long avail = (unsigned long long)(last - first);
+
+  allocator<char> char_alloc;
+  char *scratch = 0;
+  char *slots = first;
+  if (avail < worst) {
+    scratch = char_alloc.allocate(worst);
+    if (!scratch) {
+      return __format_serial(first, last, values, n, sep, false);
+    }
+    slots = scratch;
+  }
+
+  allocator<__format_chunk<T> > alloc;
+  __format_chunk<T> *chunks = alloc.allocate(num_threads);
+  if (!chunks) {
+    if (scratch) {
+      char_alloc.deallocate(scratch, worst);
+    }
+    return __format_serial(first, last, values, n, sep, false);
+  }
+  const unsigned long long per = n / num_threads;
+  unsigned long long begin = 0;
+  for (unsigned i = 0; i < num_threads; i++) {
+    const unsigned long long end = (i + 1 == num_threads) ? n : begin + per;
+    chunks[i].values = values + begin;
+    chunks[i].n = end - begin;
+    chunks[i].first = slots + begin * slot_stride;
+    chunks[i].last = slots + end * slot_stride;
+    begin = end;
+  }
+
+  __format_ctx<T> ctx;
+  ctx.chunks = chunks;
+  ctx.sep = &sep;
+  __parallel_run(num_threads, __format_chunk_proc<T>, &ctx);
+
+  format_numbers_result ret;
+  ret.ptr = first;
+  ret.ec = errc();
+  ret.count = 0;
+  for (unsigned i = 0; i < num_threads; i++) {
+    const __format_chunk<T> &c = chunks[i];
+    const unsigned long long len = (unsigned long long)(c.ret.ptr - c.first);
+    if ((unsigned long long)(last - ret.ptr) >= len) {
+      if (scratch) {
+        memcpy(ret.ptr, c.first, len);
+      } else {
+        memmove(ret.ptr, c.first, len);
+      }
+      ret.ptr += len;
+      ret.count += c.n;
+    } else {
+      // Does not fit. Write as many values of this chunk as possible.
+      format_numbers_result r = __format_serial(ret.ptr, last, c.values, c.n,
+                                                sep, /* leading */ i > 0);
+      ret.ptr = r.ptr;
+      ret.count += r.count;
+      ret.ec = errc::value_too_large;
+      break;
+    }
+  }
+
+  alloc.deallocate(chunks, num_threads);
+  if (scratch) {
+    char_alloc.deallocate(scratch, worst);
+  }
+  return ret;
+}
+
+template <typename T>
+unsigned long long __format_numbers(string &out, const T *values,
+                                    unsigned long long n,
+                                    const format_numbers_options &options) {
+  const unsigned long long worst =
+      format_numbers_max_size(n, __format_traits<T>::kMaxChars, options);
+  if (worst == 0) {
+    return 0;
+  }
+  const string::size_type base = out.size();
+  out.resize(base + worst);
+  char *first = &out[base];
+  format_numbers_result r =
+      __format_numbers(first, first + worst, values, n, options);
+  const unsigned long long len = (unsigned long long)(r.ptr - first);
+  out.resize(base + len);
+  return len;
+}
+
+}  // namespace
+
+format_numbers_result format_numbers(char *first, char *last,
+                                     const float *values, unsigned long long n,
+                                     const format_numbers_options &options) {
+  return __format_numbers(first, last, values, n, options);
+}
+
+format_numbers_result format_numbers(char *first, char *last,
+                                     const double *values,
+                                     unsigned long long n,
+                                     const format_numbers_options &options) {
+  return __format_numbers(first, last, values, n, options);
+}
+
+unsigned long long format_numbers(string &out, const float *values,
+                                  unsigned long long n,
+                                  const format_numbers_options &options) {
+  return __format_numbers(out, values, n, options);
+}
+
+unsigned long long format_numbers(string &out, const double *values,
+                                  unsigned long long n,
+                                  const format_numbers_options &options) {
+  return __format_numbers(out, values, n, options);
+}
+
+}  // namespace nanostl
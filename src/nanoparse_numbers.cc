@@ -0,0 +1,274 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 Light Transport Entertainment, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "nanoparse_numbers.h"
+#include "nanoallocator.h"
+#include "nanocharconv.h"
+#include "__nanoparallel.h"
+#include "__nanostrsearch.h"
+
+namespace nanostl {
+
+namespace {
+
+typedef __strsearch::__charset_finder __finder;
+
+// Values are staged here and appended to the output vector per block.
+const unsigned kBlockSize = 256;
+
+template <typename T>
+struct __block {
+  T values[kBlockSize];
+  unsigned n;
+
+  __block() : n(0) {}
+
+  void flush(vector<T> &out) {
+    if (n == 0) {
+      return;
+    }
+    const unsigned long long base = out.size();
+    out.__resize_default_init(base + n);
+    T *dst = out.data() + base;
+    for (unsigned i = 0; i < n; i++) {
+      dst[i] = values[i];
+    }
+    n = 0;
+  }
+};
+
+inline from_chars_result __parse_token(const char *first, const char *last,
+                                       float &value) {
+  return from_chars(first, last, value);
+}
+
+inline from_chars_result __parse_token(const char *first, const char *last,
+                                       double &value) {
+  return from_chars(first, last, value);
+}
+
+inline from_chars_result __parse_token(const char *first, const char *last,
+                                       int &value) {
+  return from_chars(first, last, value, 10);
+}
+
+// Parses [first, last) and appends to `out`. `ptr` is `last` on success.
+template <typename T>
+parse_numbers_result __parse_serial(const char *first, const char *last,
+                                    vector<T> &out, const __finder &finder) {
+  parse_numbers_result ret;
+  ret.ptr = last;
+  ret.ec = errc();
+  ret.count = 0;
+  ret.line = 0;
+
+  __block<T> block;
+  const char *p = first;
+  for (;;) {
+    // skip separators
+    unsigned long long i =
+        finder.find(p, (unsigned long long)(last - p), /* in */ false);
+    if (i == __strsearch::npos) {
+      break;
+    }
+    const char *token = p + i;
+    unsigned long long k =
+        finder.find(token, (unsigned long long)(last - token), /* in */ true);
+    const char *token_end = (k == __strsearch::npos) ? last : token + k;
+
+    const char *s = token;
+    if ((*s == '+') && (s + 1 < token_end) && (s[1] != '-')) {
+      s++;
+    }
+
+    T value;
+    from_chars_result r = __parse_token(s, token_end, value);
+    if ((r.ec == errc()) && (r.ptr != token_end)) {
+      r.ec = errc::invalid_argument;
+    }
+    if (r.ec != errc()) {
+      ret.ptr = token;
+      ret.ec = r.ec;
+      break;
+    }
+
+    block.values[block.n++] = value;
+    ret.count++;
+    if (block.n == kBlockSize) {
+      block.flush(out);
+    }
+
+    p = token_end;
+  }
+
+  block.flush(out);
+  return ret;
+}
+
+unsigned long long __count_lines(const char *first, const char *last) {
+  unsigned long long line = 1;
+  const char *p = first;
+  for (;;) {
+    unsigned long long i =
+        __strsearch::find_char(p, (unsigned long long)(last - p), '\n');
+    if (i == __strsearch::npos) {
+      break;
+    }
+    line++;
+    p += i + 1;
+  }
+  return line;
+}
+
+template <typename T>
+struct __chunk {
+  const char *first;
+  const char *last;
+  vector<T> values;
+  parse_numbers_result ret;
+};
+
+template <typename T>
+struct __parallel_ctx {
+  __chunk<T> *chunks;
+  const __finder *finder;
+};
+
+template <typename T>
+void __parse_chunk(void *p, unsigned index) {
+  __parallel_ctx<T> *ctx = static_cast<__parallel_ctx<T> *>(p);
+  __chunk<T> &c = ctx->chunks[index];
+  c.ret = __parse_serial(c.first, c.last, c.values, *ctx->finder);
+}
+
+template <typename T>
+parse_numbers_result __parse_numbers(const char *first, const char *last,
+                                     vector<T> &out,
+                                     const parse_numbers_options &options) {
+  const char *separators = options.separators ? options.separators : "";
+  unsigned long long num_separators = 0;
+  while (separators[num_separators]) {
+    num_separators++;
+  }
+  const __finder finder(separators, num_separators);
+
+  const unsigned long long len = (unsigned long long)(last - first);
+  unsigned num_threads = 1;
+  if (options.num_threads != 1) {
+    num_threads = __parallel_num_threads(options.num_threads, len,
+                                         options.min_chunk_bytes);
+  }
+
+  parse_numbers_result ret;
+  if (num_threads == 1) {
+    ret = __parse_serial(first, last, out, finder);
+  } else {
+    // Split at separators so that no token straddles two chunks.
+    allocator<__chunk<T> > alloc;
+    __chunk<T> *chunks = alloc.allocate(num_threads);
+    for (unsigned i = 0; i < num_threads; i++) {
+      allocator_traits<allocator<__chunk<T> > >::construct(alloc, chunks + i);
+    }
+    const char *p = first;
+    for (unsigned i = 0; i < num_threads; i++) {
+      chunks[i].first = p;
+      const char *e = (i + 1 == num_threads)
+                          ? last
+                          : first + (len / num_threads) * (i + 1);
+      if (e < p) {
+        e = p;
+      }
+      unsigned long long k =
+          finder.find(e, (unsigned long long)(last - e), /* in */ true);
+      e = (k == __strsearch::npos) ? last : e + k;
+      chunks[i].last = e;
+      p = e;
+    }
+
+    __parallel_ctx<T> ctx;
+    ctx.chunks = chunks;
+    ctx.finder = &finder;
+    __parallel_run(num_threads, __parse_chunk<T>, &ctx);
+
+    unsigned long long total = 0;
+    for (unsigned i = 0; i < num_threads; i++) {
+      total += chunks[i].ret.count;
+      if (chunks[i].ret.ec != errc()) {
+        break;
+      }
+    }
+
+    const unsigned long long base = out.size();
+    if (total) {
+      out.__resize_default_init(base + total);
+    }
+
+    ret.ptr = last;
+    ret.ec = errc();
+    ret.count = total;
+    ret.line = 0;
+    T *dst = out.data() + base;
+    for (unsigned i = 0; i < num_threads; i++) {
+      const __chunk<T> &c = chunks[i];
+      for (unsigned long long j = 0; j < c.ret.count; j++) {
+        *dst++ = c.values[j];
+      }
+      if (c.ret.ec != errc()) {
+        ret.ptr = c.ret.ptr;
+        ret.ec = c.ret.ec;
+        break;
+      }
+    }
+    destroy(chunks, chunks + num_threads);
+    alloc.deallocate(chunks, num_threads);
+  }
+
+  if (ret.ec != errc()) {
+    ret.line = __count_lines(first, ret.ptr);
+  }
+  return ret;
+}
+
+}  // namespace
+
+parse_numbers_result parse_numbers(const char *first, const char *last,
+                                   vector<float> &out,
+                                   const parse_numbers_options &options) {
+  return __parse_numbers(first, last, out, options);
+}
+
+parse_numbers_result parse_numbers(const char *first, const char *last,
+                                   vector<double> &out,
+                                   const parse_numbers_options &options) {
+  return __parse_numbers(first, last, out, options);
+}
+
+parse_numbers_result parse_numbers(const char *first, const char *last,
+                                   vector<int> &out,
+                                   const parse_numbers_options &options) {
+  return __parse_numbers(first, last, out, options);
+}
+
+}  // namespace nanostl
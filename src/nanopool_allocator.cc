@@ -0,0 +1,275 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 Light Transport Entertainment, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "nanopool_allocator.h"
+#include "nanomutex.h"
+
+namespace nanostl {
+
+#if defined(NANOSTL_NO_THREAD)
+#define NANOSTL_POOL_TLS
+#define NANOSTL_POOL_LOCK(cc)
+#else
+#define NANOSTL_POOL_TLS thread_local
+#define NANOSTL_POOL_LOCK(cc) lock_guard<mutex> __pool_guard((cc).lock)
+#endif
+
+namespace {
+
+struct free_block {
+  free_block *next;
+  // Links magazines in the central pool(first block of each magazine).
+  free_block *next_magazine;
+};
+
+// Memory carved into blocks on demand.
+const size_type kSpanBytes = 256 * 1024;
+
+// Blocks per magazine: about 8 KB worth(8192 / class size), 4 to 64 blocks.
+const unsigned char kMagazineSize[kPoolNumClasses] = {
+    64, 64, 64, 64, 64, 64, 64, 64, 51, 42, 36, 32, 25, 21,
+    18, 16, 12, 10, 9,  8,  6,  5,  4,  4,  4,  4,  4,  4};
+
+inline unsigned magazine_size(unsigned c) { return kMagazineSize[c]; }
+
+struct central_class {
+  free_block *magazines;  // full magazines
+  size_type num_magazines;
+  free_block *loose;  // blocks from exited threads
+  char *cur;          // unused part of the current span
+  char *end;
+  size_type reserved_bytes;
+#if !defined(NANOSTL_NO_THREAD)
+  mutex lock;
+#endif
+};
+
+struct central_pool {
+  central_class classes[kPoolNumClasses];
+};
+
+// Constructed on first use and never destroyed, so containers with static
+// storage duration can still free into it at exit.
+central_pool &central() {
+  static union {
+    char bytes[sizeof(central_pool)];
+    void *align;
+  } storage;
+  static central_pool *pool =
+      new (&storage, __placement_tag()) central_pool();
+  return *pool;
+}
+
+struct span_unit {
+  unsigned long long w[2];
+};
+
+// Takes one magazine(or up to `m` loose blocks) from the central pool.
+// Called with the class locked. Returns 0 if there is none.
+free_block *take_magazine(central_class &cc, unsigned m, unsigned &count) {
+  if (cc.magazines) {
+    free_block *mag = cc.magazines;
+    cc.magazines = mag->next_magazine;
+    cc.num_magazines--;
+    count = m;
+    return mag;
+  }
+  if (cc.loose) {
+    free_block *head = cc.loose;
+    free_block *b = head;
+    unsigned n = 1;
+    while ((n < m) && b->next) {
+      b = b->next;
+      n++;
+    }
+    cc.loose = b->next;
+    b->next = 0;
+    count = n;
+    return head;
+  }
+  return 0;
+}
+
+// A list of about one magazine for class `c`, or NULL when a new span can't be
+// allocated.
+free_block *refill(unsigned c, unsigned &count) {
+  central_class &cc = central().classes[c];
+  const unsigned m = magazine_size(c);
+  const size_type size = __pool_class_size(c);
+
+  char *carved;
+  {
+    NANOSTL_POOL_LOCK(cc);
+    free_block *mag = take_magazine(cc, m, count);
+    if (mag) {
+      return mag;
+    }
+    if (size_type(cc.end - cc.cur) < m * size) {
+      // The rest of the old span is dropped(less than one magazine).
+      const size_type units = (kSpanBytes + kPoolAlign) / sizeof(span_unit);
+      char *span =
+          reinterpret_cast<char *>(allocator<span_unit>().allocate(units));
+      if (!span) {
+        return 0;
+      }
+      cc.reserved_bytes += units * sizeof(span_unit);
+      cc.cur = span + ((0 - reinterpret_cast<size_type>(span)) &
+                       (kPoolAlign - 1));
+      cc.end = span + units * sizeof(span_unit);
+    }
+    carved = cc.cur;
+    cc.cur += m * size;
+  }
+
+  // Link the new blocks outside the lock.
+  for (unsigned i = 0; i + 1 < m; i++) {
+    reinterpret_cast<free_block *>(carved + i * size)->next =
+        reinterpret_cast<free_block *>(carved + (i + 1) * size);
+  }
+  reinterpret_cast<free_block *>(carved + (m - 1) * size)->next = 0;
+  count = m;
+  return reinterpret_cast<free_block *>(carved);
+}
+
+// Gives `list` back to the central pool: full magazines as they are, the
+// rest as loose blocks.
+void give_back(unsigned c, free_block *list) {
+  central_class &cc = central().classes[c];
+  const unsigned m = magazine_size(c);
+  while (list) {
+    free_block *head = list;
+    free_block *tail = list;
+    unsigned n = 1;
+    while ((n < m) && tail->next) {
+      tail = tail->next;
+      n++;
+    }
+    list = tail->next;
+
+    NANOSTL_POOL_LOCK(cc);
+    if (n == m) {
+      tail->next = 0;
+      head->next_magazine = cc.magazines;
+      cc.magazines = head;
+      cc.num_magazines++;
+    } else {
+      tail->next = cc.loose;
+      cc.loose = head;
+    }
+  }
+}
+
+struct thread_cache {
+  free_block *list[kPoolNumClasses];
+  unsigned count[kPoolNumClasses];
+
+  ~thread_cache();
+};
+
+NANOSTL_POOL_TLS thread_cache t_cache;
+
+// Set once `t_cache` is destroyed(thread exit). Blocks freed after that go
+// to the central pool directly.
+NANOSTL_POOL_TLS bool t_cache_dead;
+
+thread_cache::~thread_cache() {
+  t_cache_dead = true;
+  for (unsigned c = 0; c < kPoolNumClasses; c++) {
+    give_back(c, list[c]);
+    list[c] = 0;
+    count[c] = 0;
+  }
+}
+
+}  // namespace
+
+void *__pool_allocate(size_type bytes) {
+  const unsigned c = __pool_size_class(bytes);
+  if (t_cache_dead) {
+    unsigned n;
+    free_block *b = refill(c, n);
+    if (!b) {
+      return 0;
+    }
+    give_back(c, b->next);
+    return b;
+  }
+
+  thread_cache &tc = t_cache;
+  free_block *b = tc.list[c];
+  if (!b) {
+    b = refill(c, tc.count[c]);
+    if (!b) {
+      return 0;
+    }
+  }
+  tc.list[c] = b->next;
+  tc.count[c]--;
+  return b;
+}
+
+void __pool_deallocate(void *p, size_type bytes) {
+  const unsigned c = __pool_size_class(bytes);
+  free_block *b = static_cast<free_block *>(p);
+  if (t_cache_dead) {
+    b->next = 0;
+    give_back(c, b);
+    return;
+  }
+
+  thread_cache &tc = t_cache;
+  b->next = tc.list[c];
+  tc.list[c] = b;
+  tc.count[c]++;
+
+  // Keep one magazine, give the other back.
+  const unsigned m = magazine_size(c);
+  if (tc.count[c] >= 2 * m) {
+    free_block *tail = b;
+    for (unsigned i = 1; i < m; i++) {
+      tail = tail->next;
+    }
+    tc.list[c] = tail->next;
+    tail->next = 0;
+    tc.count[c] -= m;
+    give_back(c, b);
+  }
+}
+
+pool_stats get_pool_stats() {
+  pool_stats st;
+  st.reserved_bytes = 0;
+  st.central_magazines = 0;
+  central_pool &pool = central();
+  for (unsigned c = 0; c < kPoolNumClasses; c++) {
+    central_class &cc = pool.classes[c];
+    NANOSTL_POOL_LOCK(cc);
+    st.reserved_bytes += cc.reserved_bytes;
+    st.central_magazines += cc.num_magazines;
+  }
+  return st;
+}
+
+}  // namespace nanostl
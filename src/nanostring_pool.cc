@@ -0,0 +1,222 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 Light Transport Entertainment, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "nanostring_pool.h"
+#include "nanoallocator.h"
+#include "nanocstring.h"
+#include "__hashfunc.h"
+
+namespace nanostl {
+
+#if defined(NANOSTL_NO_THREAD)
+#define NANOSTL_POOL_LOCK(sh)
+#else
+#define NANOSTL_POOL_LOCK(sh) lock_guard<mutex> __pool_guard((sh).lock)
+#endif
+
+namespace {
+
+// Arena chunk: [next chunk][size in words][data...]
+const unsigned long long kChunkWords = 64 * 1024 / sizeof(uint64_t);
+const unsigned long long kChunkHeaderWords = 2;
+
+const unsigned long long kInitialSlots = 64;
+
+inline unsigned __shard_index(uint64_t h) {
+  return unsigned(h >> 60);  // kNumShards == 16
+}
+
+}  // namespace
+
+string_pool::string_pool() {
+  for (unsigned i = 0; i < kNumShards; i++) {
+    shard &sh = shards_[i];
+    sh.slots = 0;
+    sh.capacity = 0;
+    sh.count = 0;
+    sh.chunks = 0;
+    sh.cur = 0;
+    sh.end = 0;
+    sh.arena_bytes = 0;
+  }
+}
+
+string_pool::~string_pool() {
+  allocator<slot> slot_alloc;
+  allocator<uint64_t> chunk_alloc;
+  for (unsigned i = 0; i < kNumShards; i++) {
+    shard &sh = shards_[i];
+    if (sh.slots) {
+      slot_alloc.deallocate(sh.slots, sh.capacity);
+    }
+    char *c = sh.chunks;
+    while (c) {
+      uint64_t *words = reinterpret_cast<uint64_t *>(c);
+      char *next = reinterpret_cast<char *>(words[0]);
+      chunk_alloc.deallocate(words, words[1]);
+      c = next;
+    }
+  }
+}
+
+uint64_t string_pool::hash(string_view s) {
+  fast_hasher h;
+  h(s.data(), s.size());
+  return static_cast<uint64_t>(h);
+}
+
+const __atom_rep *string_pool::__lookup(const shard &sh, uint64_t h,
+                                        string_view s) {
+  if (sh.capacity == 0) {
+    return 0;
+  }
+  const unsigned long long mask = sh.capacity - 1;
+  for (unsigned long long i = h & mask;; i = (i + 1) & mask) {
+    const slot &e = sh.slots[i];
+    if (e.rep == 0) {
+      return 0;
+    }
+    if ((e.hash == h) && (e.rep->size == s.size()) &&
+        (string_view(e.rep->data(), e.rep->size) == s)) {
+      return e.rep;
+    }
+  }
+}
+
+void string_pool::__insert_slot(shard &sh, uint64_t h, const __atom_rep *rep) {
+  const unsigned long long mask = sh.capacity - 1;
+  unsigned long long i = h & mask;
+  while (sh.slots[i].rep) {
+    i = (i + 1) & mask;
+  }
+  sh.slots[i].hash = h;
+  sh.slots[i].rep = rep;
+}
+
+void string_pool::__rehash(shard &sh) {
+  allocator<slot> alloc;
+  slot *old_slots = sh.slots;
+  const unsigned long long old_capacity = sh.capacity;
+
+  sh.capacity = old_capacity ? old_capacity * 2 : kInitialSlots;
+  sh.slots = alloc.allocate(sh.capacity);
+  for (unsigned long long i = 0; i < sh.capacity; i++) {
+    sh.slots[i].hash = 0;
+    sh.slots[i].rep = 0;
+  }
+
+  for (unsigned long long i = 0; i < old_capacity; i++) {
+    if (old_slots[i].rep) {
+      __insert_slot(sh, old_slots[i].hash, old_slots[i].rep);
+    }
+  }
+
+  if (old_slots) {
+    alloc.deallocate(old_slots, old_capacity);
+  }
+}
+
+__atom_rep *string_pool::__allocate(shard &sh, unsigned long long bytes) {
+  // Keep reps 8 byte aligned.
+  bytes = (bytes + 7) & ~7ull;
+
+  if ((sh.cur == 0) || (bytes > (unsigned long long)(sh.end - sh.cur))) {
+    unsigned long long words = bytes / sizeof(uint64_t) + kChunkHeaderWords;
+    if (words < kChunkWords) {
+      words = kChunkWords;
+    }
+    allocator<uint64_t> alloc;
+    uint64_t *chunk = alloc.allocate(words);
+    chunk[0] = reinterpret_cast<uint64_t>(sh.chunks);
+    chunk[1] = words;
+    sh.chunks = reinterpret_cast<char *>(chunk);
+    sh.cur = reinterpret_cast<char *>(chunk + kChunkHeaderWords);
+    sh.end = reinterpret_cast<char *>(chunk + words);
+    sh.arena_bytes += words * sizeof(uint64_t);
+  }
+
+  __atom_rep *rep = reinterpret_cast<__atom_rep *>(sh.cur);
+  sh.cur += bytes;
+  return rep;
+}
+
+atom string_pool::intern(string_view s) {
+  const uint64_t h = hash(s);
+  shard &sh = shards_[__shard_index(h)];
+
+  NANOSTL_POOL_LOCK(sh);
+
+  const __atom_rep *found = __lookup(sh, h, s);
+  if (found) {
+    return atom(found);
+  }
+
+  // Keep load factor <= 1/2
+  if ((sh.count + 1) * 2 > sh.capacity) {
+    __rehash(sh);
+  }
+
+  __atom_rep *rep = __allocate(sh, sizeof(__atom_rep) + s.size() + 1);
+  rep->hash = h;
+  rep->size = s.size();
+  char *dst = reinterpret_cast<char *>(rep + 1);
+  if (s.size()) {
+    memcpy(dst, s.data(), s.size());
+  }
+  dst[s.size()] = '\0';
+
+  __insert_slot(sh, h, rep);
+  sh.count++;
+
+  return atom(rep);
+}
+
+atom string_pool::find(string_view s) const {
+  const uint64_t h = hash(s);
+  const shard &sh = shards_[__shard_index(h)];
+
+  NANOSTL_POOL_LOCK(sh);
+
+  return atom(__lookup(sh, h, s));
+}
+
+unsigned long long string_pool::size() const {
+  unsigned long long n = 0;
+  for (unsigned i = 0; i < kNumShards; i++) {
+    NANOSTL_POOL_LOCK(shards_[i]);
+    n += shards_[i].count;
+  }
+  return n;
+}
+
+unsigned long long string_pool::memory_usage() const {
+  unsigned long long n = 0;
+  for (unsigned i = 0; i < kNumShards; i++) {
+    NANOSTL_POOL_LOCK(shards_[i]);
+    n += shards_[i].arena_bytes + shards_[i].capacity * sizeof(slot);
+  }
+  return n;
+}
+
+}  // namespace nanostl
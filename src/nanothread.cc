@@ -12,9 +12,31 @@
 #define THREAD_IMPLEMENTATION
 #include "libs_thread.h"
 #include "nanothread.h"
+#include "nanomutex.h"
+#include "nanoallocator.h"
+#include "__nanoparallel.h"
 
 namespace nanostl {
 
+static_assert(sizeof(thread_mutex_t) <= 64,
+              "mutex storage is too small for thread_mutex_t");
+
+mutex::mutex() {
+  thread_mutex_init(reinterpret_cast<thread_mutex_t *>(&storage_));
+}
+
+mutex::~mutex() {
+  thread_mutex_term(reinterpret_cast<thread_mutex_t *>(&storage_));
+}
+
+void mutex::lock() {
+  thread_mutex_lock(reinterpret_cast<thread_mutex_t *>(&storage_));
+}
+
+void mutex::unlock() {
+  thread_mutex_unlock(reinterpret_cast<thread_mutex_t *>(&storage_));
+}
+
 thread::thread() : thread_handle_(nullptr) {
 
 }
@@ -65,4 +87,59 @@ unsigned thread::hardware_concurrency() __NANOSTL_NOEXCEPT {
 #endif
 }
 
+unsigned __hardware_concurrency() {
+  unsigned n = thread::hardware_concurrency();
+  return n ? n : 1;
+}
+
+namespace {
+
+struct __parallel_task {
+  __parallel_func fn;
+  void *ctx;
+  unsigned index;
+  thread_ptr_t handle;
+};
+
+int __parallel_proc(void *p) {
+  __parallel_task *task = static_cast<__parallel_task *>(p);
+  task->fn(task->ctx, task->index);
+  return 0;
+}
+
+}  // namespace
+
+void __parallel_run(unsigned n, __parallel_func fn, void *ctx) {
+  if (n == 0) {
+    return;
+  }
+  if (n == 1) {
+    fn(ctx, 0);
+    return;
+  }
+
+  allocator<__parallel_task> alloc;
+  __parallel_task *tasks = alloc.allocate(n);
+  for (unsigned i = 1; i < n; i++) {
+    tasks[i].fn = fn;
+    tasks[i].ctx = ctx;
+    tasks[i].index = i;
+    tasks[i].handle = thread_create(__parallel_proc, &tasks[i], "nanostl worker",
+                                    THREAD_STACK_SIZE_DEFAULT);
+  }
+
+  fn(ctx, 0);
+
+  for (unsigned i = 1; i < n; i++) {
+    if (tasks[i].handle) {
+      thread_join(tasks[i].handle);
+      thread_destroy(tasks[i].handle);
+    } else {
+      // Failed to create a thread. Run it here.
+      fn(ctx, i);
+    }
+  }
+  alloc.deallocate(tasks, n);
+}
+
 }  // namespace nanostl
@@ -6,15 +6,32 @@
 
 #define NANOSTL_IMPLEMENTATION
 #include "nanoalgorithm.h"
+#include "nanocstring.h"
 #include "nanolimits.h"
 #include "nanomap.h"
 #include "nanomath.h"
 #include "nanosstream.h"
 #include "nanostring.h"
+#include "nanostring_view.h"
+#include "nanostring_pool.h"
+#include "nanoarena.h"
+#include "nanopool_allocator.h"
+#include "nanomemory_resource.h"
+#include "nanoalloc_profile.h"
+#include "nanorope.h"
+#include "nanocharconv.h"
+#include "nanoparse_numbers.h"
+#include "nanoformat_numbers.h"
 #include "nanoutility.h"
 #include "nanovector.h"
 #include "nanovalarray.h"
 #include "nanomemory.h"
+#include "nanofrozen.h"
+#include "nanofixed_string.h"
+#include "nanounicode.h"
+#include "nanohash_append.h"
+#include "nanobloom_filter.h"
+#include "nanocuckoo_filter.h"
 
 #include "nanooptional.h"
 //#include "nanoany.h"
@@ -23,6 +40,10 @@
 
 #include "__nanostrutil.h"
 
+// The nano headers define `nullptr` as a macro(__nullptr), which breaks the
+// standard headers below. This file is C++11, so use the keyword.
+#undef nullptr
+
 #include <cstdio>
 #include <cstdlib>
 //#include <cstdint>
@@ -31,6 +52,13 @@
 #include <iostream>
 #include <vector>
 #include <valarray>
+#include <thread>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define NANOSTL_TEST_GUARD_PAGE
+#endif
 
 #include "nanoiterator.h"
 
@@ -178,6 +206,146 @@ static void test_vector(void) {
   TEST_CHECK(v.size() == 0);
 }
 
+// Counts live objects.
+struct counted {
+  static int live;
+  static int constructed;
+  int value;
+
+  counted() : value(-1) {
+    live++;
+    constructed++;
+  }
+  counted(int v) : value(v) {
+    live++;
+    constructed++;
+  }
+  counted(const counted &rhs) : value(rhs.value) {
+    live++;
+    constructed++;
+  }
+  ~counted() { live--; }
+  counted &operator=(const counted &rhs) {
+    value = rhs.value;
+    return *this;
+  }
+};
+int counted::live = 0;
+int counted::constructed = 0;
+
+// Allocator with its own construct().
+template <typename T>
+struct tagging_allocator : nanostl::allocator<T> {
+  template <class U>
+  struct rebind {
+    typedef tagging_allocator<U> other;
+  };
+  tagging_allocator() {}
+  template <class U>
+  tagging_allocator(const tagging_allocator<U> &) {}
+
+  template <class U>
+  void construct(U *p, const U &v) {
+    new (static_cast<void *>(p)) U(v);
+    p->value += 1000;
+  }
+};
+
+static void test_uninitialized(void) {
+  {
+    nanostl::vector<counted> v;
+    v.reserve(100);
+    TEST_CHECK(v.capacity() == 100);
+    TEST_CHECK(counted::live == 0);  // capacity is not constructed
+
+    for (int i = 0; i < 10; i++) {
+      v.push_back(counted(i));
+    }
+    TEST_CHECK(counted::live == 10);
+    v.pop_back();
+    TEST_CHECK(counted::live == 9);
+    v.erase(v.begin());
+    TEST_CHECK(counted::live == 8);
+    TEST_CHECK(v[0].value == 1);
+
+    v.resize(20);
+    TEST_CHECK(counted::live == 20);
+    TEST_CHECK(v[19].value == -1);
+    v.resize(5);
+    TEST_CHECK(counted::live == 5);
+
+    // Growing while pushing one of its own elements.
+    nanostl::vector<counted> w(v);
+    TEST_CHECK(counted::live == 10);
+    while (w.size() < w.capacity()) {
+      w.push_back(counted(7));
+    }
+    w.push_back(w[0]);
+    TEST_CHECK(w[w.size() - 1].value == 1);
+
+    w.clear();
+    TEST_CHECK(counted::live == 5);
+    v.resize(0);
+    TEST_CHECK(v.empty());
+  }
+  TEST_CHECK(counted::live == 0);
+
+  // Map nodes.
+  {
+    nanostl::map<int, counted> m;
+    for (int i = 0; i < 100; i++) {
+      m[i] = counted(i);
+    }
+    TEST_CHECK(counted::live == 100);
+  }
+  TEST_CHECK(counted::live == 0);
+
+  // allocator_traits uses the member construct() when there is one.
+  {
+    nanostl::vector<counted, tagging_allocator<counted> > t;
+    t.push_back(counted(1));
+    TEST_CHECK(t[0].value == 1001);
+
+    typedef nanostl::allocator_traits<nanostl::allocator<counted> > traits;
+    nanostl::allocator<counted> a;
+    counted *p = traits::allocate(a, 2);
+    traits::construct(a, p, 5);
+    traits::construct(a, p + 1);
+    TEST_CHECK((p[0].value == 5) && (p[1].value == -1));
+    traits::destroy(a, p);
+    traits::destroy(a, p + 1);
+    traits::deallocate(a, p, 2);
+    TEST_CHECK(traits::max_size(a) > 0);
+  }
+  TEST_CHECK(counted::live == 0);
+
+  // Algorithms.
+  {
+    nanostl::allocator<counted> a;
+    counted src[4] = {counted(1), counted(2), counted(3), counted(4)};
+    counted *p = a.allocate(8);
+    counted *e = nanostl::uninitialized_copy(src, src + 4, p);
+    TEST_CHECK(e == p + 4);
+    e = nanostl::uninitialized_move(src, src + 2, e);
+    nanostl::uninitialized_fill(e, p + 8, counted(9));
+    TEST_CHECK(counted::live == 12);
+    TEST_CHECK((p[3].value == 4) && (p[5].value == 2) && (p[7].value == 9));
+    nanostl::destroy(p, p + 8);
+    TEST_CHECK(counted::live == 4);
+    a.deallocate(p, 8);
+  }
+  TEST_CHECK(counted::live == 0);
+
+  // Over-aligned storage.
+  struct alignas(64) wide {
+    char c[64];
+  };
+  nanostl::allocator<wide> wa;
+  wide *wp = wa.allocate(3);
+  TEST_CHECK((reinterpret_cast<unsigned long long>(wp) & 63) == 0);
+  wa.deallocate(wp, 3);
+}
+
 #if 0
 static void test_valarray(void) {
   nanostl::valarray<int> v;
@@ -250,6 +418,242 @@ static void test_algorithm(void) {
   }
 }
 
+static void test_cstring(void) {
+  // Sizes and alignments cover every size class of memcpy/memmove/memset.
+  static unsigned char src[1024];
+  static unsigned char buf[1024];
+  static unsigned char ref[1024];
+  for (int i = 0; i < 1024; i++) {
+    src[i] = (unsigned char)(i * 131 + 7);
+  }
+
+  int failures = 0;
+  for (int n = 0; n <= 400; n += (n < 160) ? 1 : 13) {
+    for (int off = 0; off < 20; off++) {
+      for (int i = 0; i < 1024; i++) {
+        buf[i] = ref[i] = 0xee;
+      }
+      nanostl::memcpy(buf + off, src + 3, (unsigned long long)n);
+      for (int i = 0; i < n; i++) {
+        ref[off + i] = src[3 + i];
+      }
+      failures += (std::vector<unsigned char>(buf, buf + 1024) !=
+                   std::vector<unsigned char>(ref, ref + 1024));
+
+      nanostl::memset(buf + off, off, (unsigned long long)n);
+      for (int i = 0; i < n; i++) {
+        ref[off + i] = (unsigned char)off;
+      }
+      failures += (std::vector<unsigned char>(buf, buf + 1024) !=
+                   std::vector<unsigned char>(ref, ref + 1024));
+
+      // Overlapping moves in both directions.
+      for (int dist = -off * 3; dist <= off * 3; dist += (off ? off : 1)) {
+        for (int i = 0; i < 1024; i++) {
+          buf[i] = ref[i] = src[i];
+        }
+        nanostl::memmove(buf + 500 + dist, buf + 500, (unsigned long long)n);
+        if (dist > 0) {
+          for (int i = n - 1; i >= 0; i--) {
+            ref[500 + dist + i] = ref[500 + i];
+          }
+        } else {
+          for (int i = 0; i < n; i++) {
+            ref[500 + dist + i] = ref[500 + i];
+          }
+        }
+        failures += (std::vector<unsigned char>(buf, buf + 1024) !=
+                     std::vector<unsigned char>(ref, ref + 1024));
+      }
+    }
+  }
+  TEST_CHECK(failures == 0);
+  TEST_MSG("failures: %d", failures);
+
+  // Non-temporal variants: small sizes fall back, larger ones stream whole
+  // cache lines between an unaligned head and tail.
+  failures = 0;
+  for (int n = 0; n <= 900; n += (n < 300) ? 1 : 37) {
+    for (int off = 0; off < 70; off += 3) {
+      for (int i = 0; i < 1024; i++) {
+        buf[i] = ref[i] = 0xee;
+      }
+      nanostl::memcpy_stream(buf + off, src + 5, (unsigned long long)n);
+      for (int i = 0; i < n; i++) {
+        ref[off + i] = src[5 + i];
+      }
+      failures += (std::vector<unsigned char>(buf, buf + 1024) !=
+                   std::vector<unsigned char>(ref, ref + 1024));
+
+      nanostl::memset_stream(buf + off, 0x5a, (unsigned long long)n);
+      for (int i = 0; i < n; i++) {
+        ref[off + i] = 0x5a;
+      }
+      failures += (std::vector<unsigned char>(buf, buf + 1024) !=
+                   std::vector<unsigned char>(ref, ref + 1024));
+    }
+  }
+  TEST_CHECK(failures == 0);
+  TEST_MSG("stream failures: %d", failures);
+
+  // Above NANOSTL_STREAM_THRESHOLD memcpy/memmove/memset stream as well.
+  {
+    const unsigned long long big = NANOSTL_STREAM_THRESHOLD + 4099;
+    std::vector<unsigned char> a(big + 64), b(big + 64, 0xee);
+    for (unsigned long long i = 0; i < a.size(); i++) {
+      a[i] = (unsigned char)((i * 2654435761ull) >> 13);
+    }
+    nanostl::memcpy(&b[7], &a[3], big);
+    TEST_CHECK(std::vector<unsigned char>(a.begin() + 3, a.begin() + 3 + big) ==
+               std::vector<unsigned char>(b.begin() + 7, b.begin() + 7 + big));
+    TEST_CHECK(b[6] == 0xee && b[big + 7] == 0xee);
+
+    nanostl::memset(&b[1], 0x33, big);
+    unsigned long long set = 0;
+    for (unsigned long long i = 1; i <= big; i++) {
+      set += (b[i] == 0x33);
+    }
+    TEST_CHECK(set == big);
+    TEST_CHECK(b[0] == 0xee && b[big + 1] == a[big - 3]);
+
+    nanostl::memmove(&b[0], &a[0], big);
+    TEST_CHECK(std::vector<unsigned char>(a.begin(), a.begin() + big) ==
+               std::vector<unsigned char>(b.begin(), b.begin() + big));
+  }
+
+  nanostl::string s("0123456789abcdefghijklmnopqrstuvwxyz");
+  s.insert(30, "XY");
+  TEST_CHECK(s == "0123456789abcdefghijklmnopqrstXYuvwxyz");
+  s.erase(s.begin() + 1);
+  TEST_CHECK(s == "023456789abcdefghijklmnopqrstXYuvwxyz");
+}
+
+static void test_cstring_str(void) {
+  // Start the string at every alignment so that the terminator and the
+  // searched char land at each position of a SIMD block.
+  char buf[160];
+  int failures = 0;
+  for (int off = 0; off < 32; off++) {
+    for (int n = 0; n < 100; n++) {
+      char *s = buf + off;
+      for (int i = 0; i < n; i++) {
+        s[i] = char('a' + (i % 7));
+      }
+      s[n] = '\0';
+      failures += (nanostl::strlen(s) != (unsigned long long)n);
+      failures += (nanostl::strnlen(s, (unsigned long long)(n / 2)) !=
+                   (unsigned long long)(n / 2));
+      failures += (nanostl::strchr(s, 'g') != ((n > 6) ? s + 6 : 0));
+      failures += (nanostl::strchr(s, '\0') != s + n);
+      failures += (nanostl::strrchr(s, 'a') != (n ? s + ((n - 1) / 7) * 7 : 0));
+      failures += (nanostl::strcmp(s, s) != 0);
+      if (n > 0) {
+        char t[128];
+        nanostl::strcpy(t, s);
+        t[n - 1] = 'z';
+        failures += (nanostl::strcmp(s, t) >= 0);
+        failures += (nanostl::strncmp(s, t, (unsigned long long)(n - 1)) != 0);
+        failures += (nanostl::memcmp(t, s, (unsigned long long)n) <= 0);
+      }
+    }
+  }
+  TEST_CHECK(failures == 0);
+  TEST_MSG("failures: %d", failures);
+
+  // Bytes compare as unsigned char.
+  TEST_CHECK(nanostl::strcmp("a\x80", "a\x01") > 0);
+  TEST_CHECK(nanostl::strcmp("abc", "abcd") < 0);
+  TEST_CHECK(nanostl::strncmp("abcx", "abcy", 3) == 0);
+
+  const char *text = "key = value; other";
+  TEST_CHECK(nanostl::strstr(text, "value") == text + 6);
+  TEST_CHECK(nanostl::strstr(text, "values") == 0);
+  TEST_CHECK(nanostl::strstr(text, "") == text);
+  TEST_CHECK(nanostl::strspn(text, "abcdefghijklmnopqrstuvwxyz") == 3);
+  TEST_CHECK(nanostl::strcspn(text, ";") == 11);
+  TEST_CHECK(nanostl::strpbrk(text, "=;") == text + 4);
+  TEST_CHECK(nanostl::memchr(text, 'v', 18) == text + 6);
+  TEST_CHECK(nanostl::memchr(text, 'v', 6) == 0);
+
+  char dst[32];
+  nanostl::strncpy(dst, "ab", 8);
+  TEST_CHECK(dst[1] == 'b' && dst[2] == '\0' && dst[7] == '\0');
+  nanostl::strcat(dst, "cd");
+  nanostl::strncat(dst, "efgh", 2);
+  TEST_CHECK(nanostl::strcmp(dst, "abcdef") == 0);
+
+  char tokens[] = " a, bc,,d ";
+  char *tok = nanostl::strtok(tokens, " ,");
+  TEST_CHECK(tok && nanostl::strcmp(tok, "a") == 0);
+  tok = nanostl::strtok(0, " ,");
+  TEST_CHECK(tok && nanostl::strcmp(tok, "bc") == 0);
+  tok = nanostl::strtok(0, " ,");
+  TEST_CHECK(tok && nanostl::strcmp(tok, "d") == 0);
+  TEST_CHECK(nanostl::strtok(0, " ,") == 0);
+
+  // basic_string compare uses memcmp-style mismatch for any char type.
+  nanostl::u16string a, b;
+  for (int i = 0; i < 40; i++) {
+    a.push_back(char16_t(0x100 + i));
+    b.push_back(char16_t(0x100 + i));
+  }
+  b[37] = char16_t(0x1ff);
+  TEST_CHECK(a.compare(b) < 0 && b.compare(a) > 0);
+  TEST_CHECK(nanostl::string("abc\xff") > nanostl::string("abc\x01"));
+}
+
+// Strings which end right before an unreadable page.
+static void test_cstring_guard_page(void) {
+#if defined(NANOSTL_TEST_GUARD_PAGE)
+  const long page = sysconf(_SC_PAGESIZE);
+  void *m = mmap(0, size_t(2 * page), PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  TEST_CHECK(m != MAP_FAILED);
+  if (m == MAP_FAILED) {
+    return;
+  }
+  char *guard = static_cast<char *>(m) + page;
+  TEST_CHECK(mprotect(guard, size_t(page), PROT_NONE) == 0);
+
+  int failures = 0;
+  char dst[128];
+  for (int n = 0; n < 64; n++) {
+    // Terminated: n chars and the NUL are the last bytes of the page.
+    char *s = guard - n - 1;
+    for (int i = 0; i < n; i++) {
+      s[i] = char('a' + (i % 7));
+    }
+    s[n] = '\0';
+    failures += (nanostl::strlen(s) != (unsigned long long)n);
+    failures += (nanostl::strnlen(s, 100) != (unsigned long long)n);
+    failures += (nanostl::strchr(s, 'z') != 0);
+    failures += (nanostl::strcmp(s, s) != 0);
+    nanostl::strncpy(dst, s, 100);
+    failures += (nanostl::strcmp(dst, s) != 0) || (dst[99] != '\0');
+    dst[0] = '\0';
+    nanostl::strncat(dst, s, 100);
+    failures += (nanostl::strcmp(dst, s) != 0);
+
+    // Unterminated: `count` chars reach the page end.
+    char *u = guard - n;
+    for (int i = 0; i < n; i++) {
+      u[i] = 'x';
+    }
+    failures += (nanostl::strnlen(u, (unsigned long long)n) !=
+                 (unsigned long long)n);
+    nanostl::strncpy(dst, u, (unsigned long long)n);
+    failures += (n > 0) && (dst[n - 1] != 'x');
+    dst[0] = '\0';
+    nanostl::strncat(dst, u, (unsigned long long)n);
+    failures += (nanostl::strlen(dst) != (unsigned long long)n);
+  }
+  TEST_CHECK(failures == 0);
+  TEST_MSG("failures: %d", failures);
+
+  munmap(m, size_t(2 * page));
+#endif
+}
+
 static void test_string(void) {
   nanostl::string s("a");
 
@@ -267,6 +671,619 @@ static void test_string(void) {
   TEST_CHECK(nanostl::string("a").length() == std::string("a").length());
   TEST_CHECK(nanostl::string("1.0").length() == std::string("1.0").length());
   TEST_CHECK(nanostl::string("\0").length() == std::string("\0").length());
+
+  // Short strings are stored inline, long strings on the heap.
+  nanostl::string shrt("0123456789");
+  nanostl::string lng("0123456789012345678901234567890123456789");
+  TEST_CHECK(shrt.size() == 10);
+  TEST_CHECK(lng.size() == 40);
+  TEST_CHECK(lng.capacity() >= 40);
+
+  nanostl::string c(lng);
+  TEST_CHECK(c == lng);
+  TEST_CHECK(c.c_str() != lng.c_str());
+
+  c = shrt;
+  TEST_CHECK(c == shrt);
+  TEST_CHECK(c.c_str()[10] == '\0');
+
+  nanostl::string acc;
+  std::string ref;
+  for (size_t i = 0; i < 50; i++) {
+    acc += shrt;
+    ref += "0123456789";
+    TEST_CHECK(acc.size() == ref.size());
+    TEST_CHECK(ref.compare(acc.c_str()) == 0);
+  }
+
+  TEST_CHECK(nanostl::string("a") < nanostl::string("ab"));
+  TEST_CHECK(nanostl::string("ab") != nanostl::string("a"));
+}
+
+static void test_string_view(void) {
+  const char *line = "key = value ; # comment";
+  nanostl::string_view v(line);
+
+  TEST_CHECK(v.size() == 23);
+  TEST_CHECK(v.starts_with("key"));
+  TEST_CHECK(v.ends_with("comment"));
+  TEST_CHECK(!v.ends_with("commentx"));
+
+  nanostl::string_view::size_type eq = v.find('=');
+  TEST_CHECK(eq == 4);
+  TEST_CHECK(v.substr(0, eq - 1) == "key");
+  TEST_CHECK(v.find("value") == 6);
+  TEST_CHECK(v.find("none") == nanostl::string_view::npos);
+  TEST_CHECK(v.rfind('e') == 20);
+  TEST_CHECK(v.substr(100).empty());
+
+  // Views point into the original buffer.
+  nanostl::string_view key = v.substr(0, 3);
+  TEST_CHECK(key.data() == line);
+
+  // string <-> string_view
+  nanostl::string s("value");
+  nanostl::string_view sv = s;
+  TEST_CHECK(sv.data() == s.c_str());
+  TEST_CHECK(sv == s);
+  TEST_CHECK(s == v.substr(6, 5));
+  TEST_CHECK(v.substr(6, 5) == s);
+  TEST_CHECK(key < s);
+  TEST_CHECK(s.compare(key) > 0);
+
+  nanostl::string t = s + key;
+  TEST_CHECK(t == "valuekey");
+  t += v.substr(eq, 1);
+  TEST_CHECK(t == "valuekey=");
+  TEST_CHECK((key + s) == "keyvalue");
+
+  nanostl::string u(v.substr(12, 1));
+  TEST_CHECK(u == ";");
+}
+
+static void test_string_find(void) {
+  // Long enough to run the SIMD kernels.
+  nanostl::string s;
+  for (int i = 0; i < 10; i++) {
+    s += "lorem ipsum dolor sit amet, ";
+  }
+  s += "needle; tail";
+  std::string ref(s.c_str());
+
+  TEST_CHECK(s.find("needle") == ref.find("needle"));
+  TEST_CHECK(s.find("needlex") == nanostl::string::npos);
+  TEST_CHECK(s.find("ipsum", 10) == ref.find("ipsum", 10));
+  TEST_CHECK(s.find(';') == ref.find(';'));
+  TEST_CHECK(s.rfind("ipsum") == ref.rfind("ipsum"));
+  TEST_CHECK(s.rfind(',', 100) == ref.rfind(',', 100));
+  TEST_CHECK(s.find_first_of(";,") == ref.find_first_of(";,"));
+  TEST_CHECK(s.find_last_of(";,") == ref.find_last_of(";,"));
+  TEST_CHECK(s.find_first_not_of("lorem ") == ref.find_first_not_of("lorem "));
+  TEST_CHECK(s.find_last_not_of("tail ") == ref.find_last_not_of("tail "));
+  TEST_CHECK(s.find("") == 0);
+
+  // Set with many distinct high nibbles(uses the bitmap).
+  const char set[] = "\x01\x11\x21\x31\x41\x51\x61\x71\x81;";
+  TEST_CHECK(s.find_first_of(set) == ref.find_first_of(set));
+}
+
+static void test_string_append(void) {
+  nanostl::string s;
+  std::string ref;
+  for (int i = 0; i < 1000; i++) {
+    s.push_back(char('a' + (i % 26)));
+    ref.push_back(char('a' + (i % 26)));
+  }
+  TEST_CHECK(s.size() == ref.size());
+  TEST_CHECK(ref.compare(s.c_str()) == 0);
+
+  s.append(3, '!');
+  s.append("abc", 2);
+  s.append(s.data(), 4);  // append a part of itself
+  ref.append(3, '!');
+  ref.append("abc", 2);
+  ref.append(ref.data(), 4);
+  TEST_CHECK(ref.compare(s.c_str()) == 0);
+
+  s.resize(4);
+  TEST_CHECK(s == "abcd");
+  s.resize(6, '-');
+  TEST_CHECK(s == "abcd--");
+  s.insert(2, "XY");
+  TEST_CHECK(s == "abXYcd--");
+
+  nanostl::string r;
+  r.reserve(100);
+  TEST_CHECK(r.capacity() >= 100);
+  TEST_CHECK(r.empty());
+
+  nanostl::string a("aaaaaaaaaaaaaaaaaaaaaaaaa");
+  nanostl::string b("bbbbbbbbbbbbbbbbbbbbbbbbb");
+  nanostl::string c = a + b + "c" + 'd' + a;
+  TEST_CHECK(c.size() == 77);
+  TEST_CHECK(c.find("bc") == 49);
+  TEST_CHECK(("x" + a + b) == ("x" + (a + b)));
+}
+
+static void test_string_pool(void) {
+  nanostl::string_pool pool;
+
+  nanostl::atom a = pool.intern("position");
+  nanostl::string s("position");
+  nanostl::atom b = pool.intern(s);
+  nanostl::atom c = pool.intern("normal");
+
+  TEST_CHECK(a == b);
+  TEST_CHECK(a != c);
+  TEST_CHECK(a.view() == "position");
+  TEST_CHECK(a.c_str() != s.c_str());
+  TEST_CHECK(a.hash() == nanostl::string_pool::hash("position"));
+  TEST_CHECK(pool.size() == 2);
+
+  TEST_CHECK(pool.find("normal") == c);
+  TEST_CHECK(!pool.find("texcoord").valid());
+
+  for (int i = 0; i < 10000; i++) {
+    pool.intern(nanostl::to_string(i));
+  }
+  TEST_CHECK(pool.size() == 10002);
+  TEST_CHECK(pool.find("1234").view() == "1234");
+}
+
+static void test_arena(void) {
+  typedef nanostl::arena_allocator<char> char_alloc;
+  typedef nanostl::basic_string<char, char_alloc> arena_string;
+
+  nanostl::monotonic_arena arena(256);
+  {
+    nanostl::vector<int, nanostl::arena_allocator<int> > v(arena);
+    for (int i = 0; i < 1000; i++) {
+      v.push_back(i);
+    }
+    TEST_CHECK(v.size() == 1000);
+    TEST_CHECK(v[999] == 999);
+    TEST_CHECK(v.get_allocator().arena() == &arena);
+
+    // Copies allocate from the same arena.
+    nanostl::vector<int, nanostl::arena_allocator<int> > w(v);
+    TEST_CHECK(w.get_allocator() == v.get_allocator());
+    TEST_CHECK(w[500] == 500);
+
+    arena_string s("a string which does not fit in the SSO buffer", arena);
+    s += " and grows";
+    TEST_CHECK(s == "a string which does not fit in the SSO buffer and grows");
+    arena_string t = s + "!";
+    TEST_CHECK(t.get_allocator().arena() == &arena);
+    TEST_CHECK(t.size() == s.size() + 1);
+
+    nanostl::map<int, int, nanostl::less<int>,
+                 nanostl::arena_allocator<nanostl::pair<const int, int> > >
+        m(arena);
+    for (int i = 0; i < 100; i++) {
+      m[i * 7 % 100] = i;
+    }
+    TEST_CHECK(m[49] == 7);
+
+    // Elements of non-trivial types are destroyed by the vector, so the
+    // heap buffers of the strings are freed.
+    nanostl::vector<nanostl::string, nanostl::arena_allocator<nanostl::string> >
+        names(arena);
+    for (int i = 0; i < 50; i++) {
+      names.push_back(nanostl::string("a long enough name to be on the heap"));
+    }
+    TEST_CHECK(names[49].size() == 36);
+  }
+
+  TEST_CHECK(arena.allocation_count() > 0);
+  TEST_CHECK(arena.bytes_allocated() > 4000);
+  TEST_CHECK(arena.block_count() > 1);
+  TEST_CHECK(arena.bytes_reserved() >= arena.bytes_allocated());
+
+  const unsigned long long peak = arena.bytes_allocated();
+  arena.reset();
+  TEST_CHECK(arena.bytes_allocated() == 0);
+  TEST_CHECK(arena.block_count() == 1);
+  TEST_CHECK(arena.peak_bytes_allocated() == peak);
+
+  // Alignment and oversized requests.
+  void *a = arena.allocate(1, 1);
+  void *b = arena.allocate(8, 64);
+  void *c = arena.allocate(1 << 20);
+  TEST_CHECK(a != 0);
+  TEST_CHECK((reinterpret_cast<unsigned long long>(b) & 63) == 0);
+  TEST_CHECK((reinterpret_cast<unsigned long long>(c) & 15) == 0);
+  // The current block is still used after an oversized allocation.
+  void *d = arena.allocate(8, 1);
+  TEST_CHECK(d == static_cast<char *>(b) + 8);
+
+  // Requests which can't be satisfied return NULL and leave the arena as is.
+  const unsigned long long blocks = arena.block_count();
+  TEST_CHECK(arena.allocate(~0ull - 8) == 0);
+  TEST_CHECK(arena.allocate(1ull << 62) == 0);
+  TEST_CHECK(arena.block_count() == blocks);
+  TEST_CHECK(arena.allocate(8, 1) == static_cast<char *>(d) + 8);
+
+  arena.release();
+  TEST_CHECK(arena.block_count() == 0);
+  TEST_CHECK(arena.bytes_reserved() == 0);
+
+  // Initial buffer is used before any block.
+  char buf[512];
+  nanostl::monotonic_arena buffered(buf, sizeof(buf));
+  char *p = static_cast<char *>(buffered.allocate(100));
+  TEST_CHECK((p >= buf) && (p + 100 <= buf + sizeof(buf)));
+  TEST_CHECK(buffered.block_count() == 0);
+  buffered.allocate(1000);
+  TEST_CHECK(buffered.block_count() == 1);
+}
+
+static void test_pool_allocator(void) {
+  // Size classes cover 1..kPoolMaxSize without gaps.
+  int failures = 0;
+  for (unsigned long long n = 1; n <= nanostl::kPoolMaxSize; n++) {
+    const unsigned c = nanostl::__pool_size_class(n);
+    failures += (c >= nanostl::kPoolNumClasses);
+    failures += (nanostl::__pool_class_size(c) < n);
+    failures += (c > 0) && (nanostl::__pool_class_size(c - 1) >= n);
+  }
+  TEST_CHECK(failures == 0);
+  TEST_CHECK(nanostl::__pool_size_class(nanostl::kPoolMaxSize) ==
+             nanostl::kPoolNumClasses - 1);
+
+  nanostl::vector<int, nanostl::pool_allocator<int> > v;
+  for (int i = 0; i < 10000; i++) {
+    v.push_back(i);
+  }
+  TEST_CHECK(v[9999] == 9999);
+
+  nanostl::basic_string<char, nanostl::pool_allocator<char> > s(
+      "pooled string which does not fit in the SSO buffer");
+  s += s;
+  TEST_CHECK(s.size() == 100);
+
+  nanostl::map<int, int, nanostl::less<int>,
+               nanostl::pool_allocator<nanostl::pair<const int, int> > >
+      m;
+  for (int i = 0; i < 1000; i++) {
+    m[i] = i * 2;
+  }
+  TEST_CHECK(m[777] == 1554);
+
+  // Blocks are 16 byte aligned and reused after free.
+  void *a = nanostl::__pool_allocate(24);
+  TEST_CHECK((reinterpret_cast<unsigned long long>(a) & 15) == 0);
+  nanostl::__pool_deallocate(a, 24);
+  void *b = nanostl::__pool_allocate(32);
+  TEST_CHECK(a == b);
+  nanostl::__pool_deallocate(b, 32);
+
+  // Threads allocate, free blocks of other threads and exit.
+  std::vector<void *> shared(4 * 5000);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.push_back(std::thread([&shared, t]() {
+      for (int i = 0; i < 5000; i++) {
+        const unsigned long long n = 1 + (unsigned long long)(i * 37 + t) % 600;
+        char *p = static_cast<char *>(nanostl::__pool_allocate(n));
+        p[0] = char(t);
+        p[n - 1] = char(t);
+        shared[size_t(t * 5000 + i)] = p;
+      }
+    }));
+  }
+  for (size_t i = 0; i < threads.size(); i++) {
+    threads[i].join();
+  }
+  threads.clear();
+  // No block was handed out twice.
+  failures = 0;
+  for (int t = 0; t < 4; t++) {
+    for (int i = 0; i < 5000; i++) {
+      const unsigned long long n = 1 + (unsigned long long)(i * 37 + t) % 600;
+      const char *p = static_cast<const char *>(shared[size_t(t * 5000 + i)]);
+      failures += (p[0] != char(t)) || (p[n - 1] != char(t));
+    }
+  }
+  TEST_CHECK(failures == 0);
+  for (int t = 0; t < 4; t++) {
+    threads.push_back(std::thread([&shared, t]() {
+      // Free the blocks of thread (t + 1) % 4.
+      const int owner = (t + 1) % 4;
+      for (int i = 0; i < 5000; i++) {
+        const unsigned long long n =
+            1 + (unsigned long long)(i * 37 + owner) % 600;
+        nanostl::__pool_deallocate(shared[size_t(owner * 5000 + i)], n);
+      }
+    }));
+  }
+  for (size_t i = 0; i < threads.size(); i++) {
+    threads[i].join();
+  }
+
+  nanostl::pool_stats st = nanostl::get_pool_stats();
+  TEST_CHECK(st.reserved_bytes > 0);
+  TEST_CHECK(st.central_magazines > 0);
+}
+
+// Counts upstream traffic of the pool resources.
+class counting_resource : public nanostl::pmr::memory_resource {
+ public:
+  counting_resource() : allocations(0), outstanding(0) {}
+
+  unsigned long long allocations;
+  unsigned long long outstanding;
+
+ private:
+  virtual void *do_allocate(unsigned long long bytes,
+                            unsigned long long align) {
+    allocations++;
+    outstanding += bytes;
+    return nanostl::pmr::new_delete_resource()->allocate(bytes, align);
+  }
+  virtual void do_deallocate(void *p, unsigned long long bytes,
+                             unsigned long long align) {
+    outstanding -= bytes;
+    nanostl::pmr::new_delete_resource()->deallocate(p, bytes, align);
+  }
+  virtual bool do_is_equal(
+      const nanostl::pmr::memory_resource &other) const {
+    return this == &other;
+  }
+};
+
+// Upstream which is out of memory.
+class null_resource : public nanostl::pmr::memory_resource {
+ private:
+  virtual void *do_allocate(unsigned long long, unsigned long long) {
+    return 0;
+  }
+  virtual void do_deallocate(void *, unsigned long long, unsigned long long) {}
+  virtual bool do_is_equal(
+      const nanostl::pmr::memory_resource &other) const {
+    return this == &other;
+  }
+};
+
+static void test_memory_resource(void) {
+  namespace pmr = nanostl::pmr;
+
+  pmr::memory_resource *nd = pmr::new_delete_resource();
+  TEST_CHECK(pmr::get_default_resource() == nd);
+  void *big = nd->allocate(100, 256);
+  TEST_CHECK((reinterpret_cast<unsigned long long>(big) & 255) == 0);
+  nd->deallocate(big, 100, 256);
+
+  // One container type, resource chosen per instance.
+  pmr::monotonic_buffer_resource mono(256);
+  counting_resource upstream;
+  {
+    pmr::unsynchronized_pool_resource pool(&upstream);
+
+    pmr::vector<int> a(&mono);
+    pmr::vector<int> b(&pool);
+    pmr::vector<int> c;
+    for (int i = 0; i < 1000; i++) {
+      a.push_back(i);
+      b.push_back(i);
+      c.push_back(i);
+    }
+    TEST_CHECK(a[999] == 999 && b[999] == 999 && c[999] == 999);
+    TEST_CHECK(a.get_allocator().resource() == &mono);
+    TEST_CHECK(b.get_allocator().resource() == &pool);
+    TEST_CHECK(c.get_allocator().resource() == nd);
+    TEST_CHECK(a.get_allocator() != b.get_allocator());
+    a.swap(b);
+    TEST_CHECK(a.get_allocator().resource() == &pool);
+    TEST_CHECK(mono.arena().bytes_allocated() > 4000);
+
+    pmr::string s("a string which does not fit in the SSO buffer", &pool);
+    s += s;
+    TEST_CHECK(s.size() == 90);
+    TEST_CHECK(s.get_allocator().resource() == &pool);
+
+    pmr::map<int, pmr::string> m(&pool);
+    for (int i = 0; i < 200; i++) {
+      m[i] = pmr::string("value");
+    }
+    TEST_CHECK(m[123] == "value");
+
+    // Freed blocks are reused without going upstream.
+    void *p = pool.allocate(40);
+    pool.deallocate(p, 40);
+    const unsigned long long n = upstream.allocations;
+    TEST_CHECK(pool.allocate(48) == p);
+    TEST_CHECK(upstream.allocations == n);
+
+    // Large and over-aligned requests go upstream directly.
+    void *q = pool.allocate(nanostl::kPoolMaxSize + 1);
+    void *r = pool.allocate(8, 64);
+    TEST_CHECK((reinterpret_cast<unsigned long long>(r) & 63) == 0);
+    TEST_CHECK(upstream.allocations == n + 2);
+    pool.deallocate(q, nanostl::kPoolMaxSize + 1);
+
+    pmr::pool_options opts;
+    opts.largest_required_pool_block = 100;
+    pmr::unsynchronized_pool_resource small(opts, &upstream);
+    TEST_CHECK(small.options().largest_required_pool_block == 112);
+    TEST_CHECK(small.options().max_blocks_per_chunk > 0);
+    TEST_CHECK(small.upstream_resource() == &upstream);
+
+    // Sizes which wrap with the header are rejected before going upstream.
+    TEST_CHECK(pool.allocate(~0ull - 20) == 0);
+    TEST_CHECK(nd->allocate(~0ull - 20, 64) == 0);
+    TEST_CHECK(upstream.allocations == n + 2);
+
+    // `b` now lives in `mono`; destroyed before `pool` releases(also the
+    // block `r` which is still outstanding).
+  }
+  TEST_CHECK(upstream.outstanding == 0);
+
+  pmr::synchronized_pool_resource shared(&upstream);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.push_back(std::thread([&shared, t]() {
+      pmr::vector<pmr::string> v(&shared);
+      for (int i = 0; i < 1000; i++) {
+        v.push_back(pmr::string("thread local string longer than SSO",
+                                &shared));
+      }
+      (void)t;
+    }));
+  }
+  for (size_t i = 0; i < threads.size(); i++) {
+    threads[i].join();
+  }
+  TEST_CHECK(upstream.outstanding > 0);
+  shared.release();
+  TEST_CHECK(upstream.outstanding == 0);
+
+  // Upstream failures give NULL, and the pool stays usable.
+  null_resource none;
+  {
+    pmr::unsynchronized_pool_resource pool(&none);
+    TEST_CHECK(pool.allocate(32) == 0);
+    TEST_CHECK(pool.allocate(nanostl::kPoolMaxSize + 1) == 0);
+    TEST_CHECK(pool.allocate(8, 64) == 0);
+    pool.release();
+  }
+  {
+    pmr::monotonic_buffer_resource tiny(64);
+    TEST_CHECK(tiny.allocate(1ull << 62) == 0);
+    pmr::unsynchronized_pool_resource pool(&tiny);
+    TEST_CHECK(pool.allocate(~0ull / 2) == 0);
+    TEST_CHECK(pool.allocate(32) != 0);
+  }
+
+  // Default resource.
+  pmr::memory_resource *prev = pmr::set_default_resource(&mono);
+  TEST_CHECK(prev == nd);
+  pmr::vector<int> d;
+  TEST_CHECK(d.get_allocator().resource() == &mono);
+  pmr::set_default_resource(0);
+  TEST_CHECK(pmr::get_default_resource() == nd);
+}
+
+#if defined(NANOSTL_ALLOC_PROFILE)
+static const nanostl::alloc_profile_site *find_profile_site(
+    const nanostl::alloc_profile_site *sites, unsigned long long n,
+    const char *type_name, const char *tag) {
+  for (unsigned long long i = 0; i < n; i++) {
+    if ((nanostl::strcmp(sites[i].type_name, type_name) == 0) &&
+        (sites[i].tag == tag)) {
+      return &sites[i];
+    }
+  }
+  return 0;
+}
+#endif
+
+static void test_alloc_profile(void) {
+  nanostl::alloc_profile_site sites[nanostl::kAllocProfileMaxSites];
+
+  TEST_CHECK(nanostl::alloc_profile_bucket(0) == 0);
+  TEST_CHECK(nanostl::alloc_profile_bucket(16) == 0);
+  TEST_CHECK(nanostl::alloc_profile_bucket(17) == 1);
+  TEST_CHECK(nanostl::alloc_profile_bucket(1ull << 40) ==
+             nanostl::kAllocProfileBuckets - 1);
+
+#if defined(NANOSTL_ALLOC_PROFILE)
+  static const char *kTag = "test-alloc_profile";
+  {
+    NANOSTL_ALLOC_PROFILE_SCOPE(kTag);
+    nanostl::vector<short> v;
+    for (int i = 0; i < 100; i++) {
+      v.push_back(short(i));
+    }
+    nanostl::vector<short> w(v);
+
+    unsigned long long n = nanostl::alloc_profile_snapshot(
+        sites, nanostl::kAllocProfileMaxSites);
+    const nanostl::alloc_profile_site *s =
+        find_profile_site(sites, n, "short int", kTag);
+    TEST_CHECK(s != 0);
+    if (s) {
+      TEST_CHECK(s->live_count == 2);
+      TEST_CHECK(s->live_bytes == (v.capacity() + w.capacity()) * 2);
+      TEST_CHECK(s->peak_bytes >= s->live_bytes);
+      TEST_CHECK(s->alloc_count > 2);
+      TEST_CHECK(s->histogram[nanostl::alloc_profile_bucket(200)] >= 1);
+    }
+  }
+
+  // Everything allocated in the scope is freed again.
+  unsigned long long n = nanostl::alloc_profile_snapshot(
+      sites, nanostl::kAllocProfileMaxSites);
+  const nanostl::alloc_profile_site *s =
+      find_profile_site(sites, n, "short int", kTag);
+  TEST_CHECK(s && (s->live_count == 0) && (s->live_bytes == 0));
+
+  // pmr containers on the default resource are recorded as well.
+  static const char *kPmrTag = "test-alloc_profile-pmr";
+  {
+    NANOSTL_ALLOC_PROFILE_SCOPE(kPmrTag);
+    nanostl::pmr::unsynchronized_pool_resource pool;
+    nanostl::pmr::vector<int> v(&pool);
+    for (int i = 0; i < 100; i++) {
+      v.push_back(i);
+    }
+    n = nanostl::alloc_profile_snapshot(sites,
+                                        nanostl::kAllocProfileMaxSites);
+    s = find_profile_site(sites, n, "nanostl::pmr::__detail::__unit",
+                          kPmrTag);
+    TEST_CHECK(s && (s->live_count > 0));
+  }
+#else
+  TEST_CHECK(nanostl::alloc_profile_snapshot(
+                 sites, nanostl::kAllocProfileMaxSites) == 0);
+#endif
+}
+
+static void test_rope(void) {
+  nanostl::rope r;
+  TEST_CHECK(r.empty());
+
+  nanostl::string expected;
+  for (int i = 0; i < 5000; i++) {
+    r += "line ";
+    r.push_back(char('a' + (i % 26)));
+    r += '\n';
+    expected += "line ";
+    expected.push_back(char('a' + (i % 26)));
+    expected += '\n';
+  }
+  TEST_CHECK(r.size() == expected.size());
+  TEST_CHECK(r.str() == expected);
+  TEST_CHECK(r[6] == '\n');
+  TEST_CHECK(r.at(12) == 'b');
+
+  // Copies share chunks and are not affected by later edits.
+  nanostl::rope copy = r;
+  r.insert(3, nanostl::string_view("XYZ"));
+  r.erase(100, 1000);
+  TEST_CHECK(copy.str() == expected);
+  expected.insert(3, "XYZ");
+  nanostl::string edited(expected.data(), 100);
+  edited += nanostl::string_view(expected.data() + 1100, expected.size() - 1100);
+  TEST_CHECK(r.str() == edited);
+
+  nanostl::rope sub = copy.substr(5, 10);
+  TEST_CHECK(sub.str() == "a\nline b\nl");
+
+  nanostl::rope both = sub + copy.substr(0, 4) + "!";
+  TEST_CHECK(both.str() == "a\nline b\nlline!");
+
+  // Self concat/insert.
+  nanostl::rope s("abc");
+  s += s;
+  s.insert(3, s);
+  TEST_CHECK(s.str() == "abcabcabcabc");
+
+  unsigned long long total = 0;
+  copy.for_each_chunk([&total](nanostl::string_view v) { total += v.size(); });
+  TEST_CHECK(total == copy.size());
+
+  // Height stays logarithmic.
+  TEST_CHECK(copy.depth() < 20);
 }
 
 static void test_map(void) {
@@ -624,14 +1641,534 @@ static void test_to_string(void) {
     std::string str(s);
     TEST_CHECK(str.compare("-133445923") == 0);
   }
+
+  // int64 must not be truncated
+  TEST_CHECK(nanostl::to_string(9876543210123ll) == "9876543210123");
+  TEST_CHECK(nanostl::to_string(-9223372036854775807ll - 1) ==
+             "-9223372036854775808");
+  TEST_CHECK(nanostl::to_string(18446744073709551615ull) ==
+             "18446744073709551615");
+  TEST_CHECK(nanostl::to_string(4294967295u) == "4294967295");
+  TEST_CHECK(nanostl::to_string(0) == "0");
+}
+
+static void test_to_chars(void) {
+  char buf[80];
+  nanostl::to_chars_result r;
+
+  r = nanostl::to_chars(buf, buf + sizeof(buf), -2147483647 - 1);
+  TEST_CHECK(r.ec == nanostl::errc());
+  TEST_CHECK(std::string(buf, r.ptr) == "-2147483648");
+
+  r = nanostl::to_chars(buf, buf + sizeof(buf), 255u, 16);
+  TEST_CHECK(std::string(buf, r.ptr) == "ff");
+
+  r = nanostl::to_chars(buf, buf + sizeof(buf), -5, 2);
+  TEST_CHECK(std::string(buf, r.ptr) == "-101");
+
+  r = nanostl::to_chars(buf, buf + sizeof(buf), 12345678901234567ull, 36);
+  TEST_CHECK(std::string(buf, r.ptr) == "3dk6el9t85j");
+
+  r = nanostl::to_chars(buf, buf + sizeof(buf), (unsigned char)200);
+  TEST_CHECK(std::string(buf, r.ptr) == "200");
+
+  // Does not fit
+  r = nanostl::to_chars(buf, buf + 3, 1000);
+  TEST_CHECK(r.ec == nanostl::errc::value_too_large);
+  TEST_CHECK(r.ptr == buf + 3);
+
+  // Digit count boundaries
+  unsigned long long p = 1;
+  for (int i = 1; i < 20; i++) {
+    p *= 10;
+    char expected[32];
+    snprintf(expected, sizeof(expected), "%llu", p - 1);
+    r = nanostl::to_chars(buf, buf + sizeof(buf), p - 1);
+    TEST_CHECK(std::string(buf, r.ptr) == expected);
+    snprintf(expected, sizeof(expected), "%llu", p);
+    r = nanostl::to_chars(buf, buf + sizeof(buf), p);
+    TEST_CHECK(std::string(buf, r.ptr) == expected);
+  }
 }
 
 static void test_stof(void) {
   TEST_CHECK(float_equals_by_ulps(nanostl::stof("1.0"), 1.0f, 0));
+
+  nanostl::size_t idx = 0;
+  TEST_CHECK(float_equals_by_ulps(nanostl::stof("  -2.5e3xyz", &idx), -2500.0f,
+                                  0));
+  TEST_CHECK(idx == 8);
+
+  TEST_CHECK(nanostl::isnan(nanostl::stof("abc", &idx)));
+  TEST_CHECK(idx == 0);
 }
 
 static void test_stod(void) {
   TEST_CHECK(double_equals_by_ulps(nanostl::stod("1.0"), 1.0, 0));
+
+  // Must not be rounded to float.
+  TEST_CHECK(double_equals_by_ulps(nanostl::stod("0.1"), 0.1, 0));
+  TEST_CHECK(double_equals_by_ulps(nanostl::stod("+3.141592653589793"),
+                                   3.141592653589793, 0));
+
+  nanostl::size_t idx = 0;
+  TEST_CHECK(nanostl::stod("1e400", &idx) ==
+             nanostl::numeric_limits<double>::infinity());
+  TEST_CHECK(idx == 5);
+}
+
+static void test_stoi(void) {
+  nanostl::size_t idx = 0;
+  TEST_CHECK(nanostl::stoi("42") == 42);
+  TEST_CHECK(nanostl::stoi(" -17 apples", &idx) == -17);
+  TEST_CHECK(idx == 4);
+  TEST_CHECK(nanostl::stoi("0x1F", 0, 16) == 31);
+  TEST_CHECK(nanostl::stoi("0x1F", 0, 0) == 31);
+  TEST_CHECK(nanostl::stoi("017", 0, 0) == 15);
+  TEST_CHECK(nanostl::stoi("-2147483648") == (-2147483647 - 1));
+  TEST_CHECK(nanostl::stoi("99999999999") == 2147483647);
+  TEST_CHECK(nanostl::stoi("x", &idx) == 0);
+  TEST_CHECK(idx == 0);
+}
+
+static void test_from_chars(void) {
+  const char *s = "123456789012345678901234";
+  nanostl::from_chars_result r;
+
+  unsigned long long u = 0;
+  r = nanostl::from_chars(s, s + 20, u);
+  TEST_CHECK(r.ec == nanostl::errc());
+  TEST_CHECK(u == 12345678901234567890ull);
+  TEST_CHECK(r.ptr == s + 20);
+
+  // Out of range: value is kept, ptr is past the number.
+  r = nanostl::from_chars(s, s + 24, u);
+  TEST_CHECK(r.ec == nanostl::errc::result_out_of_range);
+  TEST_CHECK(r.ptr == s + 24);
+  TEST_CHECK(u == 12345678901234567890ull);
+
+  int i = 0;
+  const char *neg = "-2147483648,";
+  r = nanostl::from_chars(neg, neg + 12, i);
+  TEST_CHECK(r.ec == nanostl::errc());
+  TEST_CHECK(i == (-2147483647 - 1));
+  TEST_CHECK(*r.ptr == ',');
+
+  unsigned char c = 0;
+  const char *hex = "fF";
+  r = nanostl::from_chars(hex, hex + 2, c, 16);
+  TEST_CHECK(c == 255);
+
+  // No '-' for unsigned, no '+'.
+  const char *bad = "-1";
+  r = nanostl::from_chars(bad, bad + 2, u);
+  TEST_CHECK(r.ec == nanostl::errc::invalid_argument);
+  TEST_CHECK(r.ptr == bad);
+  const char *plus = "+1";
+  r = nanostl::from_chars(plus, plus + 2, i);
+  TEST_CHECK(r.ec == nanostl::errc::invalid_argument);
+
+  double d = 0.0;
+  const char *f = "6.02214076e23 mol";
+  r = nanostl::from_chars(f, f + 17, d);
+  TEST_CHECK(r.ec == nanostl::errc());
+  TEST_CHECK(double_equals_by_ulps(d, 6.02214076e23, 0));
+  TEST_CHECK(r.ptr == f + 13);
+
+  float fv = 0.0f;
+  const char *fixed = "1.5e3";
+  r = nanostl::from_chars(fixed, fixed + 5, fv, nanostl::chars_format::fixed);
+  TEST_CHECK(float_equals_by_ulps(fv, 1.5f, 0));
+  TEST_CHECK(r.ptr == fixed + 3);
+
+  const char *big = "1e50";
+  fv = 2.0f;
+  r = nanostl::from_chars(big, big + 4, fv);
+  TEST_CHECK(r.ec == nanostl::errc::result_out_of_range);
+  TEST_CHECK(float_equals_by_ulps(fv, 2.0f, 0));
+}
+
+static void test_to_chars_float(void) {
+  char buf[512];
+  nanostl::to_chars_result r;
+
+#define CHECK_TO_CHARS(v, fmt, prec, expected)                          \
+  r = nanostl::to_chars(buf, buf + sizeof(buf), v,                     \
+                        nanostl::chars_format::fmt, prec);             \
+  TEST_CHECK(r.ec == nanostl::errc());                                \
+  TEST_CHECK(nanostl::string(buf, size_t(r.ptr - buf)) == expected);  \
+  TEST_MSG("got %s", nanostl::string(buf, size_t(r.ptr - buf)).c_str());
+
+  CHECK_TO_CHARS(3.14159265358979, fixed, 6, "3.141593");
+  CHECK_TO_CHARS(-0.0, fixed, 2, "-0.00");
+  CHECK_TO_CHARS(0.125, fixed, 2, "0.12");  // round half to even
+  CHECK_TO_CHARS(0.375, fixed, 2, "0.38");
+  CHECK_TO_CHARS(0.1, fixed, 20, "0.10000000000000000555");  // exact
+  CHECK_TO_CHARS(999.96, fixed, 1, "1000.0");
+  CHECK_TO_CHARS(2.5, fixed, 0, "2");
+  CHECK_TO_CHARS(1e22, fixed, 0, "10000000000000000000000");
+  CHECK_TO_CHARS(1.5f, fixed, 3, "1.500");
+  CHECK_TO_CHARS(5e-324, fixed, 3, "0.000");
+
+  CHECK_TO_CHARS(123456.0, scientific, 3, "1.235e+05");
+  CHECK_TO_CHARS(9.9999, scientific, 2, "1.00e+01");
+  CHECK_TO_CHARS(0.0, scientific, 1, "0.0e+00");
+  CHECK_TO_CHARS(1.7976931348623157e308, scientific, 16,
+                 "1.7976931348623157e+308");
+  CHECK_TO_CHARS(4.9406564584124654e-324, scientific, 4, "4.9407e-324");
+  CHECK_TO_CHARS(0.1f, scientific, 8, "1.00000001e-01");
+
+  CHECK_TO_CHARS(100000.0, general, 6, "100000");
+  CHECK_TO_CHARS(1000000.0, general, 6, "1e+06");
+  CHECK_TO_CHARS(0.0001, general, 6, "0.0001");
+  CHECK_TO_CHARS(0.00001, general, 6, "1e-05");
+  CHECK_TO_CHARS(0.5, general, 0, "0.5");
+  CHECK_TO_CHARS(2.0 / 3.0, general, -1, "0.666667");
+
+  CHECK_TO_CHARS(-nanostl::numeric_limits<double>::infinity(), fixed, 2,
+                 "-inf");
+
+#undef CHECK_TO_CHARS
+
+  // Does not fit.
+  r = nanostl::to_chars(buf, buf + 4, 12.345, nanostl::chars_format::fixed, 2);
+  TEST_CHECK(r.ec == nanostl::errc::value_too_large);
+  TEST_CHECK(r.ptr == buf + 4);
+  r = nanostl::to_chars(buf, buf + 5, 12.345, nanostl::chars_format::fixed, 2);
+  TEST_CHECK(r.ec == nanostl::errc());
+
+  // Trailing zeros of %g are not counted.
+  r = nanostl::to_chars(buf, buf + 3, 100.0, nanostl::chars_format::general,
+                        10);
+  TEST_CHECK(r.ec == nanostl::errc());
+  TEST_CHECK(r.ptr == buf + 3);
+
+  // Exact: matches the decimal expansion of the binary value.
+  r = nanostl::to_chars(buf, buf + sizeof(buf), 0.1,
+                        nanostl::chars_format::fixed, 60);
+  TEST_CHECK(nanostl::string(buf, size_t(r.ptr - buf)) ==
+             "0.100000000000000005551115123125782702118158340454101562500000");
+}
+
+static void test_parse_numbers(void) {
+  const char *text = "1.5, -2\n+3e2\t4\r\n\n5,,6";
+  const char *text_end = text + strlen(text);
+
+  nanostl::vector<double> d;
+  nanostl::parse_numbers_result r = nanostl::parse_numbers(text, text_end, d);
+  TEST_CHECK(r.ec == nanostl::errc());
+  TEST_CHECK(r.ptr == text_end);
+  TEST_CHECK(r.count == 6);
+  TEST_CHECK(d.size() == 6);
+  TEST_CHECK(double_equals_by_ulps(d[0], 1.5, 0));
+  TEST_CHECK(double_equals_by_ulps(d[2], 300.0, 0));
+  TEST_CHECK(double_equals_by_ulps(d[5], 6.0, 0));
+
+  // Appends. Values before the bad token are kept.
+  const char *bad = "7 8\n9x 10";
+  r = nanostl::parse_numbers(bad, bad + strlen(bad), d);
+  TEST_CHECK(r.ec == nanostl::errc::invalid_argument);
+  TEST_CHECK(r.ptr == bad + 4);
+  TEST_CHECK(r.line == 2);
+  TEST_CHECK(r.count == 2);
+  TEST_CHECK(d.size() == 8);
+
+  nanostl::vector<int> iv;
+  const char *ints = "1;2;2147483648";
+  nanostl::parse_numbers_options options;
+  options.separators = ";";
+  r = nanostl::parse_numbers(ints, ints + strlen(ints), iv, options);
+  TEST_CHECK(r.ec == nanostl::errc::result_out_of_range);
+  TEST_CHECK(r.ptr == ints + 4);
+  TEST_CHECK(iv.size() == 2);
+
+  // Parallel parse must match the serial one.
+  nanostl::string big;
+  for (int i = 0; i < 20000; i++) {
+    big += nanostl::to_string(i * 7 - 3000);
+    big += (i % 10 == 9) ? "\n" : " ";
+  }
+  nanostl::vector<float> serial, parallel;
+  r = nanostl::parse_numbers(big.data(), big.data() + big.size(), serial);
+  TEST_CHECK(r.count == 20000);
+  options = nanostl::parse_numbers_options();
+  options.num_threads = 4;
+  options.min_chunk_bytes = 1000;
+  r = nanostl::parse_numbers(big.data(), big.data() + big.size(), parallel,
+                             options);
+  TEST_CHECK(r.ec == nanostl::errc());
+  TEST_CHECK(parallel.size() == serial.size());
+  bool same = true;
+  for (size_t i = 0; i < serial.size(); i++) {
+    same &= float_equals_by_ulps(serial[i], parallel[i], 0);
+  }
+  TEST_CHECK(same);
+
+  // Error is reported from the first failing chunk.
+  big[big.size() / 2] = '#';
+  parallel.clear();
+  r = nanostl::parse_numbers(big.data(), big.data() + big.size(), parallel,
+                             options);
+  TEST_CHECK(r.ec == nanostl::errc::invalid_argument);
+  TEST_CHECK(r.count == parallel.size());
+  TEST_CHECK(r.ptr <= big.data() + big.size() / 2);
+}
+
+static void test_format_numbers(void) {
+  const float fv[] = {1.5f, -0.0f, 3.0e-10f, 100.0f};
+  char buf[64];
+  nanostl::format_numbers_options options;
+  options.separator = ", ";
+  nanostl::format_numbers_result r =
+      nanostl::format_numbers(buf, buf + sizeof(buf), fv, 4, options);
+  TEST_CHECK(r.ec == nanostl::errc());
+  TEST_CHECK(r.count == 4);
+  TEST_CHECK(nanostl::string(buf, size_t(r.ptr - buf)) ==
+             nanostl::to_string(1.5f) + ", " + nanostl::to_string(-0.0f) +
+                 ", " + nanostl::to_string(3.0e-10f) + ", " +
+                 nanostl::to_string(100.0f));
+
+  // Too small: only complete values are written.
+  r = nanostl::format_numbers(buf, buf + 12, fv, 4, options);
+  TEST_CHECK(r.ec == nanostl::errc::value_too_large);
+  TEST_CHECK(r.count == 2);
+  TEST_CHECK(nanostl::string(buf, size_t(r.ptr - buf)) == "1.5E0, -0E0");
+
+  // Appends to a string. Round trips through parse_numbers.
+  nanostl::vector<double> dv;
+  for (int i = 0; i < 10000; i++) {
+    dv.push_back((i - 5000) * 1.000001e-3);
+  }
+  nanostl::string text = "#";
+  unsigned long long len = nanostl::format_numbers(text, dv.data(), dv.size());
+  TEST_CHECK(text.size() == len + 1);
+  TEST_CHECK(len <= nanostl::format_numbers_max_size(
+                        dv.size(), nanostl::kFormatDoubleMaxChars));
+
+  nanostl::vector<double> back;
+  nanostl::parse_numbers(text.data() + 1, text.data() + text.size(), back);
+  TEST_CHECK(back.size() == dv.size());
+  bool same = true;
+  for (size_t i = 0; i < dv.size(); i++) {
+    same &= double_equals_by_ulps(dv[i], back[i], 0);
+  }
+  TEST_CHECK(same);
+
+  // Parallel output must match the serial one.
+  options = nanostl::format_numbers_options();
+  options.num_threads = 4;
+  options.min_chunk_values = 100;
+  nanostl::string parallel = "#";
+  nanostl::format_numbers(parallel, dv.data(), dv.size(), options);
+  TEST_CHECK(parallel == text);
+
+  char small[1000];
+  r = nanostl::format_numbers(small, small + sizeof(small), dv.data(),
+                              dv.size(), options);
+  TEST_CHECK(r.ec == nanostl::errc::value_too_large);
+  TEST_CHECK(nanostl::string(small, size_t(r.ptr - small)) ==
+             nanostl::string(text.data() + 1, size_t(r.ptr - small)));
+}
+
+#if NANOSTL_CPLUSPLUS >= 202002L
+template <nanostl::basic_fixed_string Name>
+struct fixed_string_param {
+  static constexpr nanostl::string_view name() { return Name; }
+};
+#endif
+
+static void test_fixed_string(void) {
+  constexpr auto albedo = nanostl::make_fixed_string("albedo");
+  static_assert(albedo.size() == 6, "fixed_string size must be constexpr");
+  static_assert(albedo[0] == 'a' && albedo.c_str()[6] == '\0', "");
+  static_assert(albedo == "albedo", "compare with a literal in constexpr");
+  static_assert(albedo != nanostl::make_fixed_string("albed"), "");
+  static_assert(nanostl::make_fixed_string("abc") <
+                    nanostl::make_fixed_string("abd"),
+                "");
+  static_assert(albedo.hash() == nanostl::__hash_fnv1a_n("albedo", 6),
+                "hash must be constexpr");
+
+  constexpr nanostl::fixed_string<9> base_color =
+      nanostl::make_fixed_string("base") + nanostl::make_fixed_string("Color");
+  static_assert(base_color == "baseColor", "constexpr concatenation");
+
+  // Same hash for a view of the same chars.
+  TEST_CHECK(nanostl::fixed_string_hash()(albedo) ==
+             nanostl::fixed_string_hash()(nanostl::string_view("albedo")));
+
+  nanostl::string_view v = albedo;
+  TEST_CHECK(v.data() == albedo.data());
+  TEST_CHECK(v == "albedo");
+  TEST_CHECK(nanostl::string("albedo") == albedo.c_str());
+
+#if NANOSTL_CPLUSPLUS >= 201703L
+  constexpr nanostl::basic_fixed_string roughness("roughness");
+  static_assert(roughness.size() == 9, "deduced from the literal");
+#endif
+
+#if NANOSTL_CPLUSPLUS >= 202002L
+  TEST_CHECK(fixed_string_param<"metallic">::name() == "metallic");
+#endif
+}
+
+// Independent UTF-8 decoder for test_unicode. Returns the sequence length, or
+// 0 if invalid.
+static int ref_utf8_decode(const unsigned char *s, unsigned long long n,
+                           unsigned int *cp) {
+  int len = 0;
+  unsigned int v = 0;
+  unsigned int min = 0;
+  if (s[0] < 0x80) {
+    *cp = s[0];
+    return 1;
+  } else if ((s[0] & 0xe0) == 0xc0) {
+    len = 2, v = s[0] & 0x1f, min = 0x80;
+  } else if ((s[0] & 0xf0) == 0xe0) {
+    len = 3, v = s[0] & 0x0f, min = 0x800;
+  } else if ((s[0] & 0xf8) == 0xf0) {
+    len = 4, v = s[0] & 0x07, min = 0x10000;
+  } else {
+    return 0;
+  }
+  for (int k = 1; k < len; k++) {
+    if ((unsigned long long)k >= n || (s[k] & 0xc0) != 0x80) {
+      return 0;
+    }
+    v = (v << 6) | (s[k] & 0x3f);
+  }
+  if (v < min || v > 0x10ffff || (v >= 0xd800 && v <= 0xdfff)) {
+    return 0;
+  }
+  *cp = v;
+  return len;
+}
+
+// Index of the first invalid sequence, or n.
+static unsigned long long ref_utf8_validate(const unsigned char *s,
+                                            unsigned long long n) {
+  unsigned long long i = 0;
+  while (i < n) {
+    unsigned int cp;
+    int len = ref_utf8_decode(s + i, n - i, &cp);
+    if (len == 0) {
+      return i;
+    }
+    i += (unsigned long long)len;
+  }
+  return n;
+}
+
+static bool check_utf8_at(const unsigned char *seq, int len, int offset,
+                          int block) {
+  unsigned char buf[80];
+  for (int k = 0; k < block; k++) {
+    buf[k] = (unsigned char)('a' + (k % 26));
+  }
+  for (int k = 0; k < len; k++) {
+    buf[offset + k] = seq[k];
+  }
+  const unsigned long long expected = ref_utf8_validate(buf, (unsigned)block);
+  nanostl::utf_result r = nanostl::validate_utf8_with_errors(
+      reinterpret_cast<const char *>(buf), (unsigned)block);
+  if (expected == (unsigned)block) {
+    return (r.ec == nanostl::errc()) && (r.count == (unsigned)block);
+  }
+  return (r.ec == nanostl::errc::illegal_byte_sequence) && (r.count == expected);
+}
+
+static void test_unicode(void) {
+  // Sizes and offsets put the sequence inside and across 16 byte blocks and
+  // in the scalar tail.
+  const int kBlocks[] = {4, 17, 32, 47, 64};
+  const int kNumBlocks = sizeof(kBlocks) / sizeof(kBlocks[0]);
+
+  // Every 1/2/3 byte sequence(and truncations of them), random 4 byte ones.
+  unsigned long long failures = 0;
+  unsigned char seq[4];
+  for (unsigned int a = 0x00; a <= 0xff; a++) {
+    for (unsigned int b = 0x00; b <= 0xff; b++) {
+      seq[0] = (unsigned char)a;
+      seq[1] = (unsigned char)b;
+      for (int bi = 0; bi < kNumBlocks; bi++) {
+        const int offsets[] = {0, 1, 14, 15, kBlocks[bi] - 2, kBlocks[bi] - 1};
+        for (int oi = 0; oi < 6; oi++) {
+          const int o = offsets[oi];
+          if (o >= 0 && o + 2 <= kBlocks[bi]) {
+            failures += check_utf8_at(seq, 2, o, kBlocks[bi]) ? 0 : 1;
+          }
+        }
+      }
+      if (a < 0xe0 || a > 0xef) {
+        continue;
+      }
+      for (unsigned int c = 0x00; c <= 0xff; c++) {
+        seq[2] = (unsigned char)c;
+        failures += check_utf8_at(seq, 3, 15, 32) ? 0 : 1;
+        failures += check_utf8_at(seq, 3, 30, 47) ? 0 : 1;
+      }
+    }
+  }
+  unsigned int rng = 12345;
+  for (int t = 0; t < 200000; t++) {
+    rng = rng * 1103515245u + 12345u;
+    seq[0] = (unsigned char)(0xf0 + ((rng >> 8) & 7));
+    seq[1] = (unsigned char)(rng >> 12);
+    seq[2] = (unsigned char)(0x80 ^ ((rng >> 20) & 0x47));
+    seq[3] = (unsigned char)(0x80 ^ ((rng >> 26) & 0x43));
+    const int block = kBlocks[t % kNumBlocks];
+    failures += check_utf8_at(seq, 4, (t >> 3) % (block - 3), block) ? 0 : 1;
+  }
+  TEST_CHECK(failures == 0);
+  TEST_MSG("utf8 validation failures: %llu", failures);
+
+  // Round trip every scalar value.
+  nanostl::u32string all;
+  for (char32_t c = 0; c <= 0x10ffff; c++) {
+    if (c < 0xd800 || c > 0xdfff) {
+      all.push_back(c);
+    }
+  }
+  nanostl::string u8;
+  nanostl::u16string u16;
+  nanostl::u32string u32;
+  TEST_CHECK(nanostl::utf32_to_utf8(all, u8).ec == nanostl::errc());
+  TEST_CHECK(nanostl::validate_utf8(u8));
+  TEST_CHECK(u8.size() ==
+             nanostl::utf8_length_from_utf32(all.data(), all.size()));
+  TEST_CHECK(ref_utf8_validate(reinterpret_cast<const unsigned char *>(u8.data()),
+                               u8.size()) == u8.size());
+  TEST_CHECK(nanostl::utf32_length_from_utf8(u8.data(), u8.size()) ==
+             all.size());
+  TEST_CHECK(nanostl::utf8_to_utf32(u8, u32).ec == nanostl::errc());
+  TEST_CHECK(u32 == all);
+  TEST_CHECK(nanostl::utf8_to_utf16(u8, u16).ec == nanostl::errc());
+  TEST_CHECK(u16.size() ==
+             nanostl::utf16_length_from_utf8(u8.data(), u8.size()));
+  TEST_CHECK(nanostl::validate_utf16(u16.data(), u16.size()));
+  nanostl::string back;
+  TEST_CHECK(nanostl::utf16_to_utf8(u16, back).ec == nanostl::errc());
+  TEST_CHECK(back == u8);
+  TEST_CHECK(nanostl::utf8_length_from_utf16(u16.data(), u16.size()) ==
+             u8.size());
+
+  // ASCII runs and errors after them.
+  nanostl::string text;
+  text.resize(100, 'x');
+  text += "\xce\xbb";
+  TEST_CHECK(nanostl::utf8_to_utf16(text, u16).ec == nanostl::errc());
+  TEST_CHECK(u16.size() == 101 && u16[99] == u'x' && u16[100] == 0x3bb);
+  text += "\xed\xa0\x80";  // surrogate
+  nanostl::utf_result r = nanostl::utf8_to_utf32(text, u32);
+  TEST_CHECK(r.ec == nanostl::errc::illegal_byte_sequence);
+  TEST_CHECK(r.count == 102 && u32.empty());
+
+  const char16_t lone[] = {u'a', 0xd800, u'b'};
+  r = nanostl::utf16_to_utf8(nanostl::basic_string_view<char16_t>(lone, 3), u8);
+  TEST_CHECK(r.ec == nanostl::errc::illegal_byte_sequence && r.count == 1);
+  const char32_t big[] = {0x41, 0x110000};
+  r = nanostl::validate_utf32_with_errors(big, 2);
+  TEST_CHECK(r.ec == nanostl::errc::illegal_byte_sequence && r.count == 1);
 }
 
 static void test_unique_ptr(void) {
@@ -662,6 +2199,162 @@ static void test_variant(void) {
 }
 
 
+static void test_hash_append(void) {
+  nanostl::uhash<nanostl::fast_hasher> fh;
+  nanostl::uhash<nanostl::siphash_hasher> sh;
+
+  // Same bytes with different chunking give the same hash.
+  {
+    const char *s = "The quick brown fox jumps over the lazy dog";
+    nanostl::fast_hasher a;
+    a(s, 43);
+    nanostl::fast_hasher b;
+    b(s, 10);
+    b(s + 10, 33);
+    TEST_CHECK(nanostl::uint64_t(a) == nanostl::uint64_t(b));
+
+    nanostl::uint8_t key[16] = {0};
+    nanostl::uint8_t out[8];
+    nanostl::siphash(reinterpret_cast<const nanostl::uint8_t *>(s), 43, key,
+                     out, 8);
+    nanostl::siphash_hasher c;
+    c(s, 7);
+    c(s + 7, 36);
+    nanostl::uint64_t ref = 0;
+    for (int i = 7; i >= 0; i--) {
+      ref = (ref << 8) | out[i];
+    }
+    TEST_CHECK(nanostl::uint64_t(c) == ref);
+  }
+
+  nanostl::pair<int, nanostl::string> p0(1, "abc");
+  nanostl::pair<int, nanostl::string> p1(1, "abc");
+  nanostl::pair<int, nanostl::string> p2(1, "abd");
+  TEST_CHECK(fh(p0) == fh(p1));
+  TEST_CHECK(fh(p0) != fh(p2));
+  TEST_CHECK(sh(p0) == sh(p1));
+  TEST_CHECK(sh(p0) != sh(p2));
+
+  TEST_CHECK(fh(0.0) == fh(-0.0));
+
+  tao::tuple<int, nanostl::string, double> t0(1, "x", 2.0);
+  tao::tuple<int, nanostl::string, double> t1(1, "x", 2.5);
+  TEST_CHECK(fh(t0) != fh(t1));
+
+  nanostl::optional<int> o0;
+  nanostl::optional<int> o1(0);
+  TEST_CHECK(fh(o0) != fh(o1));
+
+  nanostl::variant<int, double> v0(1);
+  nanostl::variant<int, double> v1(1.0);
+  TEST_CHECK(sh(v0) != sh(v1));
+
+  // Length is part of the hash: {"ab", "c"} != {"a", "bc"}
+  nanostl::vector<nanostl::string> a;
+  a.push_back("ab");
+  a.push_back("c");
+  nanostl::vector<nanostl::string> b;
+  b.push_back("a");
+  b.push_back("bc");
+  TEST_CHECK(fh(a) != fh(b));
+  TEST_CHECK(sh(a) != sh(b));
+}
+
+static void test_bloom_filter(void) {
+  const size_t n = 10000;
+  nanostl::vector<int> keys;
+  for (size_t i = 0; i < n; i++) {
+    keys.push_back(int(i * 7 + 1));
+  }
+
+  nanostl::bloom_filter<int> bf(n, 10);
+  bf.insert(keys.begin(), keys.end());
+
+  // No false negatives.
+  for (size_t i = 0; i < n; i++) {
+    TEST_CHECK(bf.contains(keys[i]));
+  }
+
+  size_t fp = 0;
+  const size_t num_queries = 100000;
+  for (size_t i = 0; i < num_queries; i++) {
+    fp += bf.contains(-int(i) - 1) ? 1 : 0;
+  }
+  double fpr = double(fp) / double(num_queries);
+  TEST_CHECK(fpr < 0.02);
+  TEST_MSG("bloom_filter fpr = %f", fpr);
+
+  bool results[16];
+  TEST_CHECK(bf.contains(keys.begin(), 16, results) == 16);
+}
+
+static void test_cuckoo_filter(void) {
+  const size_t n = 10000;
+  nanostl::vector<int> keys;
+  for (size_t i = 0; i < n; i++) {
+    keys.push_back(int(i * 7 + 1));
+  }
+
+  nanostl::cuckoo_filter<int> cf(n);
+  TEST_CHECK(cf.insert(keys.begin(), keys.end()) == n);
+  TEST_CHECK(cf.size() == n);
+
+  for (size_t i = 0; i < n; i++) {
+    TEST_CHECK(cf.contains(keys[i]));
+  }
+
+  size_t fp = 0;
+  const size_t num_queries = 100000;
+  for (size_t i = 0; i < num_queries; i++) {
+    fp += cf.contains(-int(i) - 1) ? 1 : 0;
+  }
+  double fpr = double(fp) / double(num_queries);
+  TEST_CHECK(fpr < 0.001);
+  TEST_MSG("cuckoo_filter fpr = %f", fpr);
+
+  // Remove even entries.
+  for (size_t i = 0; i < n; i += 2) {
+    TEST_CHECK(cf.erase(keys[i]));
+  }
+  TEST_CHECK(cf.size() == n / 2);
+  for (size_t i = 1; i < n; i += 2) {
+    TEST_CHECK(cf.contains(keys[i]));
+  }
+}
+
+#if NANOSTL_CPLUSPLUS >= 201402L
+static void test_frozen_map(void) {
+  static constexpr nanostl::pair<const char *, int> kOps[] = {
+      {"add", 0}, {"sub", 1}, {"mul", 2}, {"div", 3}, {"mod", 4},
+      {"and", 5}, {"or", 6},  {"xor", 7}, {"shl", 8}, {"shr", 9}};
+  constexpr auto m = nanostl::make_frozen_map(kOps);
+  static_assert(m.at("mul") == 2, "frozen_map must be usable in constexpr");
+
+  TEST_CHECK(m.size() == 10);
+  for (size_t i = 0; i < 10; i++) {
+    TEST_CHECK(m.contains(kOps[i].first));
+    TEST_CHECK(m.find(kOps[i].first)->second == kOps[i].second);
+  }
+  TEST_CHECK(m.find("nop") == m.end());
+  TEST_CHECK(m.count("ad") == 0);
+
+  // Built at runtime as well.
+  const auto r = nanostl::make_frozen_map(kOps);
+  for (size_t i = 0; i < 10; i++) {
+    TEST_CHECK(r.at(kOps[i].first) == kOps[i].second);
+  }
+  TEST_CHECK(!r.contains("nop"));
+
+  static constexpr int kKeys[] = {-3, 0, 7, 42, 100, 1000, 31337};
+  constexpr auto s = nanostl::make_frozen_set(kKeys);
+  for (size_t i = 0; i < 7; i++) {
+    TEST_CHECK(s.contains(kKeys[i]));
+  }
+  TEST_CHECK(!s.contains(1));
+  TEST_CHECK(!s.contains(-1));
+}
+#endif
+
 #if 0
 static void test_expected(void) {
   nanostl::expected<double, std::string> a;
@@ -672,10 +2365,23 @@ static void test_expected(void) {
 extern "C" void test_valarray(void);
 
 TEST_LIST = {{"test-vector", test_vector},
+             {"test-uninitialized", test_uninitialized},
              {"test-limits", test_limits},
              {"test-string", test_string},
+             {"test-string_view", test_string_view},
+             {"test-string_find", test_string_find},
+             {"test-string_append", test_string_append},
+             {"test-string_pool", test_string_pool},
+             {"test-arena", test_arena},
+             {"test-pool_allocator", test_pool_allocator},
+             {"test-memory_resource", test_memory_resource},
+             {"test-alloc_profile", test_alloc_profile},
+             {"test-rope", test_rope},
              {"test-map", test_map},
              {"test-algorithm", test_algorithm},
+             {"test-cstring", test_cstring},
+             {"test-cstring_str", test_cstring_str},
+             {"test-cstring_guard_page", test_cstring_guard_page},
              {"test-iterator", test_iterator},
              {"test-math-func1", test_math_func1},
              {"test-math-exp", test_math_exp},
@@ -692,10 +2398,25 @@ TEST_LIST = {{"test-vector", test_vector},
              {"test-double-nan", test_double_nan},
              {"test-digits10", test_digits10},
              {"test-to_string", test_to_string},
+             {"test-to_chars", test_to_chars},
+             {"test-to_chars_float", test_to_chars_float},
              {"test-stof", test_stof},
+             {"test-stod", test_stod},
+             {"test-stoi", test_stoi},
+             {"test-from_chars", test_from_chars},
+             {"test-parse_numbers", test_parse_numbers},
+             {"test-format_numbers", test_format_numbers},
+             {"test-fixed_string", test_fixed_string},
+             {"test-unicode", test_unicode},
              {"test-unique_ptr", test_unique_ptr},
              {"test-optional", test_optional},
              {"test-variant", test_variant},
+             {"test-hash_append", test_hash_append},
+             {"test-bloom_filter", test_bloom_filter},
+             {"test-cuckoo_filter", test_cuckoo_filter},
+#if NANOSTL_CPLUSPLUS >= 201402L
+             {"test-frozen_map", test_frozen_map},
+#endif
              //{"test-any", test_any},
              //{"test-expected", test_expected},
              {nullptr, nullptr}};